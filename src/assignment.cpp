@@ -0,0 +1,157 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cassert>
+#include <climits>
+#include <algorithm>
+#include <vector>
+
+#include "assignment.h"
+
+
+void AssignmentSolver::reset(int columnCount) {
+  columns = columnCount;
+  u.assign(columns, 0);
+  v.assign(columns + 1, 0);
+  minv.assign(columns + 1, 0);
+  match.assign(columns + 1, -1);
+  way.assign(columns + 1, 0);
+  used.assign(columns + 1, 0);
+}
+
+
+long AssignmentSolver::solve(const std::vector<int> &cost, int rows, std::vector<int> &rowToColumn, bool warmStart) {
+  assert(rows <= columns);
+  assert(cost.size() >= rows * columns);
+
+  const long INF = LONG_MAX / 4;
+  int n = columns;  // the virtual column n is the root of the shortest path tree
+  int i, j;
+
+  if (!warmStart) std::fill(v.begin(), v.end(), 0);
+  std::fill(match.begin(), match.end(), -1);
+  std::vector<int> rowMatch(n, -1);
+
+  // Initialisation: with the column potentials given, make the row potentials tight
+  // and match each row to one of its best columns, whenever one of them is still free
+  for (i = 0; i < n; i++) {
+    long best = INF, bestFree = INF; int bestj = -1;
+    for (j = 0; j < n; j++) {
+      long reduced = getCost(cost, rows, i, j) - v[j];
+      if (reduced < best) best = reduced;
+      if (match[j] < 0 && reduced < bestFree) { bestFree = reduced; bestj = j; }
+    }
+    u[i] = best;
+    if (bestFree == best) { match[bestj] = i; rowMatch[i] = bestj; }
+  }
+
+  // Augmentation: shortest augmenting paths from each free row
+  for (i = 0; i < n; i++) {
+    if (rowMatch[i] >= 0) continue;
+    match[n] = i;
+    int j0 = n;
+    std::fill(minv.begin(), minv.end(), INF);
+    std::fill(used.begin(), used.end(), 0);
+    do {
+      used[j0] = 1;
+      int i0 = match[j0], j1 = -1;
+      long delta = INF;
+      for (j = 0; j < n; j++)
+        if (!used[j]) {
+          long cur = getCost(cost, rows, i0, j) - u[i0] - v[j];
+          if (cur < minv[j]) { minv[j] = cur; way[j] = j0; }
+          if (minv[j] < delta) { delta = minv[j]; j1 = j; }
+        }
+      for (j = 0; j <= n; j++)
+        if (used[j]) { u[match[j]] += delta; v[j] -= delta; }
+        else minv[j] -= delta;
+      j0 = j1;
+    } while (match[j0] >= 0);
+    // Flip the alternating path
+    do {
+      int j1 = way[j0];
+      match[j0] = match[j1];
+      j0 = j1;
+    } while (j0 != n);
+    for (j = 0; j < n; j++)
+      if (match[j] >= 0) rowMatch[match[j]] = j;
+  }
+  match[n] = -1;
+
+  long total = 0;
+  rowToColumn.assign(rows, -1);
+  for (i = 0; i < rows; i++) {
+    rowToColumn[i] = rowMatch[i];
+    total += cost[i * n + rowMatch[i]];
+  }
+  return total;
+}
+
+
+int optimiseRooms(TimetablingInstance &instance, Lectures &lectures, int maxPasses) {
+
+  int R = instance.getRoomCount();
+  int l, p, r, pass;
+  int improvement = 0;
+
+  // Index the lectures by periods and count how often each course uses each room
+  std::vector< std::vector<int> > byPeriod(instance.getPeriodCount());
+  std::vector< std::vector<int> > usage(instance.getCourseCount(), std::vector<int>(R, 0));
+  for (l = 0; l < lectures.size(); l++) {
+    byPeriod[lectures[l].period].push_back(l);
+    usage[lectures[l].course][lectures[l].room] += 1;
+  }
+
+  std::vector<int> capacity(R);
+  for (r = 0; r < R; r++) capacity[r] = instance.getRoom(r).capacity;
+
+  AssignmentSolver solver(R);
+  std::vector<int> cost, rowToColumn;
+
+  for (pass = 0; pass < maxPasses; pass++) {
+    int improvedThisPass = 0;
+    for (p = 0; p < instance.getPeriodCount(); p++) {
+      std::vector<int> &here = byPeriod[p];
+      int k = here.size();
+      if (k == 0) continue;
+      assert(k <= R);
+
+      // Cost of a room for a lecture: the missing seats and, if the course
+      // does not use the room in any other period, the extra room used
+      cost.assign(k * R, 0);
+      int before = 0;
+      for (l = 0; l < k; l++) {
+        const Lecture &lec = lectures[here[l]];
+        const Course &course = instance.getCourse(lec.course);
+        usage[lec.course][lec.room] -= 1;
+        for (r = 0; r < R; r++) {
+          int c = std::max(0, course.students - capacity[r]);
+          if (usage[lec.course][r] == 0) c += 1;
+          cost[l * R + r] = c;
+        }
+        before += cost[l * R + lec.room];
+      }
+
+      long after = solver.solve(cost, k, rowToColumn);
+      bool accept = (after < before);
+      for (l = 0; l < k; l++) {
+        Lecture &lec = lectures[here[l]];
+        if (accept) lec.room = rowToColumn[l];
+        usage[lec.course][lec.room] += 1;
+      }
+      if (accept) improvedThisPass += before - after;
+    }
+    improvement += improvedThisPass;
+    if (improvedThisPass == 0) break;
+  }
+
+  return improvement;
+}
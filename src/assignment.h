@@ -0,0 +1,50 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_ASSIGNMENT
+#define UDINE_ASSIGNMENT
+
+#include <vector>
+
+#include "loader.h"
+#include "timetable.h"
+
+/* Dense assignment of k rows (courses) to n >= k columns (rooms),
+* solved by shortest augmenting paths in the style of Jonker and Volgenant.
+* The rectangular problem is padded with zero-cost rows, so that any column
+* potentials are dual feasible. The potentials are kept between calls,
+* which warm-starts a sequence of similar problems, e.g. consecutive periods.
+*/
+class AssignmentSolver {
+protected:
+  int columns;
+  std::vector<long> u, v;          // row and column potentials
+  std::vector<long> minv;          // helpers of the shortest path computation
+  std::vector<int> match, way;
+  std::vector<char> used;
+  inline long getCost(const std::vector<int> &cost, int rows, int i, int j) {
+    return (i < rows) ? cost[i * columns + j] : 0;
+  }
+public:
+  AssignmentSolver(int columnCount = 0) { reset(columnCount); }
+  void reset(int columnCount);
+  int getColumnCount() { return columns; }
+  // cost is a row-major matrix of rows x getColumnCount() entries,
+  // returns the cost of the assignment and fills rowToColumn
+  long solve(const std::vector<int> &cost, int rows, std::vector<int> &rowToColumn, bool warmStart = true);
+};
+
+// Reassigns rooms within each period, keeping the periods of all lectures fixed,
+// so as to minimise room capacity and room stability penalties.
+// Returns the decrease in the penalty, which is never negative.
+int optimiseRooms(TimetablingInstance &instance, Lectures &lectures, int maxPasses = 5);
+
+#endif // UDINE_ASSIGNMENT
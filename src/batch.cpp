@@ -0,0 +1,107 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <glob.h>
+#endif
+
+#include "batch.h"
+
+
+bool endsWith(const std::string &s, const char *suffix) {
+  size_t n = std::strlen(suffix);
+  return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+
+bool listDirectory(const std::string &path, std::vector<std::string> &names) {
+#ifdef _WIN32
+  WIN32_FIND_DATAA found;
+  HANDLE h = FindFirstFileA((path + "\\*").c_str(), &found);
+  if (h == INVALID_HANDLE_VALUE) return false;
+  do names.push_back(found.cFileName); while (FindNextFileA(h, &found));
+  FindClose(h);
+#else
+  DIR *dir = opendir(path.c_str());
+  if (!dir) return false;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != 0) names.push_back(entry->d_name);
+  closedir(dir);
+#endif
+  std::sort(names.begin(), names.end());
+  return true;
+}
+
+
+bool listInstances(const std::string &path, std::vector<std::string> &filenames) {
+  std::vector<std::string> names;
+  if (!listDirectory(path, names)) return false;
+  std::string dir = path;
+  if (!endsWith(dir, "/") && !endsWith(dir, "\\")) dir.append("/");
+  for (size_t n = 0; n < names.size(); n++)
+    if (endsWith(names[n], ".ctt")) filenames.push_back(dir + names[n]);
+  return true;
+}
+
+
+bool listMatches(const std::string &pattern, std::vector<std::string> &filenames) {
+  std::vector<std::string> matches;
+#ifdef _WIN32
+  WIN32_FIND_DATAA found;
+  HANDLE h = FindFirstFileA(pattern.c_str(), &found);
+  if (h == INVALID_HANDLE_VALUE) return false;
+  size_t slash = pattern.find_last_of("/\\");
+  std::string dir = (slash == std::string::npos) ? "" : pattern.substr(0, slash + 1);
+  do matches.push_back(dir + found.cFileName); while (FindNextFileA(h, &found));
+  FindClose(h);
+#else
+  glob_t found;
+  if (glob(pattern.c_str(), 0, 0, &found) != 0) return false;
+  for (size_t i = 0; i < found.gl_pathc; i++) matches.push_back(found.gl_pathv[i]);
+  globfree(&found);
+#endif
+  std::sort(matches.begin(), matches.end());
+  filenames.insert(filenames.end(), matches.begin(), matches.end());
+  return true;
+}
+
+
+std::string quoteField(const std::string &field) {
+  if (field.find_first_of(",\"\r\n") == std::string::npos) return field;
+  std::string quoted("\"");
+  for (size_t k = 0; k < field.size(); k++) {
+    if (field[k] == '"') quoted += '"';
+    quoted += field[k];
+  }
+  return quoted + "\"";
+}
+
+
+void splitFields(const std::string &line, std::vector<std::string> &fields) {
+  std::string field;
+  bool quoted = false;
+  for (size_t k = 0; k < line.size(); k++) {
+    if (quoted && line[k] == '"' && k + 1 < line.size() && line[k + 1] == '"') field += line[++k];
+    else if (line[k] == '"') quoted = !quoted;
+    else if (line[k] == ',' && !quoted) {
+      fields.push_back(field);
+      field.clear();
+    }
+    else field += line[k];
+  }
+  fields.push_back(field);
+}
@@ -0,0 +1,52 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_BATCH
+#define UDINE_BATCH
+
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+// Helpers for the tools that run over many instances at once
+
+bool endsWith(const std::string &s, const char *suffix);
+
+// The names of the entries of a directory, sorted; false if it cannot be read
+bool listDirectory(const std::string &path, std::vector<std::string> &names);
+
+// Appends the paths of the instances <data>.ctt in a directory, sorted
+bool listInstances(const std::string &path, std::vector<std::string> &filenames);
+
+// Appends the paths matching a pattern with wildcards, e.g. ./data/comp*.ctt, sorted
+bool listMatches(const std::string &pattern, std::vector<std::string> &filenames);
+
+// Quotes a field of a CSV, if it has a comma, a quote or a line break in it
+std::string quoteField(const std::string &field);
+
+// Splits a line of a CSV into its fields, unquoting those quoted as by quoteField
+void splitFields(const std::string &line, std::vector<std::string> &fields);
+
+// Hands out indices 0 .. count-1 to the worker threads
+class WorkQueue {
+protected:
+  boost::mutex lock;
+  int next, count;
+public:
+  WorkQueue(int n) : next(0), count(n) {}
+  int pop() {
+    boost::mutex::scoped_lock l(lock);
+    return (next < count) ? next++ : -1;
+  }
+};
+
+#endif // UDINE_BATCH
@@ -0,0 +1,329 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+#include "batch.h"
+#include "events.h"
+
+// Runs udine over many instances at once, within a budget of cores and memory per job,
+// as many jobs at a time as the machine has room for, e.g.:
+//   udine-batch -c 4 -m 4096 -o results.csv ./data/comp*.ctt -- -b
+// Each job writes its output to <data>.txt, with .ctt left out, and the results of the jobs
+// finished so far go to a manifest, so that an interrupted batch is resumed by running it again.
+// The manifest and the table of results are CSV, with the instance quoted if it has a comma or a quote.
+// With -a, the instances form an array of tasks, as with qsub -t of Sun Grid Engine:
+// %d in the instances is replaced by the task, which is also in $SGE_TASK_ID, e.g.:
+//   udine-batch -a 1-14 examples-sge/comp%d.ctt
+// The exit code is 1 if any job failed, and 0 otherwise.
+
+struct BatchJob {
+  std::string instance;
+  int task;              // 0 outside of an array
+  // Results
+  bool done;
+  int status;            // the exit code of udine, or 128 plus the signal, or 127 if it could not be run
+  double wall;           // seconds
+  EventSummary summary;
+};
+
+
+// The key of a job in the manifest
+static std::string getKey(const std::string &instance, int task) {
+  std::ostringstream key;
+  key << quoteField(instance) << "," << task;
+  return key.str();
+}
+
+
+static void writeHeader(std::ostream &out) {
+  out << "instance,task,status,wall,time,nodes,bound,incumbent,incumbents" << std::endl;
+}
+
+
+static void writeRow(std::ostream &out, const BatchJob &job) {
+  out << quoteField(job.instance) << "," << job.task << "," << job.status << "," << job.wall << ","
+    << job.summary.time << "," << job.summary.nodes << "," << job.summary.bound << ",";
+  if (job.summary.incumbents > 0) out << job.summary.incumbent;
+  out << "," << job.summary.incumbents << std::endl;
+}
+
+
+// Reads the jobs finished successfully from a manifest, by their keys
+static void readManifest(const std::string &path, std::map<std::string, BatchJob> &finished) {
+  std::ifstream in(path.c_str());
+  std::string line;
+  std::getline(in, line);
+  while (std::getline(in, line)) {
+    std::vector<std::string> cells;
+    splitFields(line, cells);
+    if (cells.size() < 8) continue;
+    BatchJob job;
+    job.instance = cells[0];
+    job.task = std::atoi(cells[1].c_str());
+    job.status = std::atoi(cells[2].c_str());
+    job.wall = std::atof(cells[3].c_str());
+    job.summary.time = std::atof(cells[4].c_str());
+    job.summary.nodes = std::atoi(cells[5].c_str());
+    job.summary.bound = std::atof(cells[6].c_str());
+    job.summary.incumbent = std::atof(cells[7].c_str());
+    job.summary.incumbents = cells.size() > 8 ? std::atoi(cells[8].c_str()) : 0;
+    job.done = true;
+    if (job.status == 0) finished[getKey(job.instance, job.task)] = job;
+  }
+}
+
+
+// Writes a job finished to the manifest and says so
+static void reportJob(std::ofstream &log, const BatchJob &job, int done, size_t total) {
+  writeRow(log, job);
+  log.flush();
+  std::cout << "Batch: [" << done << "/" << total << "] " << job.instance;
+  if (job.task > 0) std::cout << " (task " << job.task << ")";
+  std::cout << " finished with " << job.status << " in " << job.wall << " s, bound " << job.summary.bound;
+  if (job.summary.incumbents > 0) std::cout << " and incumbent " << job.summary.incumbent;
+  std::cout << std::endl;
+}
+
+
+// Where the output of udine goes: <data>.txt, with .ctt left out, as run-all used to have it
+static std::string getOutput(const std::string &instance) {
+  std::string output(instance);
+  if (endsWith(output, ".ctt")) output = output.substr(0, output.size() - 4);
+  return output.append(".txt");
+}
+
+
+#ifndef _WIN32
+static pid_t launch(const std::string &udine, const std::vector<std::string> &arguments, const BatchJob &job,
+                    int cores, long memory, int first, int last, int step) {
+  // A log left from an earlier run would be summarised as that of this one
+  std::remove((job.instance + ".events").c_str());
+  pid_t pid = fork();
+  if (pid != 0) return pid;
+
+  // In the child
+  if (memory > 0) {
+    struct rlimit limit;
+    limit.rlim_cur = limit.rlim_max = rlim_t(memory) * 1024 * 1024;
+    setrlimit(RLIMIT_AS, &limit);
+  }
+  if (job.task > 0) {
+    std::ostringstream task, range;
+    task << job.task;
+    setenv("SGE_TASK_ID", task.str().c_str(), 1);
+    range << first;
+    setenv("SGE_TASK_FIRST", range.str().c_str(), 1);
+    range.str("");
+    range << last;
+    setenv("SGE_TASK_LAST", range.str().c_str(), 1);
+    range.str("");
+    range << step;
+    setenv("SGE_TASK_STEPSIZE", range.str().c_str(), 1);
+  }
+  int fd = open(getOutput(job.instance).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd >= 0) {
+    dup2(fd, 1);
+    dup2(fd, 2);
+    close(fd);
+  }
+
+  std::vector<std::string> args;
+  args.push_back(udine);
+  std::ostringstream threads;
+  threads << cores;
+  if (cores > 0) {
+    args.push_back("-t");
+    args.push_back(threads.str());
+  }
+  args.insert(args.end(), arguments.begin(), arguments.end());
+  args.push_back(job.instance);
+  std::vector<char *> argv;
+  for (size_t i = 0; i < args.size(); i++) argv.push_back(const_cast<char *>(args[i].c_str()));
+  argv.push_back(0);
+  execv(udine.c_str(), &argv[0]);
+  std::perror("Batch: Cannot run udine");
+  _exit(127);
+}
+#endif
+
+
+int main(int argc, char **argv) {
+  std::string udine("./bin/udine"), output, manifest("batch.manifest");
+  std::vector<std::string> patterns, arguments;
+  int cores = 0, jobs = 0;
+  long memory = 0;
+  int first = 0, last = -1, step = 1;
+
+  for (int a = 1; a < argc; a++) {
+    std::string arg(argv[a]);
+    if (arg == "--") {
+      arguments.insert(arguments.end(), argv + a + 1, argv + argc);
+      break;
+    }
+    if (arg == "-c" && a + 1 < argc) { cores = std::atoi(argv[++a]); continue; }
+    if (arg == "-m" && a + 1 < argc) { memory = std::atol(argv[++a]); continue; }
+    if (arg == "-j" && a + 1 < argc) { jobs = std::atoi(argv[++a]); continue; }
+    if (arg == "-u" && a + 1 < argc) { udine = argv[++a]; continue; }
+    if (arg == "-o" && a + 1 < argc) { output = argv[++a]; continue; }
+    if (arg == "-r" && a + 1 < argc) { manifest = argv[++a]; continue; }
+    if (arg == "-a" && a + 1 < argc) {
+      if (std::sscanf(argv[++a], "%d-%d:%d", &first, &last, &step) < 2 || first < 1 || last < first || step < 1) {
+        std::cerr << "Batch: Cannot read the array " << argv[a] << std::endl;
+        exit(-1);
+      }
+      continue;
+    }
+    patterns.push_back(arg);
+  }
+
+  if (patterns.empty()) {
+    std::cerr << "Usage: " << argv[0] << " [-c <cores>] [-m <megabytes>] [-j <jobs>] [-u <udine>] [-o <results>] [-r <manifest>]" << std::endl;
+    std::cerr << "       [-a <first>-<last>[:<step>]] <data> [<data> ...] [-- <arguments of udine>]" << std::endl;
+    std::cerr << "where: <data> is an instance, a directory of them or a pattern such as ./data/comp*.ctt," << std::endl;
+    std::cerr << "       each run as udine -t <cores> <arguments> <data>, within <megabytes> of memory," << std::endl;
+    std::cerr << "       <jobs> at a time, or as many as the cores and the memory of the machine allow, or one," << std::endl;
+    std::cerr << "       with the results in the <manifest> (batch.manifest), which resumes the batch when run again," << std::endl;
+    std::cerr << "       and in the table <results> once done (standard output by default)," << std::endl;
+    std::cerr << "       -a runs tasks <first> to <last> of an array, replacing %d in <data> with the task" << std::endl;
+    exit(-1);
+  }
+
+  // The jobs, in the order given, with a single task of 0 outside of an array
+  bool array = (last >= first);
+  if (!array) first = last = 0;
+  std::vector<BatchJob> batch;
+  for (int task = first; task <= last; task += step)
+    for (size_t p = 0; p < patterns.size(); p++) {
+      std::string pattern(patterns[p]);
+      size_t at = pattern.find("%d");
+      if (array && at != std::string::npos) {
+        std::ostringstream id;
+        id << task;
+        pattern.replace(at, 2, id.str());
+      }
+      std::vector<std::string> instances;
+      if ((endsWith(pattern, ".ctt") || !listInstances(pattern, instances)) && !listMatches(pattern, instances))
+        instances.push_back(pattern);
+      for (size_t i = 0; i < instances.size(); i++) {
+        BatchJob job;
+        job.instance = instances[i];
+        job.task = task;
+        job.done = false;
+        job.status = 0;
+        job.wall = 0;
+        batch.push_back(job);
+      }
+    }
+
+  // Resume from the manifest
+  std::map<std::string, BatchJob> finished;
+  readManifest(manifest, finished);
+  int resumed = 0;
+  for (size_t j = 0; j < batch.size(); j++) {
+    std::map<std::string, BatchJob>::iterator it = finished.find(getKey(batch[j].instance, batch[j].task));
+    if (it == finished.end()) continue;
+    batch[j] = it->second;
+    resumed += 1;
+  }
+  std::ofstream log(manifest.c_str(), std::ofstream::out | std::ofstream::app);
+  if (log.tellp() == 0) writeHeader(log);
+
+  // As many jobs at a time as the cores and the memory allow
+  int hardware = std::max(1, int(boost::thread::hardware_concurrency()));
+  // Without a budget of cores, each job has the whole machine
+  int slots = jobs > 0 ? jobs : (cores > 0 ? std::max(1, hardware / cores) : 1);
+#ifndef _WIN32
+  long pages = sysconf(_SC_PHYS_PAGES), pageSize = sysconf(_SC_PAGE_SIZE);
+  if (jobs <= 0 && memory > 0 && pages > 0 && pageSize > 0)
+    slots = std::max(1, std::min<int>(slots, (double(pages) * pageSize / (1024 * 1024)) / memory));
+#endif
+  std::cout << "Batch: " << batch.size() << " job(s), " << resumed << " done before, " << slots << " at a time" << std::endl;
+
+  int failures = 0;
+#ifdef _WIN32
+  std::cerr << "Batch: Running jobs is not supported on Windows" << std::endl;
+  failures = batch.size() - resumed;
+#else
+  std::map<pid_t, int> running;
+  std::map<pid_t, boost::system_time> started;
+  size_t next = 0;
+  int done = resumed;
+  for (;;) {
+    while (int(running.size()) < slots && next < batch.size()) {
+      if (!batch[next].done) {
+        pid_t pid = launch(udine, arguments, batch[next], cores, memory, first, last, step);
+        if (pid < 0) {
+          std::perror("Batch: Cannot fork");
+          // The job waits for one of those running to finish, or fails, if there are none
+          if (!running.empty()) break;
+          BatchJob &job = batch[next];
+          job.done = true;
+          job.status = 127;
+          done += 1;
+          failures += 1;
+          reportJob(log, job, done, batch.size());
+          next += 1;
+          continue;
+        }
+        running[pid] = next;
+        started[pid] = boost::get_system_time();
+      }
+      next += 1;
+    }
+    if (running.empty()) break;
+
+    int status;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) break;
+    if (running.find(pid) == running.end()) continue;
+    BatchJob &job = batch[running[pid]];
+    job.done = true;
+    job.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+    job.wall = (boost::get_system_time() - started[pid]).total_milliseconds() / 1000.0;
+    summariseEvents(job.instance + ".events", job.summary);
+    running.erase(pid);
+    started.erase(pid);
+    done += 1;
+
+    if (job.status != 0) failures += 1;
+    reportJob(log, job, done, batch.size());
+  }
+#endif
+  log.close();
+
+  // The table of all the jobs, in the order given
+  std::ofstream file;
+  if (!output.empty()) file.open(output.c_str(), std::ofstream::out);
+  std::ostream &out = output.empty() ? std::cout : file;
+  writeHeader(out);
+  for (size_t j = 0; j < batch.size(); j++)
+    if (batch[j].done) writeRow(out, batch[j]);
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,249 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cassert>
+#include <cstdlib>
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "batch_evaluator.h"
+
+
+inline int popcount64(Bitboard x) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(x);
+#else
+  int n = 0;
+  for (; x; n++) x &= x - 1;
+  return n;
+#endif
+}
+
+#ifdef __AVX2__
+// Four 64-bit popcounts at a time, by nibble look-ups (Mula et al.)
+inline __m256i popcount256(__m256i v) {
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  __m256i lo = _mm256_and_si256(v, nibble);
+  __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+  __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+  return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+
+inline int sum256(__m256i v) {
+  long long lanes[4];
+  _mm256_storeu_si256((__m256i *)lanes, v);
+  return int(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+#endif
+
+// The lectures without a lecture of the same curriculum just before or after on the same day
+inline Bitboard isolated(Bitboard w, Bitboard notStarts, Bitboard notEnds) {
+  return w & ~((w << 1) & notStarts) & ~((w >> 1) & notEnds);
+}
+
+// A bit at the start of each day with any lecture
+inline Bitboard daysUsed(Bitboard w, int ppd, Bitboard starts) {
+  Bitboard t = w;
+  for (int s = 1; s < ppd; s++) t |= w >> s;
+  return t & starts;
+}
+
+int sumPopcounts(const Bitboard *w, int n) {
+  int i = 0, total = 0;
+#ifdef __AVX2__
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 4 <= n; i += 4)
+    acc = _mm256_add_epi64(acc, popcount256(_mm256_loadu_si256((const __m256i *)(w + i))));
+  total = sum256(acc);
+#endif
+  for (; i < n; i++) total += popcount64(w[i]);
+  return total;
+}
+
+int sumIsolated(const Bitboard *w, int n, Bitboard notStarts, Bitboard notEnds) {
+  int i = 0, total = 0;
+#ifdef __AVX2__
+  const __m256i ns = _mm256_set1_epi64x((long long)notStarts);
+  const __m256i ne = _mm256_set1_epi64x((long long)notEnds);
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(w + i));
+    __m256i left = _mm256_and_si256(_mm256_slli_epi64(v, 1), ns);
+    __m256i right = _mm256_and_si256(_mm256_srli_epi64(v, 1), ne);
+    __m256i iso = _mm256_andnot_si256(right, _mm256_andnot_si256(left, v));
+    acc = _mm256_add_epi64(acc, popcount256(iso));
+  }
+  total = sum256(acc);
+#endif
+  for (; i < n; i++) total += popcount64(isolated(w[i], notStarts, notEnds));
+  return total;
+}
+
+// Per-word popcounts of the words themselves, or of the days used in them
+void popcounts(const Bitboard *w, int n, int *out, int ppd = 1, Bitboard starts = ~Bitboard(0)) {
+  int i = 0;
+#ifdef __AVX2__
+  const __m256i st = _mm256_set1_epi64x((long long)starts);
+  long long lanes[4];
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(w + i));
+    __m256i t = v;
+    for (int s = 1; s < ppd; s++) t = _mm256_or_si256(t, _mm256_srli_epi64(v, s));
+    _mm256_storeu_si256((__m256i *)lanes, popcount256(_mm256_and_si256(t, st)));
+    out[i] = int(lanes[0]); out[i + 1] = int(lanes[1]);
+    out[i + 2] = int(lanes[2]); out[i + 3] = int(lanes[3]);
+  }
+#endif
+  for (; i < n; i++) out[i] = popcount64(daysUsed(w[i], ppd, starts));
+}
+
+
+bool BatchEvaluator::isVectorised() {
+#ifdef __AVX2__
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+BatchEvaluator::BatchEvaluator(TimetablingInstance &i, bool singletonCurricula)
+: instance(i), P(i.getPeriodCount()), R(i.getRoomCount()), C(i.getCourseCount()),
+U(i.getCurriculumCount()), D(i.getDayCount()), ppd(i.getPeriodsPerDayCount()),
+properCurricula(i.getProperCurriculumCount()) {
+
+  assert(ppd <= 64);
+  S = singletonCurricula ? i.getSingletonCurriculumCount() : 0;
+  daysPerWord = 64 / ppd;
+  W = (D + daysPerWord - 1) / daysPerWord;
+  RW = (R + 63) / 64;
+
+  curriculumWords = (U + S) * W;
+  courseWords = C * W;
+  roomWords = R * W;
+  courseRoomWords = C * RW;
+  blockWords = curriculumWords + courseWords + roomWords + courseRoomWords;
+
+  dayStarts = dayEnds = 0;
+  for (int d = 0; d < daysPerWord; d++) {
+    dayStarts |= Bitboard(1) << (d * ppd);
+    dayEnds |= Bitboard(1) << (d * ppd + ppd - 1);
+  }
+
+  int c, r, u, f;
+  lectureCounts.resize(C);
+  minWorkingDays.resize(C);
+  capacityPenalties.resize(C * R);
+  for (c = 0; c < C; c++) {
+    lectureCounts[c] = i.getCourse(c).lectures;
+    minWorkingDays[c] = i.getCourse(c).minWorkingDays;
+    for (r = 0; r < R; r++)
+      capacityPenalties[c * R + r] = std::max(0, i.getCourse(c).students - i.getRoom(r).capacity);
+  }
+  unavailable.assign(C * P, 0);
+  for (f = 0; f < i.getRestrictionCount(); f++)
+    unavailable[i.getRestriction(f).courseId * P + i.getRestriction(f).period] = 1;
+
+  // Rows of curriculum bitboards: the proper curricula and the singletons,
+  // whose isolated lectures are counted, and then the teachers' curricula
+  courseCurricula.resize(C);
+  for (u = 0; u < U; u++) {
+    int row = (u < properCurricula) ? u : u + S;
+    for (c = 0; c < i.getCurriculum(u).courseIds.size(); c++)
+      courseCurricula[i.getCurriculum(u).courseIds[c]].push_back(row);
+  }
+  for (u = 0; u < S; u++)
+    courseCurricula[i.getSingletonCurriculum(u).courseIds[0]].push_back(properCurricula + u);
+}
+
+
+void BatchEvaluator::load(const Lectures &lectures, Bitboard *block, Penalties &p) {
+  Bitboard *curricula = block;
+  Bitboard *courses = curricula + curriculumWords;
+  Bitboard *rooms = courses + courseWords;
+  Bitboard *courseRooms = rooms + roomWords;
+  std::fill(block, block + blockWords, 0);
+  scheduled.assign(C, 0);
+  curriculumLectures.assign(U + S, 0);
+
+  for (Lectures::const_iterator it = lectures.begin(); it != lectures.end(); it++) {
+    int c = it->course, d = it->period / ppd;
+    int w = d / daysPerWord;
+    Bitboard bit = Bitboard(1) << ((d % daysPerWord) * ppd + it->period % ppd);
+    scheduled[c] += 1;
+    courses[c * W + w] |= bit;
+    rooms[it->room * W + w] |= bit;
+    courseRooms[c * RW + it->room / 64] |= Bitboard(1) << (it->room % 64);
+    for (std::vector<int>::const_iterator u = courseCurricula[c].begin(); u != courseCurricula[c].end(); u++) {
+      curricula[*u * W + w] |= bit;
+      curriculumLectures[*u] += 1;
+    }
+    p.roomCapacity += capacityPenalties[c * R + it->room];
+    p.availability += unavailable[c * P + it->period];
+  }
+}
+
+
+void BatchEvaluator::score(const Bitboard *block, Penalties &p) {
+  const Bitboard *curricula = block;
+  const Bitboard *courses = curricula + curriculumWords;
+  const Bitboard *rooms = courses + courseWords;
+  const Bitboard *courseRooms = rooms + roomWords;
+  int c, u, w;
+
+  // Isolated lectures within the proper and singleton curricula
+  p.isolatedLectures = 2 * sumIsolated(curricula, (properCurricula + S) * W, ~dayStarts, ~dayEnds);
+
+  // Lectures scheduled in excess of one per period and curriculum, course, or room
+  int lectureTotal = 0;
+  for (c = 0; c < C; c++) {
+    lectureTotal += scheduled[c];
+    p.lectures += std::abs(scheduled[c] - lectureCounts[c]);
+  }
+  int conflicts = lectureTotal - sumPopcounts(courses, courseWords);
+  for (u = 0; u < U + S; u++)
+    if (u < properCurricula || u >= properCurricula + S) conflicts += curriculumLectures[u];
+  conflicts -= sumPopcounts(curricula, properCurricula * W);
+  conflicts -= sumPopcounts(curricula + (properCurricula + S) * W, (U - properCurricula) * W);
+  p.conflicts = conflicts;
+  p.roomOccupancy = lectureTotal - sumPopcounts(rooms, roomWords);
+
+  // Days of instruction and rooms per course
+  std::vector<int> counts(std::max(courseWords, courseRoomWords));
+  popcounts(courses, courseWords, &counts[0], ppd, dayStarts);
+  for (c = 0; c < C; c++) {
+    int days = 0;
+    for (w = 0; w < W; w++) days += counts[c * W + w];
+    if (days < minWorkingDays[c]) p.minWorkingDays += 5 * (minWorkingDays[c] - days);
+  }
+  popcounts(courseRooms, courseRoomWords, &counts[0]);
+  for (c = 0; c < C; c++) {
+    int used = 0;
+    for (w = 0; w < RW; w++) used += counts[c * RW + w];
+    if (used > 1) p.roomStability += used - 1;
+  }
+}
+
+
+void BatchEvaluator::evaluate(const std::vector<Lectures> &candidates, std::vector<Penalties> &results) {
+  int n, N = candidates.size();
+  results.assign(N, Penalties());
+  boards.resize(std::max(1, blockWords));
+  for (n = 0; n < N; n++) {
+    load(candidates[n], &boards[0], results[n]);
+    score(&boards[0], results[n]);
+  }
+}
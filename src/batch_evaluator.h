@@ -0,0 +1,62 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_BATCH_EVALUATOR
+#define UDINE_BATCH_EVALUATOR
+
+#include <vector>
+
+#include "loader.h"
+#include "timetable.h"
+#include "evaluator.h"
+
+typedef unsigned long long Bitboard;
+
+/* Scores many timetables at once, with the same penalties as TimetableEvaluator.
+* Each timetable is turned into bitboards: the busy periods of each curriculum,
+* course and room, with the days packed into 64-bit words so that no day
+* straddles two words, and the rooms used by each course.
+* Isolated lectures are then found by shifts and masks, and days of instruction,
+* rooms per course and conflicts are counted by popcounts.
+* When compiled with AVX2, four words of the same timetable are processed at a time;
+* the timetables themselves go one after the other, as building their bitboards,
+* lecture by lecture, takes most of the time, and interleaving four of them in the
+* lanes does not make that any faster.
+*/
+class BatchEvaluator {
+protected:
+  TimetablingInstance &instance;
+  int P, R, C, U, S, D, ppd;
+  int properCurricula;
+  int daysPerWord, W, RW;       // words per week and per set of rooms
+  int curriculumWords, courseWords, roomWords, courseRoomWords, blockWords;
+  Bitboard dayStarts, dayEnds;  // the first and the last period of each day within a word
+
+  std::vector<int> lectureCounts, minWorkingDays, capacityPenalties;
+  std::vector<char> unavailable;
+  std::vector< std::vector<int> > courseCurricula;  // bitboard rows, isolation-relevant ones first
+
+  // Scratch space for a block of bitboards per candidate
+  std::vector<Bitboard> boards;
+  std::vector<int> scheduled, curriculumLectures;
+
+  void load(const Lectures &lectures, Bitboard *block, Penalties &p);
+  void score(const Bitboard *block, Penalties &p);
+
+public:
+  BatchEvaluator(TimetablingInstance &i, bool singletonCurricula = true);
+
+  void evaluate(const std::vector<Lectures> &candidates, std::vector<Penalties> &results);
+
+  static bool isVectorised();
+};
+
+#endif // UDINE_BATCH_EVALUATOR
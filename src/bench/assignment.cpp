@@ -0,0 +1,114 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+#include "loader.h"
+#include "assignment.h"
+
+// Times sequences of assignment problems solved cold and warm-started,
+// both on random matrices and on matrices shaped like the ITC instances,
+// and checks the warm starts give the optima the cold ones do; the exit code is 1 if not.
+
+struct Sequence {
+  int rows, columns;
+  std::vector< std::vector<int> > costs;
+};
+
+// Returns the number of the solves, where the warm start differs from the cold one
+int run(const char *label, const Sequence &seq, int repeats) {
+  AssignmentSolver solver(seq.columns);
+  std::vector<int> rowToColumn;
+  std::vector<long> cold(seq.costs.size());
+  int s, rep;
+  int mismatches = 0;
+
+  std::clock_t start = std::clock();
+  for (rep = 0; rep < repeats; rep++)
+    for (s = 0; s < seq.costs.size(); s++)
+      cold[s] = solver.solve(seq.costs[s], seq.rows, rowToColumn, false);
+  double coldTime = double(std::clock() - start) / CLOCKS_PER_SEC;
+
+  start = std::clock();
+  solver.reset(seq.columns);
+  for (rep = 0; rep < repeats; rep++)
+    for (s = 0; s < seq.costs.size(); s++)
+      if (solver.solve(seq.costs[s], seq.rows, rowToColumn, true) != cold[s]) mismatches += 1;
+  double warmTime = double(std::clock() - start) / CLOCKS_PER_SEC;
+
+  double solves = double(repeats) * seq.costs.size();
+  std::cout << label << "\t" << seq.rows << "x" << seq.columns
+    << "\tcold " << (coldTime > 0 ? solves / coldTime : 0) << " solves/s"
+    << "\twarm " << (warmTime > 0 ? solves / warmTime : 0) << " solves/s"
+    << (mismatches ? "\tMISMATCH" : "") << std::endl;
+  return mismatches;
+}
+
+// A sequence of similar random matrices, as consecutive periods would be
+Sequence randomSequence(int rows, int columns, int length, int range) {
+  Sequence seq;
+  seq.rows = rows;
+  seq.columns = columns;
+  std::vector<int> base(rows * columns);
+  for (int i = 0; i < base.size(); i++) base[i] = std::rand() % range;
+  for (int s = 0; s < length; s++) {
+    std::vector<int> cost(base);
+    for (int i = 0; i < cost.size(); i++)
+      if (std::rand() % 4 == 0) cost[i] = std::rand() % range;
+    seq.costs.push_back(cost);
+  }
+  return seq;
+}
+
+// Per-period room assignment for random course subsets of an instance:
+// costs are missing seats plus a unit for a room not used elsewhere
+Sequence instanceSequence(TimetablingInstance &instance) {
+  Sequence seq;
+  int R = instance.getRoomCount(), C = instance.getCourseCount();
+  seq.rows = (R + 1) / 2 + R / 4;
+  seq.columns = R;
+  for (int p = 0; p < instance.getPeriodCount(); p++) {
+    std::vector<int> cost(seq.rows * R);
+    for (int i = 0; i < seq.rows; i++) {
+      const Course &c = instance.getCourse(std::rand() % C);
+      for (int r = 0; r < R; r++) {
+        int missing = c.students - instance.getRoom(r).capacity;
+        cost[i * R + r] = (missing > 0 ? missing : 0) + (std::rand() % 3 == 0);
+      }
+    }
+    seq.costs.push_back(cost);
+  }
+  return seq;
+}
+
+int main(int argc, char **argv) {
+  std::srand(20100601);
+  int mismatches = 0;
+
+  int sizes[] = { 5, 10, 20, 50, 100, 200 };
+  for (int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    int repeats = sizes[s] >= 100 ? 1 : 20;
+    mismatches += run("random", randomSequence(sizes[s], sizes[s], 45, 1000), repeats);
+    mismatches += run("random", randomSequence(sizes[s] / 2, sizes[s], 45, 1000), repeats);
+  }
+
+  // Instances given on the command line, e.g. examples/comp*.ctt
+  for (int a = 1; a < argc; a++) {
+    TimetablingInstance instance;
+    instance.load(argv[a]);
+    mismatches += run(argv[a], instanceSequence(instance), 200);
+  }
+
+  return mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,89 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "loader.h"
+#include "timetable.h"
+#include "evaluator.h"
+#include "batch_evaluator.h"
+
+// Scores a population of perturbations of <instance>.sol for each instance given,
+// e.g. examples/comp*.ctt, checks the scores against TimetableEvaluator,
+// and reports candidates per second.
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <data> [<data> ...]" << std::endl;
+    std::cerr << "where: <data>.sol is a timetable for the instance <data>" << std::endl;
+    exit(-1);
+  }
+
+  std::srand(20100601);
+  const int population = 4096;
+  int failures = 0;
+  std::cout << "Batch: " << (BatchEvaluator::isVectorised() ? "AVX2" : "scalar") << " kernels" << std::endl;
+
+  for (int a = 1; a < argc; a++) {
+    TimetablingInstance instance;
+    instance.load(argv[a]);
+    std::string solFilename(argv[a]);
+    solFilename.append(".sol");
+
+    Lectures lectures;
+    if (!loadSolution(instance, solFilename.c_str(), lectures) || lectures.empty()) {
+      std::cerr << "Batch: No timetable in " << solFilename << std::endl;
+      continue;
+    }
+
+    // Candidates differ from the timetable by a few random moves
+    int L = lectures.size(), P = instance.getPeriodCount(), R = instance.getRoomCount();
+    std::vector<Lectures> candidates(population, lectures);
+    for (int n = 0; n < population; n++)
+      for (int m = n % 8; m > 0; m--) {
+        Lecture &l = candidates[n][std::rand() % L];
+        l.period = std::rand() % P;
+        l.room = std::rand() % R;
+      }
+
+    BatchEvaluator batch(instance);
+    std::vector<Penalties> scores;
+    std::clock_t start = std::clock();
+    const int repeats = 5;
+    for (int rep = 0; rep < repeats; rep++)
+      batch.evaluate(candidates, scores);
+    double time = double(std::clock() - start) / CLOCKS_PER_SEC;
+
+    TimetableEvaluator evaluator(instance);
+    start = std::clock();
+    for (int n = 0; n < population; n++) {
+      Penalties d = evaluator.evaluate(candidates[n]) - scores[n];
+      if (d.lectures || d.conflicts || d.roomOccupancy || d.availability || d.roomCapacity
+        || d.minWorkingDays || d.isolatedLectures || d.roomStability) {
+          std::cout << "Batch: MISMATCH for candidate " << n << ": " << scores[n]
+          << " instead of " << evaluator.getPenalties() << std::endl;
+          failures += 1;
+          break;
+      }
+    }
+    double reference = double(std::clock() - start) / CLOCKS_PER_SEC;
+
+    std::cout << "Batch: " << argv[a] << ": "
+      << (time > 0 ? repeats * population / time : 0) << " candidates/s, against "
+      << (reference > 0 ? population / reference : 0) << " candidates/s by full evaluation" << std::endl;
+  }
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,130 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "loader.h"
+#include "timetable.h"
+#include "evaluator.h"
+
+// Evaluates <instance>.sol for each instance given, e.g. examples/comp*.ctt,
+// compares the total with the "Cost" recorded in the file, if any,
+// checks move and swap deltas against full evaluations, and times them.
+
+int recordedCost(const std::string &filename) {
+  std::ifstream file(filename.c_str());
+  std::string line;
+  int cost = -1;
+  while (std::getline(file, line))
+    if (line.compare(0, 5, "Cost ") == 0) cost = std::atoi(line.c_str() + 5);
+  return cost;
+}
+
+bool same(const Penalties &a, const Penalties &b) {
+  Penalties d = a - b;
+  return d.getHard() == 0 && d.getSoft() == 0 && d.roomCapacity == 0 && d.minWorkingDays == 0
+    && d.isolatedLectures == 0 && d.roomStability == 0 && d.conflicts == 0 && d.roomOccupancy == 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <data> [<data> ...]" << std::endl;
+    std::cerr << "where: <data>.sol is a timetable for the instance <data>" << std::endl;
+    exit(-1);
+  }
+
+  std::srand(20100601);
+  int failures = 0;
+
+  for (int a = 1; a < argc; a++) {
+    TimetablingInstance instance;
+    instance.load(argv[a]);
+    std::string solFilename(argv[a]);
+    solFilename.append(".sol");
+
+    Lectures lectures;
+    if (!loadSolution(instance, solFilename.c_str(), lectures) || lectures.empty()) {
+      std::cerr << "Evaluator: No timetable in " << solFilename << std::endl;
+      continue;
+    }
+
+    TimetableEvaluator evaluator(instance);
+    TimetableEvaluator reference(instance);
+    Penalties total = evaluator.evaluate(lectures);
+    std::cout << "Evaluator: " << solFilename << ": " << total << std::endl;
+    int recorded = recordedCost(solFilename);
+    if (recorded >= 0 && (total.getHard() > 0 || total.getSoft() != recorded)) {
+      std::cout << "Evaluator: MISMATCH, the file records cost " << recorded << std::endl;
+      failures += 1;
+    }
+
+    int L = lectures.size(), P = instance.getPeriodCount(), R = instance.getRoomCount();
+    int i;
+
+    // Deltas against full evaluations, applying some of the moves
+    for (i = 0; i < 2000; i++) {
+      int l = std::rand() % L, m = std::rand() % L, p = std::rand() % P, r = std::rand() % R;
+      Lectures changed(evaluator.getLectures());
+      Penalties delta;
+      if (i % 2) {
+        delta = evaluator.getMoveDelta(l, p, r);
+        changed[l].period = p; changed[l].room = r;
+      } else {
+        delta = evaluator.getSwapDelta(l, m);
+        std::swap(changed[l].period, changed[m].period);
+        std::swap(changed[l].room, changed[m].room);
+      }
+      Penalties expected = reference.evaluate(changed) - evaluator.getPenalties();
+      if (!same(delta, expected)) {
+        std::cout << "Evaluator: MISMATCH in a delta: " << delta << " instead of " << expected << std::endl;
+        failures += 1;
+        break;
+      }
+      if (i % 7 == 0) {
+        if (i % 2) evaluator.move(l, p, r);
+        else evaluator.swap(l, m);
+        if (!same(evaluator.getPenalties(), reference.getPenalties())) {
+          std::cout << "Evaluator: MISMATCH after a move" << std::endl;
+          failures += 1;
+          break;
+        }
+      }
+    }
+
+    // Throughput
+    evaluator.evaluate(lectures);
+    const int moves = 1000000;
+    long sink = 0;
+    std::clock_t start = std::clock();
+    for (i = 0; i < moves; i++)
+      sink += evaluator.getMoveDelta(std::rand() % L, std::rand() % P, std::rand() % R).getSoft();
+    double moveTime = double(std::clock() - start) / CLOCKS_PER_SEC;
+    start = std::clock();
+    for (i = 0; i < moves; i++)
+      sink += evaluator.getSwapDelta(std::rand() % L, std::rand() % L).getSoft();
+    double swapTime = double(std::clock() - start) / CLOCKS_PER_SEC;
+    start = std::clock();
+    for (i = 0; i < 1000; i++)
+      sink += reference.evaluate(lectures).getSoft();
+    double fullTime = double(std::clock() - start) / CLOCKS_PER_SEC;
+
+    std::cout << "Evaluator: " << (moveTime > 0 ? moves / moveTime : 0) << " moves/s, "
+      << (swapTime > 0 ? moves / swapTime : 0) << " swaps/s, "
+      << (fullTime > 0 ? 1000 / fullTime : 0) << " full evaluations/s"
+      << (sink == 42 ? " " : "") << std::endl;
+  }
+
+  return failures > 0 ? 1 : 0;
+}
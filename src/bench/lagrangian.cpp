@@ -0,0 +1,91 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "loader.h"
+#include "timetable.h"
+#include "evaluator.h"
+#include "bounds.h"
+#include "lagrangian.h"
+
+// Computes the combinatorial and Lagrangian bounds for each instance given,
+// e.g. examples/comp*.ctt, checks them against the cost of <instance>.sol,
+// if any, and counts the variables that could be fixed given that cost,
+// none of which may be a lecture of <instance>.sol, as it is of that cost.
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <data> [<data> ...]" << std::endl;
+    std::cerr << "where: <data>.sol, if present, is a timetable for the instance <data>" << std::endl;
+    exit(-1);
+  }
+
+  int failures = 0;
+  int threads = std::max(1, int(boost::thread::hardware_concurrency()));
+
+  for (int a = 1; a < argc; a++) {
+    TimetablingInstance instance;
+    instance.load(argv[a]);
+    std::string solFilename(argv[a]);
+    solFilename.append(".sol");
+
+    // The cost of the timetable, as in the model, i.e. without the singleton curricula
+    int cost = -1;
+    Lectures lectures;
+    if (loadSolution(instance, solFilename.c_str(), lectures) && !lectures.empty()) {
+      TimetableEvaluator evaluator(instance, false);
+      const Penalties &penalties = evaluator.evaluate(lectures);
+      if (penalties.getHard() == 0) cost = penalties.getSoft();
+    }
+
+    Penalties combinatorial = getLowerBounds(instance, false);
+    LagrangianBound lagrangian(instance, threads);
+    boost::system_time start = boost::get_system_time();
+    int bound = lagrangian.solve(cost);
+    double time = (boost::get_system_time() - start).total_milliseconds() / 1000.0;
+    int total = bound + combinatorial.isolatedLectures;
+
+    std::cout << "Lagrangian: " << argv[a] << ": bound " << bound
+      << " plus isolated lectures " << combinatorial.isolatedLectures << " in " << time << " s"
+      << ", against combinatorial " << combinatorial.getSoft();
+    if (cost >= 0) {
+      Lectures fixed;
+      lagrangian.getFixings(cost - combinatorial.isolatedLectures, fixed);
+      std::cout << " and cost " << cost << ", fixing " << fixed.size() << " of "
+        << instance.getPeriodCount() * instance.getRoomCount() * instance.getCourseCount() << " variables";
+      if (std::max(total, combinatorial.getSoft()) > cost) {
+        std::cout << std::endl << "Lagrangian: INVALID bound above the cost";
+        failures += 1;
+      }
+      int P = instance.getPeriodCount(), R = instance.getRoomCount();
+      std::set<int> held;
+      for (Lectures::const_iterator it = lectures.begin(); it != lectures.end(); it++)
+        held.insert((it->course * P + it->period) * R + it->room);
+      int wrong = 0;
+      for (Lectures::const_iterator it = fixed.begin(); it != fixed.end(); it++)
+        if (held.count((it->course * P + it->period) * R + it->room)) wrong += 1;
+      if (wrong > 0) {
+        std::cout << std::endl << "Lagrangian: INVALID fixing of " << wrong << " lecture(s) of the timetable";
+        failures += 1;
+      }
+    }
+    std::cout << std::endl;
+  }
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,69 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "loader.h"
+#include "assignment.h"
+#include "pdhg.h"
+
+// Solves the LP relaxations of random assignment problems, whose optima
+// are integral and known from AssignmentSolver, with one thread and with all,
+// checks the bounds, and times them.
+
+int main() {
+  std::srand(20100601);
+  int failures = 0;
+  int threads = std::max(1, int(boost::thread::hardware_concurrency()));
+
+  for (int N = 25; N <= 200; N *= 2) {
+    std::vector<int> cost(N * N);
+    for (int k = 0; k < N * N; k++) cost[k] = std::rand() % 100;
+    AssignmentSolver assignment(N);
+    std::vector<int> rowToColumn;
+    long optimum = assignment.solve(cost, N, rowToColumn, false);
+
+    SparseLP lp;
+    int i, j;
+    for (i = 0; i < N * N; i++) lp.addColumn(0, 1, cost[i]);
+    std::vector<int> columns(N);
+    std::vector<double> ones(N, 1);
+    for (i = 0; i < N; i++) {
+      for (j = 0; j < N; j++) columns[j] = i * N + j;
+      lp.addRow(1, 1, columns, ones);
+    }
+    for (j = 0; j < N; j++) {
+      for (i = 0; i < N; i++) columns[i] = i * N + j;
+      lp.addRow(1, 1, columns, ones);
+    }
+
+    for (int t = 1; t <= threads; t = (t == threads) ? t + 1 : threads) {
+      PdhgSolver pdhg(lp, t);
+      boost::system_time start = boost::get_system_time();
+      double bound = pdhg.solve(1e-6);
+      double time = (boost::get_system_time() - start).total_milliseconds() / 1000.0;
+      std::cout << "PDHG: " << N << "x" << N << " assignment with " << t << " threads: bound " << bound
+        << " against " << optimum << " after " << pdhg.getIterations() << " iterations in " << time << " s" << std::endl;
+      if (bound > optimum + 1e-6 || bound < optimum - 1e-3 * (1 + optimum)) {
+        std::cout << "PDHG: MISMATCH" << std::endl;
+        failures += 1;
+      }
+    }
+  }
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+#include <ilcplex/ilocplex.h>
+
+#include "loader.h"
+#include "solver.h"
+#include "pdhg.h"
+
+ILOSTLBEGIN
+
+// Solves the root LP of each instance given, e.g. examples/comp01.ctt, by PDHG on the sparse LP
+// of TimetablingSolver::getSparseLP, as udine does with firstOrderLP = on, and by CPLEX on the
+// relaxation of the same model, and checks that the bound of PDHG is valid, i.e. no more than
+// the LP value of CPLEX, and within <gap> of it. The exit code is 1 on any mismatch.
+
+int main(int argc, char **argv) {
+  double gap = 1e-3;
+  int threads = std::max(1, int(boost::thread::hardware_concurrency()));
+  std::vector<std::string> instances;
+  for (int a = 1; a < argc; a++) {
+    std::string arg(argv[a]);
+    if (arg == "-g" && a + 1 < argc) { gap = std::atof(argv[++a]); continue; }
+    if (arg == "-t" && a + 1 < argc) { threads = std::max(1, std::atoi(argv[++a])); continue; }
+    instances.push_back(arg);
+  }
+  if (instances.empty()) {
+    std::cerr << "Usage: " << argv[0] << " [-g <gap>] [-t <threads>] <data> [<data> ...]" << std::endl;
+    std::cerr << "where: <gap> (0.001) is the relative gap allowed between the bound of PDHG and the LP value," << std::endl;
+    std::cerr << "       and PDHG and CPLEX run on <threads> (all) threads" << std::endl;
+    exit(-1);
+  }
+
+  int failures = 0;
+  for (size_t i = 0; i < instances.size(); i++) {
+    IloEnv env;
+    env.setOut(env.getNullStream());
+    env.setWarning(env.getNullStream());
+    try {
+      TimetablingInstance instance;
+      std::string error;
+      if (!instance.parse(instances[i].c_str(), error)) {
+        std::cerr << "RootLP: There was an error reading the instance " << instances[i] << ": " << error << std::endl;
+        failures += 1;
+        env.end();
+        continue;
+      }
+      IloModel model(env);
+      TimetablingSolver solver(model, instance);
+
+      SparseLP lp;
+      solver.getSparseLP(lp);
+      PdhgSolver pdhg(lp, threads);
+      IloNum start = env.getTime();
+      double bound = pdhg.solve(1e-6);
+      double pdhgTime = env.getTime() - start;
+
+      IloConversion relaxation(env, solver.getVariables().all, ILOFLOAT);
+      model.add(relaxation);
+      IloCplex cplex(model);
+      cplex.setParam(IloCplex::Threads, threads);
+      start = env.getTime();
+      if (!cplex.solve()) {
+        std::cout << "RootLP: " << instances[i] << ": CPLEX finds no LP optimum, status " << cplex.getStatus() << std::endl;
+        failures += 1;
+        env.end();
+        continue;
+      }
+      double value = cplex.getObjValue();
+      double cplexTime = env.getTime() - start;
+
+      std::cout << "RootLP: " << instances[i] << ": " << lp.getColumnCount() << " columns, bound " << bound
+        << " after " << pdhg.getIterations() << " iterations in " << pdhgTime << " s, against the LP value "
+        << value << " of CPLEX in " << cplexTime << " s" << std::endl;
+      if (bound > value + 1e-6 * (1 + std::fabs(value))) {
+        std::cout << "RootLP: MISMATCH, the bound exceeds the LP value" << std::endl;
+        failures += 1;
+      } else if (bound < value - gap * (1 + std::fabs(value))) {
+        std::cout << "RootLP: MISMATCH, the bound is further than " << gap << " from the LP value" << std::endl;
+        failures += 1;
+      }
+    }
+    catch (IloException& e) {
+      std::cerr << "RootLP: Concert exception caught: " << e << std::endl;
+      failures += 1;
+    }
+    catch (...) {
+      std::cerr << "RootLP: Unknown exception caught" << std::endl;
+      failures += 1;
+    }
+    env.end();
+  }
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/thread/thread_time.hpp>
+
+#include "loader.h"
+#include "conflicts.h"
+#include "separators.h"
+#include "snapshots.h"
+
+// Replays the relaxations recorded by udine -s in <data>.snapshots through the separators,
+// without CPLEX: the families separated in each call should find the very cuts recorded,
+// and each family is timed on all the relaxations, whether it was separated or not.
+// The calls of each thread are replayed on separators of their own, as the clique pool
+// of each clone of the cut manager only knows the cliques that clone added.
+// The exit code is 1 if the cuts differ in any of the snapshots, and 0 otherwise.
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <data> [<snapshots>]" << std::endl;
+    std::cerr << "where: <snapshots> is <data>.snapshots by default, as recorded by udine -s" << std::endl;
+    exit(-1);
+  }
+
+  TimetablingInstance instance;
+  instance.load(argv[1]);
+  std::string filename(argv[1]);
+  if (argc > 2) filename = argv[2];
+  else filename.append(".snapshots");
+
+  SnapshotFile file;
+  if (!file.open(filename, instance)) {
+    std::cerr << "Replay: Cannot read " << filename << " as snapshots of " << argv[1] << std::endl;
+    exit(-1);
+  }
+
+  Graph conflictGraph;
+  conflictGraph.generateConflictGraph(instance);
+  conflictGraph.generateAllCliques();
+
+  // The clique pool carries over from call to call, so that the families recorded
+  // are replayed in order on one set of separators per thread, and the timing runs on another
+  std::map<int, Separators> replays;
+  Separators timing(instance, conflictGraph);
+
+  std::vector<int> calls(CutFamilyCount, 0), found(CutFamilyCount, 0);
+  std::vector<double> milliseconds(CutFamilyCount, 0);
+  int snapshots = 0, mismatches = 0, matched = 0, missing = 0, extra = 0;
+
+  Snapshot snapshot;
+  Relaxation relaxation;
+  std::vector<Cut> cuts;
+  while (file.read(snapshot)) {
+    snapshot.getRelaxation(instance, relaxation);
+    snapshots += 1;
+
+    std::map<int, Separators>::iterator replay = replays.find(snapshot.thread);
+    if (replay == replays.end())
+      replay = replays.insert(std::make_pair(snapshot.thread, Separators(instance, conflictGraph))).first;
+
+    std::vector<CutKey> keys;
+    int family;
+    for (family = 0; family < CutFamilyCount; family++) {
+      if (!(snapshot.families & (1 << family))) continue;
+      cuts.clear();
+      replay->second.separate(family, relaxation, cuts);
+      for (size_t i = 0; i < cuts.size(); i++) {
+        CutKey key;
+        key.family = cuts[i].family;
+        for (int k = 0; k < 4; k++) key.key[k] = cuts[i].key[k];
+        keys.push_back(key);
+      }
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<CutKey> recorded(snapshot.cuts);
+    std::sort(recorded.begin(), recorded.end());
+    std::vector<CutKey> common;
+    std::set_intersection(keys.begin(), keys.end(), recorded.begin(), recorded.end(), std::back_inserter(common));
+    matched += common.size();
+    missing += recorded.size() - common.size();
+    extra += keys.size() - common.size();
+    if (common.size() != keys.size() || common.size() != recorded.size()) {
+      mismatches += 1;
+      std::cout << "Replay: Call " << snapshot.call << " of thread " << snapshot.thread << " at node " << snapshot.nodes << " found " << keys.size()
+        << " cut(s), where " << recorded.size() << " were recorded, " << common.size() << " in common" << std::endl;
+    }
+
+    for (family = 0; family < CutFamilyCount; family++) {
+      cuts.clear();
+      boost::system_time start = boost::get_system_time();
+      timing.separate(family, relaxation, cuts);
+      milliseconds[family] += (boost::get_system_time() - start).total_microseconds() / 1000.0;
+      calls[family] += 1;
+      found[family] += cuts.size();
+    }
+  }
+
+  std::cout << "Replay: " << snapshots << " snapshot(s) of " << argv[1] << " in " << replays.size() << " thread(s), with " << matched << " cut(s) matched, "
+    << missing << " missing and " << extra << " extra" << std::endl;
+  for (int family = 0; family < CutFamilyCount; family++)
+    std::cout << "Replay: " << getCutFamilyName(family) << "\t" << calls[family] << " calls\t"
+      << milliseconds[family] << " ms\t" << found[family] << " cuts" << std::endl;
+
+  return mismatches > 0 ? 1 : 0;
+}
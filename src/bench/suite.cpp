@@ -0,0 +1,252 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/thread/thread_time.hpp>
+#include <ilcplex/ilocplex.h>
+
+#include "loader.h"
+#include "conflicts.h"
+#include "solver.h"
+#include "cut_manager.h"
+#include "saver.h"
+#include "batch.h"
+#include "benchmark.h"
+
+ILOSTLBEGIN
+
+// Times the phases of the solver on each instance given, e.g. examples/comp*.ctt, and on
+// copies of each scaled up, over a number of repeated runs, which CPLEX runs deterministically:
+// load, pattern enumeration, conflict graph, clique enumeration, model build, the root LP,
+// the time to the first incumbent and the bound at the time limit. The timings are written
+// as JSON and compared with a baseline, if any; the exit code is 1 on any regression or failed run.
+// The copies and the logs, timetables and output of the runs go to a scratch directory.
+
+struct SuiteSettings {
+  int repeats, seed, copies, threads;
+  double timeLimit;
+  std::string scratch;
+};
+
+
+static double getSeconds(const boost::system_time &start) {
+  return (boost::get_system_time() - start).total_microseconds() / 1000000.0;
+}
+
+
+// The name of the instance in the report, e.g. comp01 for examples/comp01.ctt
+static std::string getLabel(const std::string &data) {
+  std::string label(data);
+  size_t slash = label.find_last_of("/\\");
+  if (slash != std::string::npos) label = label.substr(slash + 1);
+  if (endsWith(label, ".ctt")) label = label.substr(0, label.size() - 4);
+  return label;
+}
+
+
+// Where the files of a run of the instance go, e.g. bin/comp01.ctt for examples/comp01.ctt
+static std::string getScratchPath(const SuiteSettings &settings, const std::string &data) {
+  std::string name(data);
+  size_t slash = name.find_last_of("/\\");
+  if (slash != std::string::npos) name = name.substr(slash + 1);
+  return settings.scratch + "/" + name;
+}
+
+
+bool runPhases(const std::string &data, const std::string &label, const SuiteSettings &settings, BenchmarkReport &report) {
+  bool success = true;
+  std::srand(settings.seed);
+
+  IloEnv env;
+  const std::string base(getScratchPath(settings, data));
+  std::string filename(base);
+  ofstream out(filename.append(".bench.out").c_str(), std::ofstream::out);
+  env.setOut(out);
+  env.setWarning(out);
+
+  try {
+    boost::system_time start = boost::get_system_time();
+    TimetablingInstance instance;
+    std::string error;
+    if (!instance.parse(data.c_str(), error)) {
+      std::cerr << "Bench: There was an error reading the instance " << data << ": " << error << std::endl;
+      env.end();
+      return false;
+    }
+    report.add(label, "load", getSeconds(start));
+
+    start = boost::get_system_time();
+    instance.getPatterns();
+    report.add(label, "patterns", getSeconds(start));
+
+    Graph conflictGraph;
+    start = boost::get_system_time();
+    conflictGraph.generateConflictGraph(instance);
+    report.add(label, "graph", getSeconds(start));
+    start = boost::get_system_time();
+    conflictGraph.generateAllCliques();
+    report.add(label, "cliques", getSeconds(start));
+
+    // The model includes the conflict graph and the cliques again
+    IloModel model(env);
+    start = boost::get_system_time();
+    TimetablingSolver solver(model, instance);
+    report.add(label, "model", getSeconds(start));
+
+    // The root LP, without the lazy pattern cuts
+    IloConversion relaxation(env, solver.getVariables().all, ILOFLOAT);
+    model.add(relaxation);
+    IloCplex lp(model);
+    if (settings.threads > 0) lp.setParam(IloCplex::Threads, settings.threads);
+    start = boost::get_system_time();
+    lp.solve();
+    report.add(label, "rootlp", getSeconds(start), lp.getObjValue());
+    lp.end();
+    model.remove(relaxation);
+
+    // The branch-and-cut of udine up to the time limit, run deterministically
+    IloCplex cplex(model);
+    if (report.version.empty()) report.version = cplex.getVersion();
+    if (settings.threads > 0) cplex.setParam(IloCplex::Threads, settings.threads);
+    cplex.setParam(IloCplex::ParallelMode, 1);
+    cplex.setParam(IloCplex::TiLim, settings.timeLimit);
+    cplex.setParam(IloCplex::MIPEmphasis, 3);
+    cplex.setParam(IloCplex::RootAlg, 6);
+    cplex.setParam(IloCplex::HeurFreq, -1);
+    cplex.setParam(IloCplex::RINSHeur, -1);
+    cplex.setParam(IloCplex::FPHeur, -1);
+
+    filename = base;
+    EventLog events(filename.append(".bench.events"));
+    SeparationPolicy policy;
+    SeparationScheduler scheduler(policy);
+    SeparationTelemetry telemetry;
+    cplex.use(CutManager(env, cplex, solver, -1, 5, scheduler, telemetry, events));
+    filename = base;
+    SolutionWriter writer(instance, filename.append(".bench").c_str());
+    cplex.use(IncumbentSaver(env, solver, writer, events));
+    cplex.solve();
+    writer.flush();
+    events.close();
+
+    // Without an incumbent, the time to the first one is the time limit
+    double first = settings.timeLimit;
+    findFirstEvent(base + ".bench.events", IncumbentEvent, first);
+    report.add(label, "incumbent", first);
+    report.add(label, "bound", events.getElapsed(), cplex.getBestObjValue());
+  }
+  catch (IloException& e) {
+    std::cerr << "Bench: Concert exception caught: " << e << std::endl;
+    success = false;
+  }
+  catch (...) {
+    std::cerr << "Bench: Unknown exception caught" << std::endl;
+    success = false;
+  }
+
+  env.end();
+  return success;
+}
+
+
+int main(int argc, char **argv) {
+  SuiteSettings settings;
+  settings.repeats = 3;
+  settings.seed = 1;
+  settings.copies = 0;
+  settings.threads = 0;
+  settings.timeLimit = 30;
+  settings.scratch = ".";
+  Tolerances tolerances;
+  tolerances.relative = 0.2;
+  tolerances.absolute = 0.05;
+  tolerances.bound = 0.5;
+  std::string output("benchmark.json"), baseline;
+  std::vector<std::string> instances;
+
+  for (int a = 1; a < argc; a++) {
+    std::string arg(argv[a]);
+    if (arg == "-n" && a + 1 < argc) { settings.repeats = std::max(1, std::atoi(argv[++a])); continue; }
+    if (arg == "-s" && a + 1 < argc) { settings.seed = std::atoi(argv[++a]); continue; }
+    if (arg == "-T" && a + 1 < argc) { settings.timeLimit = std::atof(argv[++a]); continue; }
+    if (arg == "-k" && a + 1 < argc) { settings.copies = std::atoi(argv[++a]); continue; }
+    if (arg == "-t" && a + 1 < argc) { settings.threads = std::atoi(argv[++a]); continue; }
+    if (arg == "-o" && a + 1 < argc) { output = argv[++a]; continue; }
+    if (arg == "-d" && a + 1 < argc) { settings.scratch = argv[++a]; continue; }
+    if (arg == "-c" && a + 1 < argc) { baseline = argv[++a]; continue; }
+    if (arg == "-x" && a + 1 < argc) { tolerances.relative = std::atof(argv[++a]); continue; }
+    if (arg == "-a" && a + 1 < argc) { tolerances.absolute = std::atof(argv[++a]); continue; }
+    if (arg == "-v" && a + 1 < argc) { tolerances.bound = std::atof(argv[++a]); continue; }
+    if (endsWith(arg, ".ctt") || !listInstances(arg, instances)) instances.push_back(arg);
+  }
+
+  if (instances.empty()) {
+    std::cerr << "Usage: " << argv[0] << " [-n <repeats>] [-s <seed>] [-T <seconds>] [-k <copies>] [-t <threads>]" << std::endl;
+    std::cerr << "       [-d <scratch>] [-o <report>] [-c <baseline>] [-x <relative>] [-a <absolute>] [-v <bound>] <data> [<data> ...]" << std::endl;
+    std::cerr << "where: <data> is an instance or a directory of them, each run <repeats> (3) times from <seed> (1)," << std::endl;
+    std::cerr << "       with the branch-and-cut stopped after <seconds> (30), on <threads> (all) threads," << std::endl;
+    std::cerr << "       -k also runs <copies> disjoint copies of each instance, written to <scratch>/<name>.x<copies>," << std::endl;
+    std::cerr << "       -d puts the copies and the files of the runs in <scratch> (.)," << std::endl;
+    std::cerr << "       -o writes the timings to <report> (benchmark.json), and -c compares them to <baseline>," << std::endl;
+    std::cerr << "          allowing for <relative> (0.2) of the time plus <absolute> (0.05) seconds," << std::endl;
+    std::cerr << "          and a bound lower by <bound> (0.5)" << std::endl;
+    exit(-1);
+  }
+
+  BenchmarkReport report;
+  report.repeats = settings.repeats;
+  report.seed = settings.seed;
+  report.timeLimit = settings.timeLimit;
+  int failures = 0;
+
+  for (size_t i = 0; i < instances.size(); i++) {
+    std::vector< std::pair<std::string, std::string> > runs;
+    runs.push_back(std::make_pair(instances[i], getLabel(instances[i])));
+    if (settings.copies > 1) {
+      TimetablingInstance instance;
+      std::string error;
+      std::ostringstream scaled, label;
+      scaled << getScratchPath(settings, instances[i]) << ".x" << settings.copies;
+      label << getLabel(instances[i]) << "x" << settings.copies;
+      if (instance.parse(instances[i].c_str(), error) && instance.write(scaled.str().c_str(), settings.copies))
+        runs.push_back(std::make_pair(scaled.str(), label.str()));
+      else std::cerr << "Bench: Cannot scale up " << instances[i] << std::endl;
+    }
+    for (size_t r = 0; r < runs.size(); r++)
+      for (int rep = 0; rep < settings.repeats; rep++) {
+        std::cout << "Bench: " << runs[r].second << ", run " << rep + 1 << " of " << settings.repeats << std::endl;
+        if (!runPhases(runs[r].first, runs[r].second, settings, report)) failures += 1;
+      }
+  }
+
+  if (!report.writeJson(output)) std::cerr << "Bench: Cannot write " << output << std::endl;
+  if (baseline.empty()) return failures > 0 ? 1 : 0;
+
+  BenchmarkReport previous;
+  if (!previous.readJson(baseline)) {
+    std::cerr << "Bench: No baseline in " << baseline << "; the report in " << output << " can become one" << std::endl;
+    return failures > 0 ? 1 : 0;
+  }
+  if (previous.version != report.version)
+    std::cout << "Bench: The baseline comes from CPLEX " << previous.version << ", not " << report.version << std::endl;
+  if (previous.timeLimit != report.timeLimit)
+    std::cout << "Bench: The baseline stops at " << previous.timeLimit << " s, not " << report.timeLimit << " s" << std::endl;
+  int regressions = report.compare(previous, tolerances, std::cout);
+  std::cout << "Bench: " << regressions << " regression(s) against " << baseline << std::endl;
+  return failures > 0 || regressions > 0 ? 1 : 0;
+}
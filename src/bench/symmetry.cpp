@@ -0,0 +1,182 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ilcplex/ilocplex.h>
+
+#include "loader.h"
+#include "timetable.h"
+#include "evaluator.h"
+#include "symmetry.h"
+#include "solver.h"
+#include "cut_manager.h"
+#include "saver.h"
+
+ILOSTLBEGIN
+
+// Finds the interchangeable rooms and identical courses of each instance given, e.g.
+// examples/comp*.ctt, and checks that <instance>.sol, if any, keeps its cost when mapped
+// to the representative the symmetry-breaking rows allow. With a time limit, it also solves
+// each instance without and with the rows, deterministically, and compares the nodes.
+
+struct SymmetryRun {
+  double bound, incumbent, seconds;
+  int nodes;
+  bool optimal;
+};
+
+
+bool solve(const std::string &data, bool symmetry, double timeLimit, int threads, SymmetryRun &run) {
+  bool success = true;
+  IloEnv env;
+  std::string filename(data);
+  filename.append(symmetry ? ".sym1" : ".sym0");
+  ofstream out((filename + ".out").c_str(), std::ofstream::out);
+  env.setOut(out);
+  env.setWarning(out);
+
+  try {
+    TimetablingInstance instance;
+    std::string error;
+    if (!instance.parse(data.c_str(), error)) {
+      std::cerr << "Symmetry: There was an error reading the instance " << data << ": " << error << std::endl;
+      env.end();
+      return false;
+    }
+    IloModel model(env);
+    TimetablingSolver solver(model, instance);
+    if (symmetry) {
+      SymmetryOrbits orbits;
+      findOrbits(instance, orbits);
+      solver.breakSymmetry(orbits);
+    }
+
+    IloCplex cplex(model);
+    if (threads > 0) cplex.setParam(IloCplex::Threads, threads);
+    cplex.setParam(IloCplex::ParallelMode, 1);
+    cplex.setParam(IloCplex::TiLim, timeLimit);
+    cplex.setParam(IloCplex::MIPEmphasis, 3);
+    cplex.setParam(IloCplex::RootAlg, 6);
+    cplex.setParam(IloCplex::HeurFreq, -1);
+    cplex.setParam(IloCplex::RINSHeur, -1);
+    cplex.setParam(IloCplex::FPHeur, -1);
+
+    EventLog events(filename + ".events");
+    SeparationPolicy policy;
+    SeparationScheduler scheduler(policy);
+    SeparationTelemetry telemetry;
+    cplex.use(CutManager(env, cplex, solver, -1, 5, scheduler, telemetry, events));
+    SolutionWriter writer(instance, filename.c_str());
+    cplex.use(IncumbentSaver(env, solver, writer, events));
+    IloNum start = env.getTime();
+    cplex.solve();
+    writer.flush();
+    events.close();
+
+    run.seconds = env.getTime() - start;
+    run.nodes = cplex.getNnodes();
+    run.bound = cplex.getBestObjValue();
+    run.incumbent = (cplex.getSolnPoolNsolns() >= 1) ? cplex.getObjValue() : -1;
+    run.optimal = cplex.getStatus() == IloAlgorithm::Optimal;
+  }
+  catch (IloException& e) {
+    std::cerr << "Symmetry: Concert exception caught: " << e << std::endl;
+    success = false;
+  }
+  catch (...) {
+    std::cerr << "Symmetry: Unknown exception caught" << std::endl;
+    success = false;
+  }
+
+  env.end();
+  return success;
+}
+
+
+int main(int argc, char **argv) {
+  double timeLimit = 0;
+  int threads = 0;
+  std::vector<std::string> instances;
+  for (int a = 1; a < argc; a++) {
+    std::string arg(argv[a]);
+    if (arg == "-T" && a + 1 < argc) { timeLimit = std::atof(argv[++a]); continue; }
+    if (arg == "-t" && a + 1 < argc) { threads = std::atoi(argv[++a]); continue; }
+    instances.push_back(arg);
+  }
+  if (instances.empty()) {
+    std::cerr << "Usage: " << argv[0] << " [-T <seconds>] [-t <threads>] <data> [<data> ...]" << std::endl;
+    std::cerr << "where: <data>.sol, if present, is a timetable for the instance <data>," << std::endl;
+    std::cerr << "       and -T solves each instance without and with the symmetry broken for up to <seconds>" << std::endl;
+    exit(-1);
+  }
+
+  int failures = 0;
+  for (size_t i = 0; i < instances.size(); i++) {
+    const std::string &data = instances[i];
+    TimetablingInstance instance;
+    std::string error;
+    if (!instance.parse(data.c_str(), error)) {
+      std::cerr << "Symmetry: There was an error reading the instance " << data << ": " << error << std::endl;
+      failures += 1;
+      continue;
+    }
+
+    SymmetryOrbits orbits;
+    findOrbits(instance, orbits);
+    int rooms = 0, courses = 0;
+    for (size_t o = 0; o < orbits.rooms.size(); o++) rooms += orbits.rooms[o].size();
+    for (size_t o = 0; o < orbits.courses.size(); o++) courses += orbits.courses[o].size();
+    std::cout << "Symmetry: " << data << ": " << rooms << " of " << instance.getRoomCount() << " rooms in "
+      << orbits.rooms.size() << " class(es), " << courses << " of " << instance.getCourseCount()
+      << " courses in " << orbits.courses.size() << " class(es)";
+
+    // Any timetable has a representative of the same cost, which the rows allow
+    Lectures lectures;
+    if (loadSolution(instance, (data + ".sol").c_str(), lectures) && !lectures.empty()) {
+      TimetableEvaluator evaluator(instance);
+      Penalties before = evaluator.evaluate(lectures);
+      canonicalise(instance, orbits, lectures);
+      Penalties after = evaluator.evaluate(lectures);
+      bool canonical = isCanonical(instance, orbits, lectures);
+      std::cout << ", timetable of " << before.getSoft() << " (" << before.getHard() << " hard) mapped to "
+        << after.getSoft() << " (" << after.getHard() << " hard)";
+      if (before.getSoft() != after.getSoft() || before.getHard() != after.getHard() || !canonical) {
+        std::cout << std::endl << "Symmetry: INVALID representative" << (canonical ? "" : ", violating the rows");
+        failures += 1;
+      }
+    }
+    std::cout << std::endl;
+
+    if (timeLimit <= 0) continue;
+    SymmetryRun without, with;
+    if (!solve(data, false, timeLimit, threads, without) || !solve(data, true, timeLimit, threads, with)) {
+      failures += 1;
+      continue;
+    }
+    std::cout << "Symmetry: " << data << ": without " << without.nodes << " nodes, bound " << without.bound
+      << ", incumbent " << without.incumbent << " in " << without.seconds << " s" << (without.optimal ? ", optimal" : "")
+      << "; with " << with.nodes << " nodes, bound " << with.bound
+      << ", incumbent " << with.incumbent << " in " << with.seconds << " s" << (with.optimal ? ", optimal" : "") << std::endl;
+    // Both optimal, they cannot differ
+    if (without.optimal && with.optimal && std::abs(without.incumbent - with.incumbent) > 0.5) {
+      std::cout << "Symmetry: INVALID optimum with the rows" << std::endl;
+      failures += 1;
+    }
+  }
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include "benchmark.h"
+#include "events.h"
+
+
+void PhaseTiming::summarise() {
+  median = minimum = maximum = value = 0;
+  if (!samples.empty()) {
+    std::vector<double> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+    median = sorted[sorted.size() / 2];
+    minimum = sorted.front();
+    maximum = sorted.back();
+  }
+  if (!values.empty()) {
+    std::vector<double> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+    value = sorted[sorted.size() / 2];
+  }
+}
+
+
+BenchmarkReport::BenchmarkReport() : repeats(0), seed(0), timeLimit(0) {}
+
+
+PhaseTiming &BenchmarkReport::getPhase(const std::string &instance, const std::string &phase) {
+  for (size_t i = 0; i < phases.size(); i++)
+    if (phases[i].instance == instance && phases[i].phase == phase) return phases[i];
+  PhaseTiming timing;
+  timing.instance = instance;
+  timing.phase = phase;
+  phases.push_back(timing);
+  return phases.back();
+}
+
+
+const PhaseTiming *BenchmarkReport::findPhase(const std::string &instance, const std::string &phase) const {
+  for (size_t i = 0; i < phases.size(); i++)
+    if (phases[i].instance == instance && phases[i].phase == phase) return &phases[i];
+  return 0;
+}
+
+
+void BenchmarkReport::add(const std::string &instance, const std::string &phase, double seconds) {
+  PhaseTiming &timing = getPhase(instance, phase);
+  timing.samples.push_back(seconds);
+  timing.summarise();
+}
+
+
+void BenchmarkReport::add(const std::string &instance, const std::string &phase, double seconds, double value) {
+  PhaseTiming &timing = getPhase(instance, phase);
+  timing.samples.push_back(seconds);
+  timing.values.push_back(value);
+  timing.summarise();
+}
+
+
+bool BenchmarkReport::writeJson(const std::string &path) {
+  std::ofstream file(path.c_str(), std::ofstream::out);
+  if (!file) return false;
+  file << "{\"version\": \"" << version << "\", \"repeats\": " << repeats << ", \"seed\": " << seed
+    << ", \"timeLimit\": " << timeLimit << ", \"phases\": [" << std::endl;
+  for (size_t i = 0; i < phases.size(); i++) {
+    const PhaseTiming &t = phases[i];
+    file << "{\"instance\": \"" << t.instance << "\", \"phase\": \"" << t.phase << "\", \"median\": " << t.median
+      << ", \"min\": " << t.minimum << ", \"max\": " << t.maximum;
+    if (!t.values.empty()) file << ", \"value\": " << t.value;
+    file << ", \"samples\": [";
+    for (size_t s = 0; s < t.samples.size(); s++) file << (s ? ", " : "") << t.samples[s];
+    file << "]}" << (i + 1 < phases.size() ? "," : "") << std::endl;
+  }
+  file << "]}" << std::endl;
+  return !file.fail();
+}
+
+
+// The string following "key": in a line, if any
+static bool findString(const std::string &line, const char *key, std::string &value) {
+  size_t at = line.find(key);
+  if (at == std::string::npos) return false;
+  size_t begin = line.find('"', line.find(':', at + std::strlen(key)));
+  if (begin == std::string::npos) return false;
+  size_t end = line.find('"', begin + 1);
+  if (end == std::string::npos) return false;
+  value = line.substr(begin + 1, end - begin - 1);
+  return true;
+}
+
+
+bool BenchmarkReport::readJson(const std::string &path) {
+  std::ifstream file(path.c_str());
+  if (!file) return false;
+  phases.clear();
+  std::string line;
+  while (std::getline(file, line)) {
+    double number;
+    if (findString(line, "\"version\"", version)) {
+      if (findNumber(line, "\"repeats\"", number)) repeats = int(number);
+      if (findNumber(line, "\"seed\"", number)) seed = int(number);
+      if (findNumber(line, "\"timeLimit\"", number)) timeLimit = number;
+      continue;
+    }
+    PhaseTiming t;
+    if (!findString(line, "\"instance\"", t.instance) || !findString(line, "\"phase\"", t.phase)
+      || !findNumber(line, "\"median\"", t.median) || !findNumber(line, "\"min\"", t.minimum)
+      || !findNumber(line, "\"max\"", t.maximum)) continue;
+    t.value = 0;
+    if (findNumber(line, "\"value\"", t.value)) t.values.push_back(t.value);
+    t.samples.push_back(t.median);
+    phases.push_back(t);
+  }
+  return true;
+}
+
+
+int BenchmarkReport::compare(const BenchmarkReport &baseline, const Tolerances &tolerances, std::ostream &out) {
+  int regressions = 0;
+  for (size_t i = 0; i < phases.size(); i++) {
+    const PhaseTiming &t = phases[i];
+    const PhaseTiming *b = baseline.findPhase(t.instance, t.phase);
+    out << "Bench: " << t.instance << "\t" << t.phase << "\t" << t.median << " s";
+    if (!t.values.empty()) out << "\tvalue " << t.value;
+    if (!b) {
+      out << "\tnot in the baseline" << std::endl;
+      continue;
+    }
+    out << "\tagainst " << b->median << " s";
+    if (!b->values.empty()) out << "\tvalue " << b->value;
+
+    bool slower = t.median > b->median * (1 + tolerances.relative) + tolerances.absolute;
+    bool faster = t.median < b->median * (1 - tolerances.relative) - tolerances.absolute;
+    bool worse = !t.values.empty() && !b->values.empty() && t.value < b->value - tolerances.bound;
+    bool better = !t.values.empty() && !b->values.empty() && t.value > b->value + tolerances.bound;
+    if (slower || worse) {
+      out << "\tREGRESSION";
+      regressions += 1;
+    } else if (faster || better) out << "\timproved";
+    out << std::endl;
+  }
+  return regressions;
+}
@@ -0,0 +1,67 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_BENCHMARK
+#define UDINE_BENCHMARK
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* The timings of one phase of the solver on one instance, over repeated runs,
+* e.g. "load", "patterns", "graph", "cliques", "model", "rootlp", "incumbent", "bound".
+* Some phases also have a value, the objective of the root LP or the bound at the time
+* limit, which is compared as well, with higher being better.
+*/
+struct PhaseTiming {
+  std::string instance, phase;
+  std::vector<double> samples;  // in seconds
+  std::vector<double> values;
+  double median, minimum, maximum, value;
+
+  // Fills in median, minimum, maximum and value, the median of the values, from the samples
+  void summarise();
+};
+
+// Where the timings may be worse than those of the baseline, before they count as a regression
+struct Tolerances {
+  double relative;      // of the time of the baseline, e.g. 0.2
+  double absolute;      // in seconds, on top, so that the short phases do not flap
+  double bound;         // the least decrease of the bound which counts
+};
+
+/* The timings of a run of the benchmark suite, written as JSON, with a phase
+* per line, so that a baseline can be read back without a JSON library.
+*/
+class BenchmarkReport {
+protected:
+  std::vector<PhaseTiming> phases;
+
+public:
+  std::string version;
+  int repeats, seed;
+  double timeLimit;
+
+  BenchmarkReport();
+
+  PhaseTiming &getPhase(const std::string &instance, const std::string &phase);
+  const PhaseTiming *findPhase(const std::string &instance, const std::string &phase) const;
+  void add(const std::string &instance, const std::string &phase, double seconds);
+  void add(const std::string &instance, const std::string &phase, double seconds, double value);
+
+  bool writeJson(const std::string &path);
+  bool readJson(const std::string &path);
+
+  // Reports each phase against the baseline, returning the number of regressions
+  int compare(const BenchmarkReport &baseline, const Tolerances &tolerances, std::ostream &out);
+};
+
+#endif // UDINE_BENCHMARK
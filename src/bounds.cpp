@@ -0,0 +1,94 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "bounds.h"
+
+
+// Room capacity: the sorted matching of lectures to room-periods
+int getCapacityBound(TimetablingInstance &i) {
+  int c, r, l;
+  std::vector<int> students, capacities;
+  for (c = 0; c < i.getCourseCount(); c++)
+    for (l = 0; l < i.getCourse(c).lectures; l++)
+      students.push_back(i.getCourse(c).students);
+  for (r = 0; r < i.getRoomCount(); r++)
+    capacities.insert(capacities.end(), i.getPeriodCount(), i.getRoom(r).capacity);
+  std::sort(students.begin(), students.end(), std::greater<int>());
+  std::sort(capacities.begin(), capacities.end(), std::greater<int>());
+
+  int bound = 0;
+  for (l = 0; l < students.size() && l < capacities.size(); l++)
+    bound += std::max(0, students[l] - capacities[l]);
+  return bound;
+}
+
+
+// Min working days: the days available to a course and its lectures
+int getMinWorkingDaysBound(TimetablingInstance &i, const std::vector<char> &available) {
+  int c, d, pd, bound = 0;
+  int ppd = i.getPeriodsPerDayCount();
+  for (c = 0; c < i.getCourseCount(); c++) {
+    int days = 0;
+    for (d = 0; d < i.getDayCount(); d++)
+      for (pd = 0; pd < ppd; pd++)
+        if (available[c * i.getPeriodCount() + d * ppd + pd]) { days += 1; break; }
+    int most = std::min(days, i.getCourse(c).lectures);
+    if (most < i.getCourse(c).minWorkingDays)
+      bound += 5 * (i.getCourse(c).minWorkingDays - most);
+  }
+  return bound;
+}
+
+
+// Isolated lectures: courses, none of whose periods has a possible neighbour within the curriculum
+int getIsolatedLecturesBound(TimetablingInstance &i, const std::vector<char> &available, const Curriculum &u) {
+  int P = i.getPeriodCount(), ppd = i.getPeriodsPerDayCount();
+  int bound = 0;
+  for (int k = 0; k < u.courseIds.size(); k++) {
+    int c = u.courseIds[k];
+    bool paired = false;
+    for (int p = 0; p < P && !paired; p++) {
+      if (!available[c * P + p]) continue;
+      for (int q = p - 1; q <= p + 1 && !paired; q += 2) {
+        if (q < 0 || q >= P || q / ppd != p / ppd) continue;
+        for (int j = 0; j < u.courseIds.size() && !paired; j++) {
+          int other = u.courseIds[j];
+          if (other == c && i.getCourse(c).lectures < 2) continue;
+          if (available[other * P + q] && i.getCourse(other).lectures > 0) paired = true;
+        }
+      }
+    }
+    if (!paired) bound += 2 * i.getCourse(c).lectures;
+  }
+  return bound;
+}
+
+
+Penalties getLowerBounds(TimetablingInstance &i, bool singletonCurricula) {
+  int f, u, P = i.getPeriodCount();
+  std::vector<char> available(i.getCourseCount() * P, 1);
+  for (f = 0; f < i.getRestrictionCount(); f++)
+    available[i.getRestriction(f).courseId * P + i.getRestriction(f).period] = 0;
+
+  Penalties bounds;
+  bounds.roomCapacity = getCapacityBound(i);
+  bounds.minWorkingDays = getMinWorkingDaysBound(i, available);
+  for (u = 0; u < i.getProperCurriculumCount(); u++)
+    bounds.isolatedLectures += getIsolatedLecturesBound(i, available, i.getCurriculum(u));
+  if (singletonCurricula)
+    for (u = 0; u < i.getSingletonCurriculumCount(); u++)
+      bounds.isolatedLectures += getIsolatedLecturesBound(i, available, i.getSingletonCurriculum(u));
+  return bounds;
+}
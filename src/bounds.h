@@ -0,0 +1,33 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_BOUNDS
+#define UDINE_BOUNDS
+
+#include "loader.h"
+#include "evaluator.h"
+
+/* Lower bounds on each soft constraint of any feasible timetable, which
+* are read off the instance, without building any LP:
+* - room capacity: the lectures sorted by their numbers of students are
+*   matched to the rooms sorted by capacity, with a copy of each room per period;
+*   as the penalty is a convex function of the difference, this sorted matching
+*   is the cheapest assignment of lectures to rooms;
+* - min working days: a course cannot be taught on more days than it has
+*   lectures, nor on days when its teacher is not available at all;
+* - isolated lectures: a lecture is isolated, whenever none of the periods
+*   available to its course has a neighbour on the same day, where another
+*   lecture of the curriculum could take place.
+* The hard constraints of the result are zero.
+*/
+Penalties getLowerBounds(TimetablingInstance &instance, bool singletonCurricula = true);
+
+#endif // UDINE_BOUNDS
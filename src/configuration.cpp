@@ -0,0 +1,234 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "configuration.h"
+
+static const char *projectKnobs[] = {
+  "cutLevel", "tailOff", "tailOffRounds", "threads",
+  "policy", "frequency", "skipFactor", "maxBackoff",
+  "coursePeriods", "lagrangian", "firstOrderLP", "symmetry", "conflicts", "presolve", "autoselect", "seed", 0
+};
+
+
+static std::string trim(const std::string &s) {
+  size_t first = s.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos) return "";
+  return s.substr(first, s.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+
+SolverConfiguration::SolverConfiguration() {
+  // 3 CPX_MIPEMPHASIS_BESTBOUND  Emphasize moving best bound
+  set("CPX_PARAM_MIPEMPHASIS", "3");
+  // 6 CPX_ALG_CONCURRENT  Concurrent (Dual, Barrier, and Primal), i.e. RootAlg
+  set("CPX_PARAM_STARTALG", "6");
+  // When NodeLim is set to 1, nodes are created but not solved.
+  set("CPX_PARAM_NODELIM", "0");
+  set("CPX_PARAM_TILIM", "7200");
+  set("CPX_PARAM_REPEATPRESOLVE", "3");
+  set("CPX_PARAM_SYMMETRY", "3");
+  set("CPX_PARAM_MIPINTERVAL", "1");
+  set("CPX_PARAM_WRITELEVEL", "1");
+  set("CPX_PARAM_MIPDISPLAY", "4");
+  set("CPX_PARAM_PREDUAL", "1");
+  // The in-built heuristics need to be disabled, as they are unaware of Type 1 cuts!
+  set("CPX_PARAM_HEURFREQ", "-1");
+  set("CPX_PARAM_RINSHEUR", "-1");
+  set("CPX_PARAM_FPHEUR", "-1");
+}
+
+
+bool SolverConfiguration::isKnown(const std::string &name) {
+  if (name.compare(0, 10, "CPX_PARAM_") == 0) return name.size() > 10;
+  for (int k = 0; projectKnobs[k]; k++)
+    if (name == projectKnobs[k]) return true;
+  // The patterns are separated whenever the cut manager runs, see SeparationScheduler::shouldSeparate
+  for (int f = 0; f < CutFamilyCount; f++)
+    if ((f != PatternCuts && (name == std::string("separate.") + getCutFamilyName(f) || name == std::string("depth.") + getCutFamilyName(f)))
+      || name == std::string("cuts.") + getCutFamilyName(f))
+      return true;
+  return false;
+}
+
+
+bool SolverConfiguration::read(const std::string &path, std::string &error) {
+  std::ifstream file(path.c_str());
+  if (!file) {
+    error = "cannot read " + path;
+    return false;
+  }
+  std::string line;
+  int number = 0;
+  while (std::getline(file, line)) {
+    number += 1;
+    line = trim(line.substr(0, line.find('#')));
+    if (line.empty()) continue;
+    if (!assign(line, error)) {
+      std::ostringstream where;
+      where << path << ", line " << number << ": " << error;
+      error = where.str();
+      return false;
+    }
+  }
+  return true;
+}
+
+
+bool SolverConfiguration::assign(const std::string &assignment, std::string &error) {
+  size_t at = assignment.find('=');
+  std::string name = trim(assignment.substr(0, at));
+  std::string value = (at == std::string::npos) ? "" : trim(assignment.substr(at + 1));
+  if (!isKnown(name)) {
+    error = "unknown setting " + name;
+    return false;
+  }
+  if (value.empty()) {
+    error = "no value for " + name;
+    return false;
+  }
+  set(name, value);
+  return true;
+}
+
+
+void SolverConfiguration::set(const std::string &name, const std::string &value) {
+  for (size_t i = 0; i < entries.size(); i++)
+    if (entries[i].first == name) {
+      entries[i].second = value;
+      return;
+    }
+  entries.push_back(std::make_pair(name, value));
+}
+
+
+void SolverConfiguration::remove(const std::string &name) {
+  for (size_t i = 0; i < entries.size(); i++)
+    if (entries[i].first == name) {
+      entries.erase(entries.begin() + i);
+      return;
+    }
+}
+
+
+bool SolverConfiguration::has(const std::string &name) const {
+  for (size_t i = 0; i < entries.size(); i++)
+    if (entries[i].first == name) return true;
+  return false;
+}
+
+
+std::string SolverConfiguration::get(const std::string &name, const std::string &otherwise) const {
+  for (size_t i = 0; i < entries.size(); i++)
+    if (entries[i].first == name) return entries[i].second;
+  return otherwise;
+}
+
+
+bool SolverConfiguration::getInt(const std::string &name, int &value, std::string &error) const {
+  if (!has(name)) return true;
+  std::string given = get(name);
+  char *end;
+  long number = std::strtol(given.c_str(), &end, 10);
+  if (end == given.c_str() || *end != 0) {
+    error = "not an integer " + name + " = " + given;
+    return false;
+  }
+  value = int(number);
+  return true;
+}
+
+
+bool SolverConfiguration::getDouble(const std::string &name, double &value, std::string &error) const {
+  if (!has(name)) return true;
+  std::string given = get(name);
+  char *end;
+  double number = std::strtod(given.c_str(), &end);
+  if (end == given.c_str() || *end != 0) {
+    error = "not a number " + name + " = " + given;
+    return false;
+  }
+  value = number;
+  return true;
+}
+
+
+bool SolverConfiguration::getBool(const std::string &name, bool &value, std::string &error) const {
+  if (!has(name)) return true;
+  std::string given = get(name);
+  if (given == "on" || given == "yes" || given == "true" || given == "1") value = true;
+  else if (given == "off" || given == "no" || given == "false" || given == "0") value = false;
+  else {
+    error = "not on or off " + name + " = " + given;
+    return false;
+  }
+  return true;
+}
+
+
+bool SolverConfiguration::writeParamFile(const std::string &path, const std::string &version) const {
+  std::ofstream file(path.c_str(), std::ofstream::out);
+  if (!file) return false;
+  file << "CPLEX Parameter File Version " << version << std::endl;
+  for (size_t i = 0; i < entries.size(); i++)
+    if (entries[i].first.compare(0, 10, "CPX_PARAM_") == 0)
+      file << entries[i].first << " " << entries[i].second << std::endl;
+  return !file.fail();
+}
+
+
+bool SolverConfiguration::write(const std::string &path) const {
+  std::ofstream file(path.c_str(), std::ofstream::out);
+  if (!file) return false;
+  for (size_t i = 0; i < entries.size(); i++)
+    file << entries[i].first << " = " << entries[i].second << std::endl;
+  return !file.fail();
+}
+
+
+void SolverConfiguration::describe(std::ostream &out) const {
+  for (size_t i = 0; i < entries.size(); i++)
+    out << (i ? " " : "") << entries[i].first << "=" << entries[i].second;
+}
+
+
+bool SolverConfiguration::configure(SeparationPolicy &policy, std::string &error) const {
+  if (has("policy") && !policy.set(get("policy"))) {
+    error = "unknown separation policy " + get("policy");
+    return false;
+  }
+  if (!getInt("frequency", policy.frequency, error) || !getDouble("skipFactor", policy.skipFactor, error)
+    || !getInt("maxBackoff", policy.maxBackoff, error))
+    return false;
+  for (int f = 0; f < CutFamilyCount; f++) {
+    std::string family(getCutFamilyName(f));
+    if (!getBool("separate." + family, policy.enabled[f], error) || !getInt("depth." + family, policy.maxDepth[f], error))
+      return false;
+  }
+  return true;
+}
+
+
+bool SolverConfiguration::configure(CutRegistry &registry, std::string &error) const {
+  for (int f = 0; f < CutFamilyCount; f++) {
+    std::string name = std::string("cuts.") + getCutFamilyName(f);
+    if (!has(name)) continue;
+    int mode;
+    if (!getCutModeByName(get(name), mode) || !registry.set(f, mode)) {
+      error = "the " + std::string(getCutFamilyName(f)) + " cannot be " + get(name);
+      return false;
+    }
+  }
+  return true;
+}
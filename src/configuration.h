@@ -0,0 +1,80 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_CONFIGURATION
+#define UDINE_CONFIGURATION
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "scheduler.h"
+#include "cut_registry.h"
+
+/* The settings of a run, as read from a file of lines such as
+*   # Emphasise the bound, with the clique pool and the triangles
+*   CPX_PARAM_MIPEMPHASIS = 3
+*   cutLevel = 6
+*   separate.triangles = off
+* Any parameter of CPLEX can be given by its name in the parameter files of CPLEX,
+* which the solver passes on to readParam. The rest are the knobs of the project:
+*   cutLevel, tailOff, tailOffRounds, threads          as on the command line
+*   policy, frequency, skipFactor, maxBackoff          of the separation policy
+*   separate.<family> = on|off, depth.<family> = <n>   for the families of cuts other than the patterns
+*   cuts.<family> = static|lazy|user|dynamic|off       where the cuts of a family go
+*   coursePeriods, lagrangian, firstOrderLP = on|off   of the formulation and the bounds
+*   symmetry = on|off                                  orders interchangeable rooms and courses
+*   conflicts = curricula|dominance|cover              what the conflict rows are generated for
+*   presolve = on|off                                  propagates on the instance before CPLEX
+*   autoselect = <seconds>                             of the root probe of each formulation
+*   seed = <n>                                         RandomSeed of CPLEX, and of the members of a portfolio
+* The last value given for a name counts.
+*/
+class SolverConfiguration {
+protected:
+  std::vector< std::pair<std::string, std::string> > entries;
+
+  static bool isKnown(const std::string &name);
+
+public:
+  // The parameters test.cpp used to set, which are the defaults
+  SolverConfiguration();
+
+  // False with the line in error, if there is an unknown name or no value
+  bool read(const std::string &path, std::string &error);
+  // Of the form name=value, as on the command line
+  bool assign(const std::string &assignment, std::string &error);
+  void set(const std::string &name, const std::string &value);
+  void remove(const std::string &name);
+
+  bool has(const std::string &name) const;
+  std::string get(const std::string &name, const std::string &otherwise = "") const;
+  // Leave the value as it is if the name is not given, and return false with the error if what is given
+  // is not a number, or not on|off, yes|no, true|false or 1|0, e.g. presolve = of
+  bool getInt(const std::string &name, int &value, std::string &error) const;
+  bool getDouble(const std::string &name, double &value, std::string &error) const;
+  bool getBool(const std::string &name, bool &value, std::string &error) const;
+  const std::vector< std::pair<std::string, std::string> > &getEntries() const { return entries; }
+
+  // The CPLEX parameters in the format of readParam; CPLEX resets any not given to its defaults
+  bool writeParamFile(const std::string &path, const std::string &version) const;
+  bool write(const std::string &path) const;
+  // As name=value, separated by spaces
+  void describe(std::ostream &out) const;
+
+  // Applies the policy, the toggles and the depths of the families, false with the first in error
+  bool configure(SeparationPolicy &policy, std::string &error) const;
+  // Applies the modes of the families, false with the first not allowed
+  bool configure(CutRegistry &registry, std::string &error) const;
+};
+
+#endif // UDINE_CONFIGURATION
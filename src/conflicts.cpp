@@ -10,11 +10,14 @@
 */
 
 #include <cstdio>
+#include <cstdlib>
 #include <cassert>
 #include <vector>
 #include <set>
 #include <algorithm>
 
+#include <boost/thread/mutex.hpp>
+
 #include "conflicts.h"
 
 #ifdef _WIN32
@@ -29,7 +32,8 @@ extern "C" {
 #include "reorder.h"
 #endif
 
-void* cliquerHelperWrapperHack;
+// Cliquer keeps the state of its search in static variables
+static boost::mutex cliquerLock;
 
 void Graph::generateConflictGraph(TimetablingInstance &instance) {
   vs.clear();
@@ -86,7 +90,7 @@ boolean Graph::generateAllCliquesHelper(set_t s, graph_t *g, clique_options *opt
 
 
 boolean Graph::generateAllCliquesHelperWrapper(set_t s, graph_t *g, clique_options *opts) {
-  return ((Graph*)cliquerHelperWrapperHack)->generateAllCliquesHelper(s, g, opts);
+  return ((Graph*)opts->user_data)->generateAllCliquesHelper(s, g, opts);
 };
 
 
@@ -97,16 +101,19 @@ void Graph::generateAllCliques() {
   // the cliquer interface
   clique_options *opts; 
   opts = (clique_options *)malloc(sizeof(clique_options)); 
-  cliquerHelperWrapperHack = (void*)this;
   opts->user_function = generateAllCliquesHelperWrapper;
   opts->time_function = NULL;
   opts->output = stderr;
   opts->reorder_function = NULL;
   opts->reorder_map = NULL;
-  opts->user_data = NULL;
+  opts->user_data = (void*)this;
   opts->clique_list = NULL;
   opts->clique_list_length = 0; 
-  int num = clique_unweighted_find_all(cliquerRepresentation, 0, 0, true, opts);
+  {
+    boost::mutex::scoped_lock l(cliquerLock);
+    clique_unweighted_find_all(cliquerRepresentation, 0, 0, true, opts);
+  }
+  free(opts);
 
   std::cout << "Graphs: Clique pool initialised with " << cliques.size() << " clique(s)" << std::endl;  
 } // END Graph::generateAllCliques
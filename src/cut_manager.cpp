@@ -11,31 +11,80 @@
 
 #include "cut_manager.h"
 
+#include <algorithm>
 #include <cmath>
-#include <fstream>
 #include <iostream>
+#include <boost/thread/thread_time.hpp>
 #include <ilcplex/ilocplex.h>
 
-IloCplex::Callback CutManager(IloEnv env, IloCplex &c, TimetablingSolver& s, int limit, int level) {
-  return (IloCplex::Callback(new (env) CutManagerI(env, c, s, limit, level)));
+IloCplex::Callback CutManager(IloEnv env, IloCplex &c, TimetablingSolver& s, int limit, int level,
+  SeparationScheduler &scheduler, SeparationTelemetry &telemetry, EventLog &events, double tailOff, int tailOffRounds,
+  SnapshotFile *snapshots) {
+  return (IloCplex::Callback(new (env) CutManagerI(env, c, s, limit, level, scheduler, telemetry, events,
+    tailOff, tailOffRounds, snapshots)));
 }
 
 void CutManagerI::main() {
 
-  // if (!active && totalCalls % 5 == 0) active = true; 
-  // if (active) {
-
-  RelaxationSummary vals = getRelaxationSummedOverRooms();
+  SeparationTelemetry::ThreadCounters &counters = telemetry.local();
+  SeparationTelemetry::CallbackRecord record;
+  record.thread = counters.thread;
+  record.call = totalCalls;
+  record.nodes = getNnodes();
+  record.depth = getCurrentNodeDepth();
+  record.start = telemetry.getElapsed();
+  record.found = record.added = 0;
+  record.bound = getBestObjValue();
+  record.objective = getObjValue();
+
+  Relaxation relaxation;
+  std::vector<float> xs;
+  getRelaxation(relaxation, xs);
+  relaxation.bound = record.bound;
+  relaxation.objective = record.objective;
+  int depth = record.depth;
+
+  std::vector<Cut> cuts;  // kept only if recording snapshots
+  int families = 0;
 
   bool thisTime = false;  // Did we get anything useful
-  if (cutLevel >= 1) thisTime |= genCutsFromPatterns(vals);
-  if (cutLevel >= 2) thisTime |= genCutsFromMindaysChecks(vals);
-  if (cutLevel >= 2) thisTime |= genCutsFromCurriculumChecks(vals);
-  // if (cutLevel > 3) thisTime |= genCutsFromCliquePool(vals);
-  // if (cutLevel > 3 && !thisTime) thisTime |= genCutsFromTriangles(vals);
-  if (cutLevel >= 3) thisTime |= genCutsFromObjIntegrality(vals);  
+  // The patterns and the links left out of the model are separated at any cut level, even 0
+  thisTime |= separate(PatternCuts, depth, relaxation, cuts, families, counters, record);
+  thisTime |= separate(LinkingCuts, depth, relaxation, cuts, families, counters, record);
+  if (active) {
+    if (cutLevel >= 2) thisTime |= separate(MindaysCuts, depth, relaxation, cuts, families, counters, record);
+    if (cutLevel >= 2) thisTime |= separate(CurriculumCuts, depth, relaxation, cuts, families, counters, record);
+    if (cutLevel >= 6) thisTime |= separate(CliquePoolCuts, depth, relaxation, cuts, families, counters, record);
+    if (cutLevel >= 6 && !thisTime) thisTime |= separate(TriangleCuts, depth, relaxation, cuts, families, counters, record);
+    if (cutLevel >= 3) thisTime |= separate(ObjIntegralityCuts, depth, relaxation, cuts, families, counters, record);
+  }
+  record.time = telemetry.getElapsed() - record.start;
+  counters.callbacks.push_back(record);
+
+  if (snapshots) {
+    Snapshot snapshot;
+    snapshot.thread = record.thread;
+    snapshot.call = totalCalls;
+    snapshot.nodes = record.nodes;
+    snapshot.depth = depth;
+    snapshot.families = families;
+    snapshot.bound = relaxation.bound;
+    snapshot.objective = relaxation.objective;
+    snapshot.xs.swap(xs);
+    snapshot.curriculumDays = relaxation.curriculumDays;
+    snapshot.minDayViolations = relaxation.minDayViolations;
+    snapshot.courseRooms = relaxation.courseRooms;
+    snapshot.courseDays = relaxation.courseDays;
+    for (size_t i = 0; i < cuts.size(); i++) {
+      CutKey key;
+      key.family = cuts[i].family;
+      for (int k = 0; k < 4; k++) key.key[k] = cuts[i].key[k];
+      snapshot.cuts.push_back(key);
+    }
+    snapshots->write(snapshot);
+  }
 
-  active = thisTime;
+  if (tailOff > 0 && active) checkTailOff();
   logProgress();
   totalCalls += 1;
 
@@ -45,289 +94,139 @@ void CutManagerI::main() {
     && (std::ceil(getBestObjValue()) >= cutUp) ) abort();
 }
 
-RelaxationSummary CutManagerI::getRelaxationSummedOverRooms() {
-
-  // Precompute sums of values in the current LP relaxation for all course-period combinations  
-  std::vector<float> fresh(solver.instance.getPeriodCount(), 0);
-  RelaxationSummary vals(new std::vector< std::vector<float> >(solver.instance.getCourseCount(), fresh));
+// Runs a family of separators, if the registry leaves it to the cut manager and the scheduler wants it,
+// adds the cuts found to the LP,
+// and tells the scheduler and the telemetry how it went
+bool CutManagerI::separate(int family, int depth, const Relaxation &relaxation, std::vector<Cut> &cuts, int &families,
+                           SeparationTelemetry::ThreadCounters &counters, SeparationTelemetry::CallbackRecord &record) {
+  if (!solver.registry.isSeparated(family)) return false;
+  if (!scheduler.shouldSeparate(family, depth, totalCalls)) return false;
+  families |= (1 << family);
+  size_t first = cuts.size();
+  boost::system_time start = boost::get_system_time();
+  separators.separate(family, relaxation, cuts);
+  int i, added = cuts.size() - first;
+  double violation = 0, maxViolation = 0;
+  for (i = first; i < cuts.size(); i++) {
+    addCut(cuts[i]);
+    violation += cuts[i].violation;
+    maxViolation = std::max(maxViolation, cuts[i].violation);
+  }
+  double milliseconds = (boost::get_system_time() - start).total_microseconds() / 1000.0;
+  totalCutsAdded += added;
+  if (added > 0 && family != ObjIntegralityCuts)
+    std::cout << "Mycuts: Added " << added << " cut(s) from " << getCutFamilyName(family) << " in round " << totalCalls << std::endl;
+
+  scheduler.record(family, milliseconds, added, violation);
+  if (added > 0) events.push(CutsEvent, record.nodes, added, family);
+
+  SeparationTelemetry::FamilyCounters &c = counters.families[family];
+  c.calls += 1;
+  c.time += milliseconds;
+  c.found += added;
+  c.added += added;
+  c.violation += violation;
+  c.maxViolation = std::max(c.maxViolation, maxViolation);
+  record.found += added;
+  record.added += added;
+  if (!snapshots) cuts.erase(cuts.begin() + first, cuts.end());
+  return added > 0;
+}
 
-  int c, p, r;  // course, period, room
-  for(c = 0; c < solver.instance.getCourseCount(); c++) {
-    for(p = 0; p < solver.instance.getPeriodCount(); p++) {
-      float value = 0;
-      for(r = 0; r < solver.instance.getRoomCount(); r++)
-        value += getValue(solver.vars.x[p][r][c]);
-      (*vals)[c][p] = value;
+// Reads all of x at once, and the penalties of the curricula and courses
+void CutManagerI::getRelaxation(Relaxation &relaxation, std::vector<float> &xs) {
+  IloNumArray values(getEnv());
+  getValues(values, solver.vars.xs);
+  xs.resize(values.getSize());
+  IloInt k;
+  for (k = 0; k < values.getSize(); k++) xs[k] = values[k];
+  relaxation.setX(solver.instance, xs);
+
+  int u, d, c;  // curriculum, day, course
+  int D = solver.instance.getDayCount();
+  // Only the proper curricula, as those of the teachers are in no row and thus not extracted
+  relaxation.curriculumDays.resize(solver.instance.getProperCurriculumCount() * D);
+  for (u = 0; u < solver.instance.getProperCurriculumCount(); u++)
+    for (d = 0; d < D; d++)
+      relaxation.curriculumDays[u * D + d] = getValue(solver.vars.singletonChecks[u][d][0]);
+  getValues(values, solver.vars.courseMinDayViolations);
+  relaxation.minDayViolations.resize(solver.instance.getCourseCount());
+  for (c = 0; c < solver.instance.getCourseCount(); c++) relaxation.minDayViolations[c] = values[c];
+
+  // The rooms and days of the courses only matter to the links left out of the formulation
+  if (solver.registry.isSeparated(LinkingCuts)) {
+    int r, C = solver.instance.getCourseCount(), R = solver.instance.getRoomCount();
+    relaxation.courseRooms.resize(R * C);
+    relaxation.courseDays.resize(D * C);
+    for (c = 0; c < C; c++) {
+      getValues(values, solver.vars.courseRooms[c]);
+      for (r = 0; r < R; r++) relaxation.courseRooms[r * C + c] = values[r];
+      getValues(values, solver.vars.courseDays[c]);
+      for (d = 0; d < D; d++) relaxation.courseDays[d * C + c] = values[d];
     }
   }
-  return vals;
+  values.end();
 }
 
-bool CutManagerI::genCutsFromObjIntegrality(RelaxationSummary vals) {
-
-  int cuts = 0;
-
-  // GLOBAL CUTS FROM THE WORST OBJECTIVE FROM ACTIVE NODES FIRST
-  float diff = getBestObjValue() - std::floor(getBestObjValue());
-  if (diff > 0.01 && diff < 0.99) {
-    add(cplex.getObjective().getExpr() >= std::ceil(getBestObjValue()));
-    cplex.setParam(IloCplex::CutLo, std::ceil(getBestObjValue()));
-    std::cout << "Mycuts: Based on local LB of " << getObjValue() << " and global LB of " << getBestObjValue() << 
-      ", added global cut from objective integrality: obj >= " << std::ceil(getBestObjValue()) << std::endl;
-    cuts += 1;
+// Turns a cut into an inequality over the variables of the model
+void CutManagerI::addCut(const Cut &cut) {
+  IloExpr expr(solver.env);
+  int t, r;  // term, room
+  for (t = 0; t < cut.courses.size(); t++)
+    if (cut.room >= 0) expr += cut.coefficients[t] * solver.vars.x[cut.periods[t]][cut.room][cut.courses[t]];
+    else for (r = 0; r < solver.instance.getRoomCount(); r++)
+      expr += cut.coefficients[t] * solver.vars.x[cut.periods[t]][r][cut.courses[t]];
+  int D = solver.instance.getDayCount(), C = solver.instance.getCourseCount();
+  switch (cut.slack) {
+    case CurriculumDaySlack:
+      expr += cut.slackCoefficient * solver.vars.singletonChecks[cut.slackIndex / D][cut.slackIndex % D][0];
+      break;
+    case MinDaySlack:
+      expr += cut.slackCoefficient * solver.vars.courseMinDayViolations[cut.slackIndex];
+      break;
+    case ObjectiveSlack:
+      expr += cut.slackCoefficient * cplex.getObjective().getExpr();
+      break;
+    case CourseRoomSlack:
+      expr += cut.slackCoefficient * solver.vars.courseRooms[cut.slackIndex % C][cut.slackIndex / C];
+      break;
+    case CourseDaySlack:
+      expr += cut.slackCoefficient * solver.vars.courseDays[cut.slackIndex % C][cut.slackIndex / C];
+      break;
   }
 
-  // LOCAL CUTS FROM THE OBJECTIVE AT THE CURRENT NODE 
-  diff = getObjValue() - std::floor(getObjValue());
-  if (diff > 0.01 && diff < 0.99 && std::abs(getObjValue()-getBestObjValue()) > 0.01) {
-    addLocal(cplex.getObjective().getExpr() >= std::ceil(getObjValue()));
+  IloConstraint constraint;
+  if (cut.sense == 'L') constraint = (expr <= cut.rhs);
+  else if (cut.sense == 'E') constraint = (expr == cut.rhs);
+  else constraint = (expr >= cut.rhs);
+  if (cut.local) addLocal(constraint);
+  else add(constraint);
+  expr.end();
+
+  if (cut.family == ObjIntegralityCuts) {
+    if (!cut.local) cplex.setParam(IloCplex::CutLo, cut.rhs);
     std::cout << "Mycuts: Based on local LB of " << getObjValue() << " and global LB of " << getBestObjValue() << 
-      ", added local cut from objective integrality: obj >= " << std::ceil(getObjValue()) << std::endl;
-    cuts += 1;
+      ", added " << (cut.local ? "local" : "global") << " cut from objective integrality: obj >= " << cut.rhs << std::endl;
   }
-
-  totalCutsAdded += cuts;
-  return (cuts > 0);
-}
-
-
-bool CutManagerI::genCutsFromCliquePool(RelaxationSummary vals) {
-
-  int cuts = 0;
-
-  int p, clique, ci, r;  // period, clique and index within, room
-  std::vector< std::vector<int> > &cs = solver.conflictGraph.cliques;
-  std::vector<Vertex> &vs = solver.conflictGraph.vs;
-  std::vector<Edge> &es = solver.conflictGraph.es;
-
-  float value = 0;       // sum for the clique in the present LP relaxation
-  for(p = 0; p < solver.instance.getPeriodCount(); p++)
-    for(clique = 0; clique < cs.size(); clique++) {
-      for(ci = 0; ci < cs.at(clique).size(); ci++)
-        value += (*vals)[cs[clique][ci]][p];
-      // Do you want to add the cut?
-      if (value <= 1) continue;
-      CliqueCutIdentifier id(p, clique);
-      if (cliquePool.find(id) != cliquePool.end()) continue;
-      IloExpr sum(solver.env);
-      for(r = 0; r < solver.instance.getRoomCount(); r++)
-        for(ci = 0; ci < cs.at(clique).size(); ci++)
-          sum += solver.vars.x[p][r][cs[clique][ci]];
-      IloConstraint cut(sum <= 1);
-      add(cut);
-      cuts += 1;
-      cliquePool[id] = true;
-      // std::cout << "Mycuts: Added a new clique cut (" << value << ")" << std::endl;
-    }
-
-    if (cuts > 0) { 
-      totalCutsAdded += cuts;    
-      std::cout << "Mycuts: Added " << cuts << " cut(s) from " << cs.size() << " pre-generated cliques in round " << totalCalls << std::endl;
-      return true;
-    } else return false;
-}
-
-bool CutManagerI::genCutsFromTriangles(RelaxationSummary vals) {
-
-  int cuts = 0;
-
-  int p, r;  // period, room
-  std::vector< std::vector<int> > &cs = solver.conflictGraph.cliques;
-  std::vector<Vertex> &vs = solver.conflictGraph.vs;
-  std::vector<Edge> &es = solver.conflictGraph.es;
-
-  for (int u = 0; u < vs.size(); u++)
-    for (std::set<int>::iterator vi = vs[u].adj.begin(); vi != vs[u].adj.end(); vi++)
-      if (u < (*vi))
-        for (std::set<int>::iterator wi = vs[*vi].adj.begin(); wi != vs[*vi].adj.end(); wi++)
-          if ((*vi < (*wi)) && (vs[(*wi)].adj.find(u) != vs[(*wi)].adj.end()))
-            for(p = 0; p < solver.instance.getPeriodCount(); p++) {
-              float value = (*vals)[u][p] + (*vals)[*vi][p] + (*vals)[*wi][p];
-              if (value <= 1.01) continue;  // TODO: improve upon this
-              IloExpr sum(solver.env);
-              for(r = 0; r < solver.instance.getRoomCount(); r++)
-                sum += solver.vars.x[p][r][u] + solver.vars.x[p][r][*vi] + solver.vars.x[p][r][*wi];
-              IloConstraint cut(sum <= 1);
-              // std::cout << "Mycuts: Added a violated triangle inequality (" << value << ")" << std::endl;
-              cuts += 1;
-              sum.end();
-            }
-
-            if (cuts > 0) { 
-              totalCutsAdded += cuts;    
-              std::cout << "Mycuts: Added " << cuts << " cut(s) from triangles in round " << totalCalls << std::endl;
-              return true; 
-            } else return false;
 }
 
 
-/*  Adds (most of the time redundant) cuts of the form:
-forall (c in Courses, d in Days)
-sum (p in HasPeriods[d], r in Rooms) 
-Taught[p][r][c] <= 1 + CourseInfo[c].events + CourseMinDayViolations[c] - CourseInfo[c].minDays; 
-*/
-bool CutManagerI::genCutsFromMindaysChecks(RelaxationSummary vals) {
-
-  int cuts = 0;
-
-  int c, d, pd, r;  // course, day, period within a day, room
-  std::vector< std::vector<int> > &cs = solver.conflictGraph.cliques;
-  std::vector<Vertex> &vs = solver.conflictGraph.vs;
-  std::vector<Edge> &es = solver.conflictGraph.es;
-
-  for(c = 0; c < solver.instance.getCourseCount(); c++)
-    for(d = 0; d < solver.instance.getDayCount(); d++) {
-      float lhsValue = 0;
-      for (pd = 0; pd < solver.instance.getPeriodsPerDayCount(); pd++) {
-        lhsValue += (*vals)[c][d * solver.instance.getPeriodsPerDayCount() + pd];
-      }
-      IloExpr rhsExpr(solver.env);
-      try {
-        rhsExpr += 1 + solver.instance.getCourse(c).lectures - solver.instance.getCourse(c).minWorkingDays
-          + solver.vars.courseMinDayViolations[c];
-        if (lhsValue > getValue(rhsExpr) + 0.001) { 
-          IloExpr lhsExpr(solver.env);
-          for (pd = 0; pd < solver.instance.getPeriodsPerDayCount(); pd++)
-            for (r = 0; r < solver.instance.getRoomCount(); r++)
-              lhsExpr += solver.vars.x[d * solver.instance.getPeriodsPerDayCount() + pd][r][c];
-          add(lhsExpr <= rhsExpr);
-          cuts += 1;
-          lhsExpr.end();
-        }
-      } catch (...) { /* variable pre-processed away */ }
-      rhsExpr.end();
-    }    
-
-    if (cuts > 0) { 
-      totalCutsAdded += cuts;    
-      std::cout << "Mycuts: Added " << cuts << " cut(s) from mindays checks in round " << totalCalls << std::endl;
-      return true; 
-    } else return false;
-}
-
-
-/*  Adds (most of the time unnecessary) cuts of the form:
-*    forall (cu in Curricula)
-*    sum (c in CurriculumHasCourses[cu], p in Periods, r in Rooms) 
-*    Taught[p][r][c] == CurriculumHasEventsCount[cu]; 
-*/
-bool CutManagerI::genCutsFromCurriculumChecks(RelaxationSummary vals) {
-
-  int cuts = 0;
-
-  int u, ui, p, r;  // index within a curriculum, course, period, room
-  std::vector< std::vector<int> > &cs = solver.conflictGraph.cliques;
-  std::vector<Vertex> &vs = solver.conflictGraph.vs;
-  std::vector<Edge> &es = solver.conflictGraph.es;
-
-  for(u = 0; u < solver.instance.getCurriculumCount(); u++) {
-
-    float has = 0;
-    float shouldHave = 0;
-    for (ui = 0; ui < solver.instance.getCurriculum(u).courseIds.size(); ui++) {
-      IloInt c = solver.instance.getCurriculum(u).courseIds.at(ui);
-      shouldHave += solver.instance.getCourse(c).lectures;
-      for(p = 0; p < solver.instance.getPeriodCount(); p++)
-        has += (*vals)[c][p];
-    }
-
-    if (std::fabs(shouldHave - has) > 0.001) {
-      IloExpr expr(solver.env);
-      for (ui = 0; ui < solver.instance.getCurriculum(u).courseIds.size(); ui++) {
-        IloInt c = solver.instance.getCurriculum(u).courseIds.at(ui);
-        for(p = 0; p < solver.instance.getPeriodCount(); p++)
-          for(r = 0; r < solver.instance.getRoomCount(); r++)    
-            expr += solver.vars.x[p][r][c];
-      }
-      add(expr == shouldHave);      
-      cuts += 1;
-      expr.end();
-    }
-  }      
-
-  if (cuts > 0) { 
-    totalCutsAdded += cuts;    
-    std::cout << "Mycuts: Added " << cuts << " cut(s) from curricul checks in round " << totalCalls << std::endl;
-    return true; 
-  } else return false;
-}
-
-
-bool CutManagerI::genCutsFromPatterns(RelaxationSummary vals) {
-
-  int cuts = 0;
-  PatternDB patterns = solver.instance.getPatterns();
-
-  int r, u, ui, d, pd;  // room, curriculum, index within, day, period within
-  int pati;             // pati for index within patterns
-  for(u = 0; u < solver.instance.getProperCurriculumCount(); u++)
-    for(d = 0; d < solver.instance.getDayCount(); d++) {
-      IloExpr rhsExpr(solver.env);
-      try {
-        // Get the current penalties, which are fixed across all patterns
-        // for(s = 0; s < solver.instance.getCheckCount(); s++)
-        rhsExpr += solver.vars.singletonChecks[u][d][0];
-        float rhs = getValue(rhsExpr);
-
-        // Compute the LHS for each pattern
-        for (pati = 0; pati < patterns.size(); pati++) {
-          float lhs = 0;
-          for (pd = 0; pd < solver.instance.getPeriodsPerDayCount(); pd++) {
-            IloInt p = d * solver.instance.getPeriodsPerDayCount() + pd;
-            float factor = 0;
-            for (ui = 0; ui < solver.instance.getCurriculum(u).courseIds.size(); ui++)
-              factor += (*vals)[solver.instance.getCurriculum(u).courseIds.at(ui)][p];
-            lhs += patterns[pati].coefs[pd] * factor;
-          }
-          lhs += 1 - patterns[pati].rhs;
-          lhs *= patterns[pati].penalty;
-
-          // If the constraint is violated, add the cut
-          if (lhs - rhs > 0.001) {
-            // std::cout << "Mycuts: Violation of pattern cut for curriculum " << u << " day " << d << " ..." << std::endl;
-
-            IloExpr lhsExpr(solver.env);
-            for (ui = 0; ui < solver.instance.getCurriculum(u).courseIds.size(); ui++) {
-              IloInt c = solver.instance.getCurriculum(u).courseIds.at(ui);
-              for (pd = 0; pd < solver.instance.getPeriodsPerDayCount(); pd++) {
-                IloExpr factor(solver.env);
-                IloInt p = d * solver.instance.getPeriodsPerDayCount() + pd;
-                for (r = 0; r < solver.instance.getRoomCount(); r++)
-                  factor += solver.vars.x[p][r][c];
-                lhsExpr += patterns[pati].coefs[pd] * factor;
-              }
-            }
-            lhsExpr += 1 - patterns[pati].rhs;
-            lhsExpr *= patterns[pati].penalty;
-            IloConstraint cut(lhsExpr - rhsExpr <= 0);
-            add(cut);
-            lhsExpr.end();
-            cuts += 1; 
-          }
-
-        }      
-
-      } catch (...) {
-        std::cerr << "Solver: An exception intercepted." << std::endl;
-      }
-      rhsExpr.end();
-    }
-
-    if (cuts > 0) { 
-      totalCutsAdded += cuts;    
-      std::cout << "Mycuts: Added " << cuts << " cut(s) from patterns in round " << totalCalls << std::endl;
-      return true; 
-    } else { return false; }
+void CutManagerI::checkTailOff() {
+  // Only the root counts, where the rounds of the cut loop follow one another
+  if (getNnodes() > 0) return;
+  double bound = getObjValue();
+  if (bound - lastBound < tailOff) stalledRounds += 1;
+  else stalledRounds = 0;
+  lastBound = bound;
+  if (stalledRounds < tailOffRounds) return;
+  active = false;
+  std::cout << "Mycuts: The bound " << bound << " has tailed off in round " << totalCalls
+    << ", separating the patterns only from now on" << std::endl;
 }
 
 
 void CutManagerI::logProgress() {
-  std::ofstream file;
-  std::string filename = solver.instance.getFilename();
-  filename.append(".log");
-  file.open(filename.c_str(), std::ofstream::app);
   IloNum LB = getBestObjValue();
   if (LB < 0.001) LB = 0;
-  file << getEnv().getTime() << " " << getNnodes() << " " << LB << std::endl;
-  file.close();  
+  events.push(BoundEvent, getNnodes(), LB);
 }
\ No newline at end of file
@@ -12,58 +12,74 @@
 #ifndef UDINE_CUT_CUT_MANAGER
 #define UDINE_CUT_CUT_MANAGER
 
-#include <map>
+#include <algorithm>
 #include <vector>
-#include <utility>
 
-#include <boost/shared_ptr.hpp>
 #include <ilcplex/ilocplex.h>
 
 #include "solver.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "events.h"
+#include "separators.h"
+#include "snapshots.h"
 
 
-// For clique cuts
-typedef std::pair<int, int> CliqueCutIdentifier;  // period, clique
-typedef std::map<CliqueCutIdentifier, bool> CliquePool;
-
-// For relaxation processing, access using (*vals)[c][p]
-typedef boost::shared_ptr< std::vector< std::vector<float> > > RelaxationSummary;
-
-// Handles cut management
+/* Handles cut management, of the families the registry of the solver leaves to it;
+* the rest are in the model or the pools of CPLEX already. The patterns, if separated
+* at all, are always separated, as the penalties depend on them, while the other
+* families can be switched off, once the bound has improved by less than tailOff
+* in each of tailOffRounds rounds in a row.
+* Level 6 adds the clique pool and the triangles to the default families.
+* Which of the families are separated at a given node is up to the scheduler,
+* and how each fared is counted in the telemetry.
+* The separation itself does not need CPLEX; the relaxation each call sees
+* and the cuts it finds can be recorded, to be replayed by bench-separation.
+*/
 class CutManagerI : public IloCplex::LazyConstraintCallbackI {
 protected:
   bool active;
   int cutLevel;
   int cutUp;
-  int totalCalls, frequency;
+  double tailOff, lastBound;
+  int tailOffRounds, stalledRounds;
+  int totalCalls;
   int totalCutsAdded;
   int integerLB;
   TimetablingSolver& solver;
   IloCplex& cplex;
-  CliquePool cliquePool;
-  RelaxationSummary getRelaxationSummedOverRooms();
+  Separators separators;
+  SeparationScheduler &scheduler;
+  SeparationTelemetry &telemetry;
+  EventLog &events;
+  SnapshotFile *snapshots;
+  void getRelaxation(Relaxation &relaxation, std::vector<float> &xs);
+  bool separate(int family, int depth, const Relaxation &relaxation, std::vector<Cut> &cuts, int &families,
+    SeparationTelemetry::ThreadCounters &counters, SeparationTelemetry::CallbackRecord &record);
+  void addCut(const Cut &cut);
 public:
   ILOCOMMONCALLBACKSTUFF(CutManager) 
-    CutManagerI(IloEnv env, IloCplex &c, TimetablingSolver& s, int limit, int level) 
-    : IloCplex::LazyConstraintCallbackI(env), cplex(c), solver(s), cutUp(limit), cutLevel(level) {
+    CutManagerI(IloEnv env, IloCplex &c, TimetablingSolver& s, int limit, int level, SeparationScheduler &sch,
+    SeparationTelemetry &tel, EventLog &log, double threshold = 0, int rounds = 3, SnapshotFile *recorder = 0) 
+    : IloCplex::LazyConstraintCallbackI(env), cplex(c), solver(s), cutUp(limit), cutLevel(level),
+    separators(s.instance, s.conflictGraph), scheduler(sch), telemetry(tel), events(log), snapshots(recorder),
+    tailOff(threshold), tailOffRounds(rounds) {
       active = true;
+      lastBound = -IloInfinity;
+      stalledRounds = 0;
       totalCalls = 0; 
-      frequency = 1; 
       totalCutsAdded = 0;
       integerLB = 0;
       std::cout << "Mycuts: Instantiating the cut manager ..." << std::endl;
   } 
   void main();
   void logProgress();
-  bool genCutsFromObjIntegrality(RelaxationSummary vals);
-  bool genCutsFromCliquePool(RelaxationSummary vals);
-  bool genCutsFromTriangles(RelaxationSummary vals);
-  bool genCutsFromPatterns(RelaxationSummary vals);
-  bool genCutsFromMindaysChecks(RelaxationSummary vals);
-  bool genCutsFromCurriculumChecks(RelaxationSummary vals);
+  void checkTailOff();
 };
 
-IloCplex::Callback CutManager(IloEnv env, IloCplex &c, TimetablingSolver& s, int cutUp, int level);
+IloCplex::Callback CutManager(IloEnv env, IloCplex &c, TimetablingSolver& s, int cutUp, int level,
+  SeparationScheduler &scheduler, SeparationTelemetry &telemetry, EventLog &events,
+  double tailOff = 0, int tailOffRounds = 3, SnapshotFile *snapshots = 0);
 
 // Should there be an implementation of:
 // IloCplex::CallbackI* duplicateCallback() const { return (new (getEnv()) CutManagerI(*this)); } 
@@ -0,0 +1,100 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include "cut_registry.h"
+
+static const char *modeNames[CutModeCount] = { "static", "lazy", "user", "dynamic", "off" };
+
+
+const char *getCutModeName(int mode) {
+  return (mode >= 0 && mode < CutModeCount) ? modeNames[mode] : "unknown";
+}
+
+
+bool getCutModeByName(const std::string &name, int &mode) {
+  for (int m = 0; m < CutModeCount; m++)
+    if (name == modeNames[m]) {
+      mode = m;
+      return true;
+    }
+  return false;
+}
+
+
+CutRegistry::CutRegistry() {
+  for (int f = 0; f < CutFamilyCount; f++) {
+    modes[f] = DynamicCuts;
+    built[f] = 0;
+    buildTime[f] = 0;
+  }
+  modes[PatternCuts] = StaticCuts;
+  modes[LinkingCuts] = StaticCuts;
+}
+
+
+bool CutRegistry::allows(int family, int mode) {
+  if (family < 0 || family >= CutFamilyCount || mode < 0 || mode >= CutModeCount) return false;
+  if (family == PatternCuts) return mode != UserCuts && mode != NoCuts;
+  if (family == ObjIntegralityCuts) return mode == DynamicCuts || mode == NoCuts;
+  return true;
+}
+
+
+bool CutRegistry::set(int family, int mode) {
+  if (!allows(family, mode)) return false;
+  modes[family] = mode;
+  return true;
+}
+
+
+bool CutRegistry::set(const std::string &assignment) {
+  size_t at = assignment.find('=');
+  if (at == std::string::npos) return false;
+  std::string family = assignment.substr(0, at);
+  int mode;
+  if (!getCutModeByName(assignment.substr(at + 1), mode)) return false;
+  for (int f = 0; f < CutFamilyCount; f++)
+    if (family == getCutFamilyName(f)) return set(f, mode);
+  return false;
+}
+
+
+void CutRegistry::recordBuild(int family, int cuts, double milliseconds) {
+  built[family] += cuts;
+  buildTime[family] += milliseconds;
+}
+
+
+void CutRegistry::report(std::ostream &out, SeparationScheduler &scheduler) const {
+  for (int m = 0; m < CutModeCount; m++) {
+    std::string families;
+    int cuts = 0;
+    double milliseconds = 0;
+    for (int f = 0; f < CutFamilyCount; f++) {
+      if (modes[f] != m) continue;
+      families += (families.empty() ? "" : ", ") + std::string(getCutFamilyName(f));
+      if (m == DynamicCuts) {
+        int separated;
+        double time;
+        scheduler.getTotals(f, separated, time);
+        cuts += separated;
+        milliseconds += time;
+      } else {
+        cuts += built[f];
+        milliseconds += buildTime[f];
+      }
+    }
+    if (families.empty()) continue;
+    out << "Mycuts: " << getCutModeName(m) << " (" << families << "): ";
+    if (m == NoCuts) out << "none" << std::endl;
+    else out << cuts << " cut(s) " << (m == DynamicCuts ? "separated" : "built") << " in " << milliseconds << " ms" << std::endl;
+  }
+}
@@ -0,0 +1,64 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_CUT_REGISTRY
+#define UDINE_CUT_REGISTRY
+
+#include <ostream>
+#include <string>
+
+#include "scheduler.h"
+
+// Where the cuts of a family go
+enum CutMode {
+  StaticCuts,     // enumerated into the model up front
+  LazyCuts,       // enumerated into the pool of lazy constraints of CPLEX
+  UserCuts,       // enumerated into the pool of user cuts of CPLEX
+  DynamicCuts,    // separated by the cut manager
+  NoCuts,         // not at all
+  CutModeCount
+};
+
+const char *getCutModeName(int mode);
+bool getCutModeByName(const std::string &name, int &mode);
+
+/* One mode for each family of cuts, so that no cut is both in the model or a pool
+* and separated again. The patterns carry the penalties of isolated lectures, so they
+* cannot be mere user cuts, nor off; the cuts on the objective depend on the bound,
+* so they can only be separated. By default, the patterns and the linking rows are
+* static and the rest are dynamic, which is what the cut level then picks from.
+* The registry also keeps how many cuts each family was enumerated into and how long
+* that took; the separation of the dynamic ones is up to the scheduler to count.
+*/
+class CutRegistry {
+protected:
+  int modes[CutFamilyCount];
+  int built[CutFamilyCount];
+  double buildTime[CutFamilyCount];   // ms
+
+public:
+  CutRegistry();
+
+  // False if the family cannot go there
+  static bool allows(int family, int mode);
+  bool set(int family, int mode);
+  // Of the form <family>=<mode>, false if either is unknown or not allowed
+  bool set(const std::string &assignment);
+  int getMode(int family) const { return modes[family]; }
+  bool isEnumerated(int family) const { return modes[family] == StaticCuts || modes[family] == LazyCuts || modes[family] == UserCuts; }
+  bool isSeparated(int family) const { return modes[family] == DynamicCuts; }
+
+  void recordBuild(int family, int cuts, double milliseconds);
+  // The cuts built and the time taken per mode, with the separation as the scheduler saw it
+  void report(std::ostream &out, SeparationScheduler &scheduler) const;
+};
+
+#endif // UDINE_CUT_REGISTRY
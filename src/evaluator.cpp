@@ -0,0 +1,220 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cassert>
+#include <algorithm>
+
+#include "evaluator.h"
+
+// The number of isolated periods in a day, given the bit-mask of busy periods
+inline int countIsolated(unsigned int mask) {
+  unsigned int isolated = mask & ~(mask << 1) & ~(mask >> 1);
+  int n = 0;
+  for (; isolated; n++) isolated &= isolated - 1;
+  return n;
+}
+
+inline int minDaysPenalty(int days, int minimum) {
+  return (days < minimum) ? 5 * (minimum - days) : 0;
+}
+
+
+Penalties Penalties::operator-(const Penalties &o) const {
+  Penalties d;
+  d.lectures = lectures - o.lectures;
+  d.conflicts = conflicts - o.conflicts;
+  d.roomOccupancy = roomOccupancy - o.roomOccupancy;
+  d.availability = availability - o.availability;
+  d.roomCapacity = roomCapacity - o.roomCapacity;
+  d.minWorkingDays = minWorkingDays - o.minWorkingDays;
+  d.isolatedLectures = isolatedLectures - o.isolatedLectures;
+  d.roomStability = roomStability - o.roomStability;
+  return d;
+}
+
+
+std::ostream& operator<<(std::ostream &os, const Penalties &p) {
+  os << "hard " << p.getHard()
+    << " (lectures " << p.lectures << ", conflicts " << p.conflicts
+    << ", room occupancy " << p.roomOccupancy << ", availability " << p.availability << "), "
+    << "soft " << p.getSoft()
+    << " (room capacity " << p.roomCapacity << ", min working days " << p.minWorkingDays
+    << ", isolated lectures " << p.isolatedLectures << ", room stability " << p.roomStability << ")";
+  return os;
+}
+
+
+TimetableEvaluator::TimetableEvaluator(TimetablingInstance &i, bool singletonCurricula)
+: instance(i), P(i.getPeriodCount()), R(i.getRoomCount()), C(i.getCourseCount()),
+U(i.getCurriculumCount()), D(i.getDayCount()), ppd(i.getPeriodsPerDayCount()),
+properCurricula(i.getProperCurriculumCount()) {
+
+  assert(ppd <= 8 * sizeof(unsigned int) - 1);
+
+  int c, r, u, f;
+  lectureCounts.resize(C);
+  minWorkingDays.resize(C);
+  capacityPenalties.resize(C * R);
+  for (c = 0; c < C; c++) {
+    lectureCounts[c] = i.getCourse(c).lectures;
+    minWorkingDays[c] = i.getCourse(c).minWorkingDays;
+    for (r = 0; r < R; r++)
+      capacityPenalties[c * R + r] = std::max(0, i.getCourse(c).students - i.getRoom(r).capacity);
+  }
+
+  unavailable.assign(C * P, 0);
+  for (f = 0; f < i.getRestrictionCount(); f++)
+    unavailable[i.getRestriction(f).courseId * P + i.getRestriction(f).period] = 1;
+
+  courseCurricula.resize(C);
+  for (u = 0; u < U; u++)
+    for (c = 0; c < i.getCurriculum(u).courseIds.size(); c++)
+      courseCurricula[i.getCurriculum(u).courseIds[c]].push_back(u);
+  S = singletonCurricula ? i.getSingletonCurriculumCount() : 0;
+  for (u = 0; u < S; u++)
+    courseCurricula[i.getSingletonCurriculum(u).courseIds[0]].push_back(U + u);
+
+  evaluate(Lectures());
+}
+
+
+void TimetableEvaluator::add(const Lecture &l) {
+  int c = l.course, p = l.period, r = l.room, d = l.period / ppd;
+
+  penalties.lectures += (scheduled[c]++ < lectureCounts[c]) ? -1 : 1;
+  if (coursePeriods[c * P + p]++ > 0) penalties.conflicts += 1;
+  if (roomPeriods[r * P + p]++ > 0) penalties.roomOccupancy += 1;
+  if (unavailable[c * P + p]) penalties.availability += 1;
+
+  for (std::vector<int>::const_iterator it = courseCurricula[c].begin(); it != courseCurricula[c].end(); it++) {
+    int u = *it;
+    if (curriculumPeriods[u * P + p]++ > 0) { if (u < U) penalties.conflicts += 1; }
+    else if (u < properCurricula || u >= U) {
+      unsigned int &mask = curriculumDays[u * D + d];
+      penalties.isolatedLectures -= 2 * countIsolated(mask);
+      mask |= 1u << (p - d * ppd);
+      penalties.isolatedLectures += 2 * countIsolated(mask);
+    }
+  }
+
+  penalties.roomCapacity += capacityPenalties[c * R + r];
+  if (courseDayCounts[c * D + d]++ == 0) {
+    penalties.minWorkingDays -= minDaysPenalty(courseDays[c], minWorkingDays[c]);
+    courseDays[c] += 1;
+    penalties.minWorkingDays += minDaysPenalty(courseDays[c], minWorkingDays[c]);
+  }
+  if (courseRoomCounts[c * R + r]++ == 0)
+    if (courseRooms[c]++ > 0) penalties.roomStability += 1;
+}
+
+
+void TimetableEvaluator::remove(const Lecture &l) {
+  int c = l.course, p = l.period, r = l.room, d = l.period / ppd;
+
+  penalties.lectures += (--scheduled[c] < lectureCounts[c]) ? 1 : -1;
+  if (--coursePeriods[c * P + p] > 0) penalties.conflicts -= 1;
+  if (--roomPeriods[r * P + p] > 0) penalties.roomOccupancy -= 1;
+  if (unavailable[c * P + p]) penalties.availability -= 1;
+
+  for (std::vector<int>::const_iterator it = courseCurricula[c].begin(); it != courseCurricula[c].end(); it++) {
+    int u = *it;
+    if (--curriculumPeriods[u * P + p] > 0) { if (u < U) penalties.conflicts -= 1; }
+    else if (u < properCurricula || u >= U) {
+      unsigned int &mask = curriculumDays[u * D + d];
+      penalties.isolatedLectures -= 2 * countIsolated(mask);
+      mask &= ~(1u << (p - d * ppd));
+      penalties.isolatedLectures += 2 * countIsolated(mask);
+    }
+  }
+
+  penalties.roomCapacity -= capacityPenalties[c * R + r];
+  if (--courseDayCounts[c * D + d] == 0) {
+    penalties.minWorkingDays -= minDaysPenalty(courseDays[c], minWorkingDays[c]);
+    courseDays[c] -= 1;
+    penalties.minWorkingDays += minDaysPenalty(courseDays[c], minWorkingDays[c]);
+  }
+  if (--courseRoomCounts[c * R + r] == 0)
+    if (--courseRooms[c] > 0) penalties.roomStability -= 1;
+}
+
+
+const Penalties &TimetableEvaluator::evaluate(const Lectures &l) {
+  int c;
+
+  penalties = Penalties();
+  scheduled.assign(C, 0);
+  coursePeriods.assign(C * P, 0);
+  roomPeriods.assign(R * P, 0);
+  curriculumPeriods.assign((U + S) * P, 0);
+  curriculumDays.assign((U + S) * D, 0);
+  courseDayCounts.assign(C * D, 0);
+  courseDays.assign(C, 0);
+  courseRoomCounts.assign(C * R, 0);
+  courseRooms.assign(C, 0);
+  for (c = 0; c < C; c++) {
+    penalties.lectures += lectureCounts[c];
+    penalties.minWorkingDays += minDaysPenalty(0, minWorkingDays[c]);
+  }
+
+  lectures = l;
+  for (Lectures::const_iterator it = lectures.begin(); it != lectures.end(); it++)
+    add(*it);
+  return penalties;
+}
+
+
+Penalties TimetableEvaluator::getMoveDelta(int lecture, int period, int room) {
+  Penalties before = penalties;
+  Lecture original = lectures[lecture];
+  Lecture moved = original;
+  moved.period = period;
+  moved.room = room;
+
+  remove(original);
+  add(moved);
+  Penalties delta = penalties - before;
+  remove(moved);
+  add(original);
+  return delta;
+}
+
+
+Penalties TimetableEvaluator::getSwapDelta(int first, int second) {
+  Penalties before = penalties;
+  Lecture a = lectures[first], b = lectures[second];
+  Lecture swappedA = a, swappedB = b;
+  swappedA.period = b.period; swappedA.room = b.room;
+  swappedB.period = a.period; swappedB.room = a.room;
+
+  remove(a); remove(b);
+  add(swappedA); add(swappedB);
+  Penalties delta = penalties - before;
+  remove(swappedA); remove(swappedB);
+  add(a); add(b);
+  return delta;
+}
+
+
+void TimetableEvaluator::move(int lecture, int period, int room) {
+  remove(lectures[lecture]);
+  lectures[lecture].period = period;
+  lectures[lecture].room = room;
+  add(lectures[lecture]);
+}
+
+
+void TimetableEvaluator::swap(int first, int second) {
+  Lecture &a = lectures[first], &b = lectures[second];
+  remove(a); remove(b);
+  std::swap(a.period, b.period);
+  std::swap(a.room, b.room);
+  add(a); add(b);
+}
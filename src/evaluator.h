@@ -0,0 +1,96 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_EVALUATOR
+#define UDINE_EVALUATOR
+
+#include <iostream>
+#include <vector>
+
+#include "loader.h"
+#include "timetable.h"
+
+// Penalties of a timetable, by constraint, already weighted as in the objective
+struct Penalties {
+  // Hard constraints
+  int lectures;          // lectures missing or in excess
+  int conflicts;         // lectures of a course, curriculum or teacher in the same period
+  int roomOccupancy;     // lectures in the same room in the same period
+  int availability;      // lectures when the teacher is not available
+  // Soft constraints
+  int roomCapacity;      // the number of missing seats
+  int minWorkingDays;    // 5 for each day below the minimum number of working days
+  int isolatedLectures;  // 2 for each lecture isolated in a curriculum's day
+  int roomStability;     // 1 for each room used on the top of a single room per course
+
+  Penalties() : lectures(0), conflicts(0), roomOccupancy(0), availability(0),
+    roomCapacity(0), minWorkingDays(0), isolatedLectures(0), roomStability(0) {}
+  int getHard() const { return lectures + conflicts + roomOccupancy + availability; }
+  int getSoft() const { return roomCapacity + minWorkingDays + isolatedLectures + roomStability; }
+  Penalties operator-(const Penalties &o) const;
+};
+
+std::ostream& operator<<(std::ostream &os, const Penalties &p);
+
+
+/* Holds a timetable together with counters, which make it possible to evaluate
+* a move of a lecture or a swap of two lectures in O(ppd) time per curriculum
+* of the courses involved: lectures per course and day, per course and room,
+* per curriculum and period, and a bit-mask of busy periods per curriculum and day.
+* By default, isolated lectures are counted also in the curricula of a single course,
+* as in the ITC 2007 rules, although the model leaves those out.
+*/
+class TimetableEvaluator {
+protected:
+  TimetablingInstance &instance;
+  int P, R, C, U, S, D, ppd;  // S for the singleton curricula counted
+
+  // Flattened instance data
+  std::vector<int> lectureCounts, minWorkingDays;   // indexed with courses
+  std::vector<int> capacityPenalties;               // indexed with courses x rooms
+  std::vector<char> unavailable;                    // indexed with courses x periods
+  std::vector< std::vector<int> > courseCurricula;  // the proper, the teachers', and the singleton curricula
+  int properCurricula;
+
+  // The timetable and the counters
+  Lectures lectures;
+  Penalties penalties;
+  std::vector<int> scheduled;          // indexed with courses
+  std::vector<int> coursePeriods;      // indexed with courses x periods
+  std::vector<int> roomPeriods;        // indexed with rooms x periods
+  std::vector<int> curriculumPeriods;  // indexed with all curricula x periods
+  std::vector<unsigned int> curriculumDays;  // bit-masks indexed with all curricula x days
+  std::vector<int> courseDayCounts;    // indexed with courses x days
+  std::vector<int> courseDays;         // indexed with courses
+  std::vector<int> courseRoomCounts;   // indexed with courses x rooms
+  std::vector<int> courseRooms;        // indexed with courses
+
+  void add(const Lecture &l);
+  void remove(const Lecture &l);
+
+public:
+  TimetableEvaluator(TimetablingInstance &i, bool singletonCurricula = true);
+
+  // Full evaluation, which replaces the timetable held
+  const Penalties &evaluate(const Lectures &l);
+
+  const Penalties &getPenalties() const { return penalties; }
+  const Lectures &getLectures() const { return lectures; }
+
+  // Changes of the penalties, were a lecture moved or two lectures swapped
+  Penalties getMoveDelta(int lecture, int period, int room);
+  Penalties getSwapDelta(int first, int second);
+
+  void move(int lecture, int period, int room);
+  void swap(int first, int second);
+};
+
+#endif // UDINE_EVALUATOR
@@ -0,0 +1,180 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdlib>
+#include <cstring>
+
+#include <boost/bind.hpp>
+
+#include "events.h"
+#include "scheduler.h"
+
+const char *getEventName(int type) {
+  switch (type) {
+    case BoundEvent: return "bound";
+    case IncumbentEvent: return "incumbent";
+    case CutsEvent: return "cuts";
+  }
+  return "unknown";
+}
+
+
+EventLog::EventLog(const std::string &path, int capacity)
+  : head(0), tail(0), stopping(false), dropped(0) {
+  unsigned size = 1;
+  while (size < unsigned(capacity)) size *= 2;
+  mask = size - 1;
+  slots = new Slot[size];
+  for (unsigned i = 0; i < size; i++) slots[i].sequence.store(i, boost::memory_order_relaxed);
+  created = boost::get_system_time();
+  file.open(path.c_str(), std::ofstream::out);
+  writer = boost::thread(boost::bind(&EventLog::run, this));
+}
+
+
+EventLog::~EventLog() {
+  close();
+  delete [] slots;
+}
+
+
+void EventLog::close() {
+  if (!writer.joinable()) return;
+  stopping.store(true);
+  writer.join();
+  file.close();
+}
+
+
+double EventLog::getElapsed() const {
+  return (boost::get_system_time() - created).total_microseconds() / 1000000.0;
+}
+
+
+bool EventLog::push(int type, int nodes, double value, int family) {
+  unsigned position = head.load(boost::memory_order_relaxed);
+  Slot *slot;
+  for (;;) {
+    slot = &slots[position & mask];
+    unsigned sequence = slot->sequence.load(boost::memory_order_acquire);
+    int difference = int(sequence - position);
+    if (difference == 0) {
+      if (head.compare_exchange_weak(position, position + 1, boost::memory_order_relaxed)) break;
+    } else if (difference < 0) {
+      // The writer has not caught up yet
+      dropped.fetch_add(1, boost::memory_order_relaxed);
+      return false;
+    } else {
+      position = head.load(boost::memory_order_relaxed);
+    }
+  }
+  slot->event.time = getElapsed();
+  slot->event.type = type;
+  slot->event.nodes = nodes;
+  slot->event.family = family;
+  slot->event.value = value;
+  slot->sequence.store(position + 1, boost::memory_order_release);
+  return true;
+}
+
+
+bool EventLog::pop(Event &event) {
+  Slot &slot = slots[tail & mask];
+  unsigned sequence = slot.sequence.load(boost::memory_order_acquire);
+  if (int(sequence - (tail + 1)) < 0) return false;
+  event = slot.event;
+  slot.sequence.store(tail + mask + 1, boost::memory_order_release);
+  tail += 1;
+  return true;
+}
+
+
+void EventLog::write(const Event &event) {
+  file << "{\"time\": " << event.time << ", \"event\": \"" << getEventName(event.type)
+    << "\", \"nodes\": " << event.nodes << ", \"value\": " << event.value;
+  if (event.family >= 0) file << ", \"family\": \"" << getCutFamilyName(event.family) << "\"";
+  file << "}\n";
+}
+
+
+void EventLog::run() {
+  Event event;
+  for (;;) {
+    bool last = stopping.load();
+    while (pop(event)) write(event);
+    file.flush();
+    if (last) break;
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+  }
+  if (dropped.load() > 0) file << "{\"dropped\": " << dropped.load() << "}\n";
+}
+
+
+bool findNumber(const std::string &line, const char *key, double &value) {
+  size_t at = line.find(key);
+  if (at == std::string::npos) return false;
+  at = line.find(':', at + std::strlen(key));
+  if (at == std::string::npos) return false;
+  const char *begin = line.c_str() + at + 1;
+  char *end;
+  value = std::strtod(begin, &end);
+  return end != begin;
+}
+
+
+bool convertEvents(const std::string &events, std::ostream &out) {
+  std::ifstream in(events.c_str());
+  if (!in) return false;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.find("\"event\": \"bound\"") == std::string::npos) continue;
+    double time, nodes, value;
+    if (!findNumber(line, "\"time\"", time) || !findNumber(line, "\"nodes\"", nodes)
+      || !findNumber(line, "\"value\"", value)) continue;
+    out << time << " " << int(nodes) << " " << value << std::endl;
+  }
+  return true;
+}
+
+
+bool findFirstEvent(const std::string &events, int type, double &time) {
+  std::ifstream in(events.c_str());
+  if (!in) return false;
+  std::string name("\"event\": \"");
+  name.append(getEventName(type)).append("\"");
+  std::string line;
+  while (std::getline(in, line))
+    if (line.find(name) != std::string::npos && findNumber(line, "\"time\"", time)) return true;
+  return false;
+}
+
+
+bool summariseEvents(const std::string &events, EventSummary &summary) {
+  summary.time = summary.bound = summary.incumbent = 0;
+  summary.nodes = summary.incumbents = 0;
+  std::ifstream in(events.c_str());
+  if (!in) return false;
+  std::string line;
+  while (std::getline(in, line)) {
+    double time, nodes, value;
+    if (!findNumber(line, "\"time\"", time) || !findNumber(line, "\"nodes\"", nodes)
+      || !findNumber(line, "\"value\"", value)) continue;
+    if (line.find("\"event\": \"bound\"") != std::string::npos) {
+      summary.time = time;
+      summary.nodes = int(nodes);
+      summary.bound = value;
+    } else if (line.find("\"event\": \"incumbent\"") != std::string::npos) {
+      if (summary.incumbents == 0 || value < summary.incumbent) summary.incumbent = value;
+      summary.incumbents += 1;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,93 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_EVENTS
+#define UDINE_EVENTS
+
+#include <fstream>
+#include <ostream>
+#include <string>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+
+enum EventType {
+  BoundEvent,       // value is the best bound
+  IncumbentEvent,   // value is the cost
+  CutsEvent,        // value is the number of cuts of the family added
+  EventTypeCount
+};
+
+const char *getEventName(int type);
+
+struct Event {
+  double time;      // in seconds since the log was created
+  int type, nodes, family;
+  double value;
+};
+
+/* Records events from the callbacks without locking or touching the file system:
+* each goes into a ring buffer of fixed size, as in Vyukov's bounded queue,
+* from which a background thread appends them to the file as JSON lines
+*   {"time": 1.25, "event": "bound", "nodes": 0, "value": 4.5}
+* every few milliseconds. Should the buffer be full, the event is dropped and counted.
+*/
+class EventLog {
+protected:
+  struct Slot {
+    boost::atomic<unsigned> sequence;
+    Event event;
+  };
+
+  Slot *slots;
+  unsigned mask;
+  boost::atomic<unsigned> head;   // where the next event goes
+  unsigned tail;                  // the next event to write, which only the writer touches
+  boost::atomic<bool> stopping;
+  boost::atomic<int> dropped;
+  boost::system_time created;
+  std::ofstream file;
+  boost::thread writer;
+
+  bool pop(Event &event);
+  void write(const Event &event);
+  void run();
+
+public:
+  // The capacity is rounded up to a power of two
+  EventLog(const std::string &path, int capacity = 4096);
+  // Writes out whatever is left
+  ~EventLog();
+  void close();
+
+  double getElapsed() const;
+  int getDropped() const { return dropped.load(); }
+
+  bool push(int type, int nodes, double value, int family = -1);
+};
+
+// Turns the bound events of a log into the three columns of the old <data>.log: time, nodes, bound
+bool convertEvents(const std::string &events, std::ostream &out);
+// The time of the first event of the type in a log, if any, e.g. of the first incumbent
+bool findFirstEvent(const std::string &events, int type, double &time);
+// The number following "key": in a line of JSON, if any, as in the logs and the reports of the benchmarks
+bool findNumber(const std::string &line, const char *key, double &value);
+
+// What a log says of a run: the last bound, with its time and nodes, and the best of the incumbents
+struct EventSummary {
+  double time, bound, incumbent;
+  int nodes, incumbents;
+  EventSummary() : time(0), bound(0), incumbent(0), nodes(0), incumbents(0) {}
+};
+bool summariseEvents(const std::string &events, EventSummary &summary);
+
+#endif // UDINE_EVENTS
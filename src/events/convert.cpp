@@ -0,0 +1,37 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "events.h"
+
+// Converts an event log <data>.events, as written by udine, to the three columns
+// of the old <data>.log (time, nodes and bound), e.g. for runs that did not finish:
+//   udine-events <data>.events [<log>]
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <events> [<log>]" << std::endl;
+    std::cerr << "where: <events> is an event log and <log> is where to write it, standard output by default" << std::endl;
+    exit(-1);
+  }
+
+  std::ofstream file;
+  if (argc >= 3) file.open(argv[2], std::ofstream::out);
+  std::ostream &out = (argc >= 3) ? file : std::cout;
+  if (!convertEvents(argv[1], out)) {
+    std::cerr << "Events: Cannot read " << argv[1] << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,176 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <algorithm>
+#include <new>
+
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#include "exchange.h"
+
+using namespace boost::interprocess;
+
+typedef scoped_lock<interprocess_mutex> ExchangeLock;
+
+static const double NoIncumbent = 1e30;
+
+
+void SolutionExchange::initialise(int mode, int members) {
+  state->mode = mode;
+  state->members = std::max(1, std::min(members, MaxExchangeMembers));
+  state->incumbent = NoIncumbent;
+  state->owner = -1;
+  for (int m = 0; m < MaxExchangeMembers; m++) {
+    state->bounds[m] = 0;
+    state->completed[m] = false;
+  }
+  state->stopped = false;
+}
+
+
+SolutionExchange::SolutionExchange(int mode, int members)
+  : owned(true), shared(0), region(0) {
+  state = new ExchangeState;
+  initialise(mode, members);
+}
+
+
+SolutionExchange::SolutionExchange(const std::string &n, int mode, int members, bool create)
+  : state(0), name(n), owned(create), shared(0), region(0) {
+  try {
+    if (create) {
+      shared_memory_object::remove(name.c_str());
+      shared = new shared_memory_object(create_only, name.c_str(), read_write);
+      shared->truncate(sizeof(ExchangeState));
+      region = new mapped_region(*shared, read_write);
+      state = new (region->get_address()) ExchangeState;
+      initialise(mode, members);
+    } else {
+      shared = new shared_memory_object(open_only, name.c_str(), read_write);
+      region = new mapped_region(*shared, read_write);
+      state = static_cast<ExchangeState *>(region->get_address());
+    }
+  } catch (interprocess_exception &) {
+    state = 0;
+  }
+}
+
+
+SolutionExchange::~SolutionExchange() {
+  if (name.empty()) {
+    delete state;
+    return;
+  }
+  if (owned && state) state->~ExchangeState();
+  delete region;
+  delete shared;
+  if (owned) shared_memory_object::remove(name.c_str());
+}
+
+
+int SolutionExchange::getMode() const {
+  return state->mode;
+}
+
+
+int SolutionExchange::getMemberCount() const {
+  return state->members;
+}
+
+
+bool SolutionExchange::offerIncumbent(int member, double cost) {
+  ExchangeLock l(state->lock);
+  if (cost >= state->incumbent) return false;
+  state->incumbent = cost;
+  state->owner = member;
+  return true;
+}
+
+
+double SolutionExchange::getIncumbent() const {
+  ExchangeLock l(state->lock);
+  return state->incumbent;
+}
+
+
+int SolutionExchange::getOwner() const {
+  ExchangeLock l(state->lock);
+  return state->owner;
+}
+
+
+void SolutionExchange::updateBound(int member, double bound) {
+  if (member < 0 || member >= state->members) return;
+  ExchangeLock l(state->lock);
+  state->bounds[member] = std::max(state->bounds[member], bound);
+}
+
+
+double SolutionExchange::getBound(int member) const {
+  ExchangeLock l(state->lock);
+  return state->bounds[member];
+}
+
+
+void SolutionExchange::complete(int member) {
+  if (member < 0 || member >= state->members) return;
+  ExchangeLock l(state->lock);
+  state->completed[member] = true;
+}
+
+
+bool SolutionExchange::isCompleted(int member) const {
+  ExchangeLock l(state->lock);
+  return state->completed[member];
+}
+
+
+// A completed member has nothing better than the incumbent, whatever its bound
+static double aggregateBound(const ExchangeState *state) {
+  double bound = (state->mode == SameProblem) ? 0 : NoIncumbent;
+  for (int m = 0; m < state->members; m++) {
+    double b = state->completed[m] ? state->incumbent : state->bounds[m];
+    if (state->mode == SameProblem) bound = std::max(bound, b);
+    else bound = std::min(bound, b);
+  }
+  return std::min(bound, state->incumbent);
+}
+
+
+double SolutionExchange::getBound() const {
+  ExchangeLock l(state->lock);
+  return aggregateBound(state);
+}
+
+
+// Once one solve of the same problem or all of the parts are done, so is the search,
+// even with no incumbent, when the problem is infeasible within the cutoff
+bool SolutionExchange::isClosed() const {
+  ExchangeLock l(state->lock);
+  if (state->stopped) return true;
+  int completed = 0;
+  for (int m = 0; m < state->members; m++)
+    if (state->completed[m]) completed += 1;
+  if (completed > 0 && (state->mode == SameProblem || completed == state->members)) return true;
+  return state->incumbent < NoIncumbent && aggregateBound(state) > state->incumbent - 1 + 1e-6;
+}
+
+
+void SolutionExchange::stop() {
+  ExchangeLock l(state->lock);
+  state->stopped = true;
+}
+
+
+bool SolutionExchange::isStopped() const {
+  ExchangeLock l(state->lock);
+  return state->stopped;
+}
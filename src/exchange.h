@@ -0,0 +1,86 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_EXCHANGE
+#define UDINE_EXCHANGE
+
+#include <string>
+
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+
+const int MaxExchangeMembers = 64;
+
+enum ExchangeMode {
+  SameProblem,          // the members solve the same problem: the bound is the best of theirs
+  PartitionedProblem    // the members solve parts of it: the bound is the worst of theirs
+};
+
+// What the members share, which is plain data, so that it can live in shared memory
+struct ExchangeState {
+  boost::interprocess::interprocess_mutex lock;
+  int mode, members;
+  double incumbent;     // the best cost found by any member, or a cutoff given
+  int owner;            // the member which found it, or -1
+  double bounds[MaxExchangeMembers];
+  bool completed[MaxExchangeMembers];
+  bool stopped;
+};
+
+/* The best incumbent and the bounds of several solves of one instance, be they
+* threads of one process (a portfolio) or processes (the shards of the tree).
+* Each member offers its incumbents and its bound, as they improve, and reads
+* back the best incumbent as a cutoff and whether the gap is closed overall.
+* The objective is integral, so the gap is closed once the bound exceeds
+* the incumbent less one.
+*/
+class SolutionExchange {
+protected:
+  ExchangeState *state;
+  std::string name;     // of the shared memory, if any
+  bool owned;
+  boost::interprocess::shared_memory_object *shared;
+  boost::interprocess::mapped_region *region;
+
+  void initialise(int mode, int members);
+
+public:
+  // Within this process only
+  SolutionExchange(int mode, int members);
+  // In shared memory of the name, which the coordinator creates and the members open
+  SolutionExchange(const std::string &name, int mode, int members, bool create);
+  // The coordinator removes the shared memory
+  ~SolutionExchange();
+
+  bool isValid() const { return state != 0; }
+  int getMode() const;
+  int getMemberCount() const;
+
+  // Returns true if the cost improves on the best known
+  bool offerIncumbent(int member, double cost);
+  double getIncumbent() const;
+  int getOwner() const;
+  // The bounds only ever go up
+  void updateBound(int member, double bound);
+  double getBound(int member) const;
+  // The member has proven its bound, e.g. optimality, or that its part holds nothing better
+  void complete(int member);
+  bool isCompleted(int member) const;
+
+  // The best bound of the same problem, or the worst bound of the parts of it
+  double getBound() const;
+  bool isClosed() const;
+  void stop();
+  bool isStopped() const;
+};
+
+#endif // UDINE_EXCHANGE
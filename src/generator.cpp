@@ -0,0 +1,264 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+
+#include "generator.h"
+
+
+GeneratorSettings::GeneratorSettings() {
+  courses = 131;
+  rooms = 0;
+  days = 5;
+  periodsPerDay = 5;
+  lectures = 3.3;
+  minWorkingDays = 0.85;
+  students = 58;
+  maxStudents = 2.8;
+  curricula = 0.6;
+  curriculumSize = 3.9;
+  teacherOverlap = 0.45;
+  restrictions = 0.2;
+  capacities = MatchedCapacities;
+  roomSlack = 2;
+  utilisation = 0.85;
+  seed = 1;
+}
+
+
+void GeneratorSettings::calibrate(TimetablingInstance &instance) {
+  int c, u;
+  courses = instance.getCourseCount();
+  rooms = instance.getRoomCount();
+  days = instance.getDayCount();
+  periodsPerDay = instance.getPeriodsPerDayCount();
+
+  double totalLectures = 0, totalMinDays = 0, totalStudents = 0, largest = 0;
+  std::map<std::string, int> taught;
+  for (c = 0; c < courses; c++) {
+    const Course &course = instance.getCourse(c);
+    totalLectures += course.lectures;
+    totalMinDays += course.minWorkingDays;
+    totalStudents += course.students;
+    largest = std::max<double>(largest, course.students);
+    taught[course.teacher] += 1;
+  }
+  lectures = totalLectures / courses;
+  minWorkingDays = totalMinDays / totalLectures;
+  students = totalStudents / courses;
+  maxStudents = largest / students;
+
+  int shared = 0;
+  for (c = 0; c < courses; c++)
+    if (taught[instance.getCourse(c).teacher] > 1) shared += 1;
+  teacherOverlap = double(shared) / courses;
+
+  // The curricula as read, i.e. the proper ones and the singletons, without those of the teachers
+  int count = instance.getProperCurriculumCount() + instance.getSingletonCurriculumCount();
+  double size = 0;
+  for (u = 0; u < instance.getProperCurriculumCount(); u++) size += instance.getCurriculum(u).courseIds.size();
+  size += instance.getSingletonCurriculumCount();
+  curricula = double(count) / courses;
+  curriculumSize = count > 0 ? size / count : 0;
+
+  restrictions = double(instance.getRestrictionCount()) / (courses * instance.getPeriodCount());
+
+  int capacity = 0;
+  for (int r = 0; r < rooms; r++) capacity = std::max(capacity, instance.getRoom(r).capacity);
+  capacities = MatchedCapacities;
+  roomSlack = largest > 0 ? capacity / largest : 1;
+  utilisation = totalLectures / (rooms * instance.getPeriodCount());
+}
+
+
+void GeneratorSettings::scale(double factor) {
+  courses = std::max(1, int(std::floor(courses * factor + 0.5)));
+  if (rooms > 0) rooms = std::max(1, int(std::floor(rooms * factor + 0.5)));
+}
+
+
+// Random numbers, which are the same for a seed on any platform,
+// as the distributions of the standard library are not
+class GeneratorRandom {
+protected:
+  boost::mt19937 engine;
+public:
+  GeneratorRandom(unsigned seed) : engine(seed) {}
+  // In [0, 1)
+  double uniform() { return engine() / 4294967296.0; }
+  // In [0, n)
+  int below(int n) { return std::min(n - 1, int(uniform() * n)); }
+  double normal() {
+    double u = 1 - uniform(), v = uniform();
+    return std::sqrt(-2 * std::log(u)) * std::cos(2 * 3.14159265358979 * v);
+  }
+  // Of the given mean and sigma of the logarithm
+  double lognormal(double mean, double sigma) {
+    return mean * std::exp(sigma * normal() - sigma * sigma / 2);
+  }
+  template <class T> void shuffle(std::vector<T> &v) {
+    for (int i = int(v.size()) - 1; i > 0; i--) std::swap(v[i], v[below(i + 1)]);
+  }
+};
+
+
+static int roundUp(double value, int step) {
+  return step * int(std::ceil(value / step));
+}
+
+
+bool generateInstance(const GeneratorSettings &s, const std::string &name, std::ostream &out) {
+  if (s.courses < 1 || s.days < 1 || s.periodsPerDay < 1) return false;
+  GeneratorRandom random(s.seed);
+  int C = s.courses, P = s.days * s.periodsPerDay;
+  int c, t, u, r, i, k;
+  char label[32];
+
+  // The courses, with as many students as the largest, once in C, should have
+  int largest = int(s.students * s.maxStudents);
+  double z = std::sqrt(2 * std::log(double(std::max(C, 2))));
+  double d = z * z - 2 * std::log(std::max(s.maxStudents, 1.0));
+  double sigma = d > 0 ? z - std::sqrt(d) : z;
+  std::vector<int> lectures(C), minDays(C), students(C);
+  int totalLectures = 0;
+  for (c = 0; c < C; c++) {
+    lectures[c] = int(std::floor(random.lognormal(s.lectures, 0.4) + 0.5));
+    lectures[c] = std::max(1, std::min(lectures[c], P / 2));
+    minDays[c] = int(std::floor(lectures[c] * s.minWorkingDays + 0.5));
+    minDays[c] = std::max(1, std::min(minDays[c], std::min(lectures[c], s.days)));
+    students[c] = int(std::floor(random.lognormal(s.students, sigma) + 0.5));
+    students[c] = std::max(5, std::min(students[c], largest));
+    totalLectures += lectures[c];
+  }
+
+  // The teachers, teaching two or three of the courses shared out, within half of the periods
+  std::vector<int> teacher(C), order(C);
+  for (c = 0; c < C; c++) order[c] = c;
+  random.shuffle(order);
+  int shared = int(std::floor(s.teacherOverlap * C + 0.5));
+  int teachers = 0;
+  std::vector<int> teaches;    // lectures of each teacher
+  for (i = 0; i < C; ) {
+    int size = (i < shared) ? (random.uniform() < 0.75 ? 2 : 3) : 1;
+    teaches.push_back(0);
+    for (k = 0; k < size && i < C; k++, i++) {
+      c = order[i];
+      if (k > 0 && teaches[teachers] + lectures[c] > P / 2) break;
+      teacher[c] = teachers;
+      teaches[teachers] += lectures[c];
+    }
+    teachers += 1;
+  }
+
+  // The curricula, drawn from programmes of a few curricula each, so that they overlap as in the examples,
+  // and with no more lectures than four fifths of the periods
+  int U = std::max(1, int(std::floor(s.curricula * C + 0.5)));
+  int programmeSize = std::max(2, std::min(C, int(3 * s.curriculumSize)));
+  random.shuffle(order);
+  std::vector< std::vector<int> > curricula;
+  for (u = 0; u < U; u++) {
+    int first = random.below(std::max(1, C - programmeSize + 1));
+    std::vector<int> programme(order.begin() + first, order.begin() + std::min(C, first + programmeSize));
+    random.shuffle(programme);
+    int size = int(std::floor(s.curriculumSize + random.normal() + 0.5));
+    size = std::max(1, std::min<int>(size, programme.size()));
+    std::vector<int> curriculum;
+    int load = 0;
+    for (k = 0; k < programme.size() && curriculum.size() < size; k++)
+      if (load + lectures[programme[k]] <= 4 * P / 5) {
+        curriculum.push_back(programme[k]);
+        load += lectures[programme[k]];
+      }
+    std::sort(curriculum.begin(), curriculum.end());
+    curricula.push_back(curriculum);
+  }
+
+  // The periods the teachers are unavailable in, in runs within a day, as in the examples,
+  // leaving each enough periods for all the lectures of the teacher and a day to spare
+  std::vector< std::set<int> > unavailable(teachers);
+  int restrictions = 0;
+  for (t = 0; t < teachers; t++) {
+    int count = int(std::floor(random.uniform() * 2 * s.restrictions * P + 0.5));
+    count = std::min(count, P - teaches[t] - s.periodsPerDay);
+    while (int(unavailable[t].size()) < count) {
+      int day = random.below(s.days);
+      int run = 1 + random.below(s.periodsPerDay);
+      int start = random.below(s.periodsPerDay - run + 1);
+      for (k = start; k < start + run && int(unavailable[t].size()) < count; k++)
+        unavailable[t].insert(day * s.periodsPerDay + k);
+    }
+  }
+  for (c = 0; c < C; c++) restrictions += unavailable[teacher[c]].size();
+
+  // The rooms, enough for the utilisation, with capacities following the courses or not
+  int R = s.rooms > 0 ? s.rooms : std::max(1, int(std::ceil(totalLectures / (P * s.utilisation))));
+  std::vector<int> sizes(students);
+  std::sort(sizes.begin(), sizes.end());
+  std::vector<int> capacities(R);
+  for (r = 0; r < R; r++) {
+    if (s.capacities == UniformCapacities)
+      capacities[r] = roundUp(sizes.front() + random.uniform() * (sizes.back() * s.roomSlack - sizes.front()), 5);
+    else {
+      // The largest room takes the largest course, and the rest the courses of their quantiles
+      int q = (r == 0) ? C - 1 : int((1 - (r + 0.5) / R) * C);
+      capacities[r] = roundUp(sizes[std::max(0, std::min(C - 1, q))] * s.roomSlack, 5);
+    }
+  }
+  std::sort(capacities.begin(), capacities.end());
+
+  out << "Name: " << name << std::endl;
+  out << "Courses: " << C << std::endl;
+  out << "Rooms: " << R << std::endl;
+  out << "Days: " << s.days << std::endl;
+  out << "Periods_per_day: " << s.periodsPerDay << std::endl;
+  out << "Curricula: " << curricula.size() << std::endl;
+  out << "Constraints: " << restrictions << std::endl;
+
+  out << std::endl << "COURSES:" << std::endl;
+  for (c = 0; c < C; c++) {
+    std::sprintf(label, "c%04d t%03d", c, teacher[c]);
+    out << label << " " << lectures[c] << " " << minDays[c] << " " << students[c] << std::endl;
+  }
+
+  out << std::endl << "ROOMS:" << std::endl;
+  for (r = 0; r < R; r++) {
+    std::sprintf(label, "r%03d", r);
+    out << label << " " << capacities[r] << std::endl;
+  }
+
+  out << std::endl << "CURRICULA:" << std::endl;
+  for (u = 0; u < curricula.size(); u++) {
+    std::sprintf(label, "q%03d", u);
+    out << label << " " << curricula[u].size();
+    for (k = 0; k < curricula[u].size(); k++) {
+      std::sprintf(label, "c%04d", curricula[u][k]);
+      out << " " << label;
+    }
+    out << std::endl;
+  }
+
+  out << std::endl << "UNAVAILABILITY_CONSTRAINTS:" << std::endl;
+  for (c = 0; c < C; c++)
+    for (std::set<int>::iterator it = unavailable[teacher[c]].begin(); it != unavailable[teacher[c]].end(); it++) {
+      std::sprintf(label, "c%04d", c);
+      out << label << " " << *it / s.periodsPerDay << " " << *it % s.periodsPerDay << std::endl;
+    }
+
+  out << std::endl << "END." << std::endl;
+  return !out.fail();
+}
@@ -0,0 +1,62 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_GENERATOR
+#define UDINE_GENERATOR
+
+#include <iostream>
+#include <string>
+
+#include "loader.h"
+
+enum CapacityDistribution {
+  MatchedCapacities,    // the rooms follow the sizes of the courses, with some slack
+  UniformCapacities     // the rooms are anywhere between the smallest and the largest
+};
+
+/* What a synthetic instance should look like. The defaults are those of comp07,
+* the largest of the examples: 5 days of 5 periods, 3.3 lectures per course,
+* 0.6 curricula of 3.9 courses per course, 1.3 courses per teacher and a fifth
+* of the periods of each course unavailable.
+*/
+struct GeneratorSettings {
+  int courses;
+  int rooms;                // 0 to fill them to the utilisation
+  int days, periodsPerDay;
+  double lectures;          // per course, on average
+  double minWorkingDays;    // as a share of the lectures
+  double students;          // per course, on average
+  double maxStudents;       // as a multiple of the average
+  double curricula;         // per course
+  double curriculumSize;    // courses per curriculum, on average
+  double teacherOverlap;    // the share of the courses of teachers with more than one
+  double restrictions;      // the share of the periods of a course unavailable
+  int capacities;           // one of CapacityDistribution
+  double roomSlack;         // the largest room as a multiple of the largest course
+  double utilisation;       // of the room-periods by the lectures, if rooms is 0
+  unsigned seed;
+
+  GeneratorSettings();
+
+  // Takes the shape of an instance, e.g. to scale it up
+  void calibrate(TimetablingInstance &instance);
+  // Multiplies the courses and the rooms, keeping the rest of the shape
+  void scale(double factor);
+};
+
+/* Writes a random instance of the given shape in the format of ITC 2007,
+* reproducibly for a given seed on any platform. The instance is built to be
+* feasible, with no curriculum and no teacher with more lectures than periods
+* and rooms for the largest courses, but it is not checked to be.
+*/
+bool generateInstance(const GeneratorSettings &settings, const std::string &name, std::ostream &out);
+
+#endif // UDINE_GENERATOR
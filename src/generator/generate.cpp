@@ -0,0 +1,131 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "loader.h"
+#include "generator.h"
+
+// Generates synthetic instances for scaling studies, shaped like comp07 by default,
+// or like an instance given, scaled up by a factor, e.g. five times comp07:
+//   udine-generate -f examples/comp07.ctt -x 5 -s 1 comp07x5.ctt
+// With a count, writes <count> instances <out>.<seed>.ctt of consecutive seeds, named after them.
+
+int main(int argc, char **argv) {
+  GeneratorSettings settings;
+  GeneratorSettings defaults;
+  std::string from, output, name;
+  double factor = 1;
+  int count = 0;
+
+  // The shape of the instance to calibrate from comes first, with any overrides on top
+  for (int a = 1; a + 1 < argc; a++)
+    if (std::strcmp(argv[a], "-f") == 0) from = argv[a + 1];
+  if (!from.empty()) {
+    TimetablingInstance instance;
+    std::string error;
+    if (!instance.parse(from.c_str(), error)) {
+      std::cerr << "Generator: Cannot read " << from << ": " << error << std::endl;
+      return 1;
+    }
+    settings.calibrate(instance);
+  }
+
+  for (int a = 1; a < argc; a++) {
+    std::string arg(argv[a]);
+    if (arg == "-f" && a + 1 < argc) { a++; continue; }
+    if (arg == "-x" && a + 1 < argc) { factor = std::atof(argv[++a]); continue; }
+    if (arg == "-s" && a + 1 < argc) { settings.seed = std::atoi(argv[++a]); continue; }
+    if (arg == "-n" && a + 1 < argc) { name = argv[++a]; continue; }
+    if (arg == "-c" && a + 1 < argc) { settings.courses = std::atoi(argv[++a]); continue; }
+    if (arg == "-r" && a + 1 < argc) { settings.rooms = std::atoi(argv[++a]); continue; }
+    if (arg == "-d" && a + 1 < argc) { settings.days = std::atoi(argv[++a]); continue; }
+    if (arg == "-p" && a + 1 < argc) { settings.periodsPerDay = std::atoi(argv[++a]); continue; }
+    if (arg == "-l" && a + 1 < argc) { settings.lectures = std::atof(argv[++a]); continue; }
+    if (arg == "-u" && a + 1 < argc) { settings.curricula = std::atof(argv[++a]); continue; }
+    if (arg == "-k" && a + 1 < argc) { settings.curriculumSize = std::atof(argv[++a]); continue; }
+    if (arg == "-t" && a + 1 < argc) { settings.teacherOverlap = std::atof(argv[++a]); continue; }
+    if (arg == "-a" && a + 1 < argc) { settings.restrictions = std::atof(argv[++a]); continue; }
+    if (arg == "-m" && a + 1 < argc) {
+      std::string mode(argv[++a]);
+      settings.capacities = (mode == "uniform") ? UniformCapacities : MatchedCapacities;
+      continue;
+    }
+    if (arg == "-e" && a + 1 < argc) { settings.roomSlack = std::atof(argv[++a]); continue; }
+    if (arg.size() > 1 && arg[0] == '-') {
+      std::cerr << "Generator: Unknown option " << arg << ", or one without its value" << std::endl;
+      return 1;
+    }
+    if (output.empty()) output = arg;
+    else count = std::atoi(arg.c_str());
+  }
+
+  if (output.empty()) {
+    std::cerr << "Usage: " << argv[0] << " [-f <data>] [-x <factor>] [-s <seed>] [-n <name>] [-c <courses>] [-r <rooms>]" << std::endl;
+    std::cerr << "       [-d <days>] [-p <periods>] [-l <lectures>] [-u <curricula>] [-k <size>] [-t <overlap>]" << std::endl;
+    std::cerr << "       [-a <restrictions>] [-m matched|uniform] [-e <slack>] <out> [<count>]" << std::endl;
+    std::cerr << "where: <data> is an instance to take the shape of, comp07 by default, scaled up by <factor>," << std::endl;
+    std::cerr << "       <courses> (" << defaults.courses << ") with <lectures> (" << defaults.lectures
+      << ") each on average, <rooms> (enough for " << defaults.utilisation << " of the periods)," << std::endl;
+    std::cerr << "       <days> (" << defaults.days << ") of <periods> (" << defaults.periodsPerDay << "), <curricula> ("
+      << defaults.curricula << ") per course of <size> (" << defaults.curriculumSize << ") courses," << std::endl;
+    std::cerr << "       a share <overlap> (" << defaults.teacherOverlap << ") of the courses with teachers of several,"
+      << " a share <restrictions> (" << defaults.restrictions << ") of the periods unavailable," << std::endl;
+    std::cerr << "       and rooms which follow the sizes of the courses (matched) or not (uniform)," << std::endl;
+    std::cerr << "       the largest <slack> (" << defaults.roomSlack << ") times the largest course" << std::endl;
+    exit(-1);
+  }
+
+  settings.scale(factor);
+
+  int failures = 0;
+  for (int i = 0; i < std::max(count, 1); i++) {
+    GeneratorSettings these(settings);
+    std::string filename(output);
+    if (count > 0) {
+      these.seed = settings.seed + i;
+      std::ostringstream numbered;
+      numbered << output << "." << these.seed << ".ctt";
+      filename = numbered.str();
+    }
+    // Each instance is named after its own seed, unless named, when the seed is appended with a count
+    std::ostringstream label;
+    if (name.empty()) label << "Synthetic-" << these.courses << "-" << these.seed;
+    else if (count > 0) label << name << "-" << these.seed;
+    else label << name;
+    std::ofstream file(filename.c_str(), std::ofstream::out);
+    if (!file || !generateInstance(these, label.str(), file)) {
+      std::cerr << "Generator: Cannot write " << filename << std::endl;
+      failures += 1;
+      continue;
+    }
+    file.close();
+
+    // Read it back, as a check and for the summary
+    TimetablingInstance instance;
+    std::string error;
+    if (!instance.parse(filename.c_str(), error)) {
+      std::cerr << "Generator: " << filename << " cannot be read back: " << error << std::endl;
+      failures += 1;
+      continue;
+    }
+    std::cout << "Generator: " << filename << ": " << instance.getCourseCount() << " courses, "
+      << instance.getEventCount() << " events, " << instance.getRoomCount() << " rooms, "
+      << instance.getProperCurriculumCount() + instance.getSingletonCurriculumCount() << " curricula, "
+      << instance.getRestrictionCount() << " constraints" << std::endl;
+  }
+  return failures > 0 ? 1 : 0;
+}
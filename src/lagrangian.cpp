@@ -0,0 +1,318 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "lagrangian.h"
+
+const double infinity = 1e9;
+
+
+LagrangianBound::LagrangianBound(TimetablingInstance &i, int t)
+: instance(i), P(i.getPeriodCount()), R(i.getRoomCount()), C(i.getCourseCount()),
+U(i.getCurriculumCount()), D(i.getDayCount()), ppd(i.getPeriodsPerDayCount()),
+threads(std::max(1, t)), bestBound(-infinity) {
+
+  int c, r, u, f;
+  capacityPenalties.resize(C * R);
+  for (c = 0; c < C; c++)
+    for (r = 0; r < R; r++)
+      capacityPenalties[c * R + r] = std::max(0, i.getCourse(c).students - i.getRoom(r).capacity);
+  available.assign(C * P, 1);
+  for (f = 0; f < i.getRestrictionCount(); f++)
+    available[i.getRestriction(f).courseId * P + i.getRestriction(f).period] = 0;
+  courseCurricula.resize(C);
+  for (u = 0; u < U; u++)
+    for (c = 0; c < i.getCurriculum(u).courseIds.size(); c++)
+      courseCurricula[i.getCurriculum(u).courseIds[c]].push_back(u);
+
+  curriculumMultipliers.assign(U * P, 0);
+  roomMultipliers.assign(P * R, 0);
+  bestCurriculumMultipliers = curriculumMultipliers;
+  bestRoomMultipliers = roomMultipliers;
+  courseValues.assign(C, 0);
+  courseLectures.resize(C);
+}
+
+
+double LagrangianBound::getCost(int c, int p, int r) const {
+  double cost = capacityPenalties[c * R + r] + roomMultipliers[p * R + r];
+  for (std::vector<int>::const_iterator u = courseCurricula[c].begin(); u != courseCurricula[c].end(); u++)
+    cost += curriculumMultipliers[*u * P + p];
+  return cost;
+}
+
+
+double LagrangianBound::choosePeriods(int c, const std::vector<double> &costs,
+                                      std::vector<int> *periods, int fixedPeriod) const {
+  int L = instance.getCourse(c).lectures;
+  int M = instance.getCourse(c).minWorkingDays;
+  int S = (M + 1) * (L + 1);
+  int d, j, k, m, pd;
+
+  // The periods of each day, cheapest first, with the fixed one, if any, in front
+  std::vector< std::vector< std::pair<double, int> > > byDay(D);
+  for (d = 0; d < D; d++) {
+    for (pd = 0; pd < ppd; pd++) {
+      int p = d * ppd + pd;
+      if (available[c * P + p] && p != fixedPeriod) byDay[d].push_back(std::make_pair(costs[p], p));
+    }
+    std::sort(byDay[d].begin(), byDay[d].end());
+    if (fixedPeriod >= 0 && fixedPeriod / ppd == d)
+      byDay[d].insert(byDay[d].begin(), std::make_pair(costs[fixedPeriod], fixedPeriod));
+  }
+
+  // best[k * (M + 1) + m]: k lectures on m days so far (at most M counted), after each day
+  std::vector<double> best(S, infinity), next(S);
+  std::vector<int> choices(D * S, -1);
+  best[0] = 0;
+  for (d = 0; d < D; d++) {
+    bool fixedToday = (fixedPeriod >= 0 && fixedPeriod / ppd == d);
+    std::fill(next.begin(), next.end(), infinity);
+    for (k = 0; k <= L; k++)
+      for (m = 0; m <= M; m++) {
+        if (best[k * (M + 1) + m] >= infinity) continue;
+        double sum = 0;
+        for (j = 0; j <= byDay[d].size() && k + j <= L; j++) {
+          if (j > 0) sum += byDay[d][j - 1].first;
+          if (j == 0 && fixedToday) continue;
+          int to = (k + j) * (M + 1) + std::min(M, m + (j > 0 ? 1 : 0));
+          double value = best[k * (M + 1) + m] + sum;
+          if (value < next[to]) {
+            next[to] = value;
+            choices[d * S + to] = j * (M + 1) + m;
+          }
+        }
+      }
+    best.swap(next);
+  }
+
+  int last = -1;
+  double value = infinity;
+  for (m = 0; m <= M; m++)
+    if (best[L * (M + 1) + m] < infinity && best[L * (M + 1) + m] + 5 * (M - m) < value) {
+      value = best[L * (M + 1) + m] + 5 * (M - m);
+      last = L * (M + 1) + m;
+    }
+
+  if (periods && last >= 0) {
+    periods->clear();
+    for (d = D - 1; d >= 0; d--) {
+      int choice = choices[d * S + last];
+      j = choice / (M + 1);
+      for (k = 0; k < j; k++) periods->push_back(byDay[d][k].second);
+      last = (last / (M + 1) - j) * (M + 1) + choice % (M + 1);
+    }
+  }
+  return value;
+}
+
+
+double LagrangianBound::solveCourse(int c, Lectures *lectures, int fixedPeriod, int fixedRoom) const {
+  int L = instance.getCourse(c).lectures;
+  int p, r;
+  if (lectures) lectures->clear();
+  if (L == 0) return 0;
+
+  // Any rooms, with the cheapest room in each period
+  std::vector<double> costs(P, infinity);
+  std::vector<int> rooms(P, -1);
+  for (p = 0; p < P; p++) {
+    if (!available[c * P + p]) continue;
+    for (r = 0; r < R; r++) {
+      double cost = getCost(c, p, r);
+      if (cost < costs[p]) { costs[p] = cost; rooms[p] = r; }
+    }
+  }
+  if (fixedPeriod >= 0) {
+    costs[fixedPeriod] = getCost(c, fixedPeriod, fixedRoom);
+    rooms[fixedPeriod] = fixedRoom;
+  }
+  std::vector<int> periods;
+  double anyRooms = choosePeriods(c, costs, &periods, fixedPeriod);
+  if (L < 2 || anyRooms >= infinity) {
+    if (lectures)
+      for (p = 0; p < periods.size(); p++) {
+        Lecture l; l.course = c; l.period = periods[p]; l.room = rooms[periods[p]];
+        lectures->push_back(l);
+      }
+    return anyRooms;
+  }
+
+  // A single room, unless it cannot beat any rooms with the penalty of one
+  double value = anyRooms + 1;
+  int bestRoom = -1;
+  std::vector<double> single(P);
+  std::vector<double> sorted;
+  for (r = 0; r < R; r++) {
+    if (fixedRoom >= 0 && r != fixedRoom) continue;
+    sorted.clear();
+    for (p = 0; p < P; p++) {
+      single[p] = available[c * P + p] ? getCost(c, p, r) : infinity;
+      if (p != fixedPeriod) sorted.push_back(single[p]);
+    }
+    double lower = (fixedPeriod >= 0) ? single[fixedPeriod] : 0;
+    int n = (fixedPeriod >= 0) ? L - 1 : L;
+    if (n > sorted.size()) continue;
+    if (n > 0) {
+      std::nth_element(sorted.begin(), sorted.begin() + n - 1, sorted.end());
+      for (p = 0; p < n; p++) lower += sorted[p];
+    }
+    if (lower >= value) continue;
+    double v = choosePeriods(c, single, 0, fixedPeriod);
+    if (v < value) { value = v; bestRoom = r; }
+  }
+
+  if (lectures) {
+    if (bestRoom >= 0) {
+      for (p = 0; p < P; p++) single[p] = available[c * P + p] ? getCost(c, p, bestRoom) : infinity;
+      choosePeriods(c, single, &periods, fixedPeriod);
+    }
+    for (p = 0; p < periods.size(); p++) {
+      Lecture l; l.course = c; l.period = periods[p];
+      l.room = (bestRoom >= 0) ? bestRoom : rooms[periods[p]];
+      lectures->push_back(l);
+    }
+  }
+  return value;
+}
+
+
+void LagrangianBound::solveCourses(int first, int step) {
+  for (int c = first; c < C; c += step)
+    courseValues[c] = solveCourse(c, &courseLectures[c]);
+}
+
+
+double LagrangianBound::evaluate() {
+  double value = 0;
+  int k;
+  for (k = 0; k < C; k++) value += courseValues[k];
+  for (k = 0; k < curriculumMultipliers.size(); k++) value -= curriculumMultipliers[k];
+  for (k = 0; k < roomMultipliers.size(); k++) value -= roomMultipliers[k];
+  return value;
+}
+
+
+// Solves a share of the subproblems in each round, while the main thread waits
+struct SubproblemWorker {
+  LagrangianBound *bound;
+  void (LagrangianBound::*solve)(int, int);
+  int first, step;
+  boost::barrier *start, *finish;
+  bool *stopping;
+  void operator()() {
+    while (true) {
+      start->wait();
+      if (*stopping) return;
+      (bound->*solve)(first, step);
+      finish->wait();
+    }
+  }
+};
+
+
+int LagrangianBound::solve(int upperBound, int iterations, double timeLimit) {
+  boost::system_time deadline = boost::get_system_time()
+    + boost::posix_time::milliseconds(long(timeLimit * 1000));
+  boost::barrier start(threads), finish(threads);
+  bool stopping = false;
+  boost::thread_group group;
+  for (int t = 1; t < threads; t++) {
+    SubproblemWorker worker = { this, &LagrangianBound::solveCourses, t, threads, &start, &finish, &stopping };
+    group.create_thread(worker);
+  }
+
+  std::vector<int> curriculumLoads(U * P), roomLoads(P * R);
+  double theta = 2;
+  int sinceImprovement = 0;
+  for (int it = 0; it < iterations; it++) {
+    if (threads > 1) start.wait();
+    solveCourses(0, threads);
+    if (threads > 1) finish.wait();
+
+    double value = evaluate();
+    if (value > bestBound + 1e-6) {
+      bestBound = value;
+      bestCurriculumMultipliers = curriculumMultipliers;
+      bestRoomMultipliers = roomMultipliers;
+      sinceImprovement = 0;
+    } else if (++sinceImprovement >= 100) {
+      theta /= 2;
+      sinceImprovement = 0;
+    }
+    if (bestBound >= infinity) break;
+    if (upperBound >= 0 && std::ceil(bestBound - 1e-6) >= upperBound) break;
+    if (theta < 1e-4 || boost::get_system_time() > deadline) break;
+
+    // The subgradient, projected onto the non-negative multipliers
+    std::fill(curriculumLoads.begin(), curriculumLoads.end(), -1);
+    std::fill(roomLoads.begin(), roomLoads.end(), -1);
+    for (int c = 0; c < C; c++)
+      for (Lectures::const_iterator l = courseLectures[c].begin(); l != courseLectures[c].end(); l++) {
+        roomLoads[l->period * R + l->room] += 1;
+        for (std::vector<int>::const_iterator u = courseCurricula[c].begin(); u != courseCurricula[c].end(); u++)
+          curriculumLoads[*u * P + l->period] += 1;
+      }
+    double norm = 0;
+    int k;
+    for (k = 0; k < curriculumLoads.size(); k++)
+      if (curriculumLoads[k] > 0 || curriculumMultipliers[k] > 0) norm += curriculumLoads[k] * curriculumLoads[k];
+    for (k = 0; k < roomLoads.size(); k++)
+      if (roomLoads[k] > 0 || roomMultipliers[k] > 0) norm += roomLoads[k] * roomLoads[k];
+    // No dualised row is violated or slack with a positive multiplier: the bound is optimal
+    if (norm == 0) break;
+
+    double target = (upperBound >= 0) ? upperBound : 1.05 * std::fabs(bestBound) + 1;
+    double step = theta * std::max(1.0, target - value) / norm;
+    for (k = 0; k < curriculumLoads.size(); k++)
+      curriculumMultipliers[k] = std::max(0.0, curriculumMultipliers[k] + step * curriculumLoads[k]);
+    for (k = 0; k < roomLoads.size(); k++)
+      roomMultipliers[k] = std::max(0.0, roomMultipliers[k] + step * roomLoads[k]);
+  }
+
+  if (threads > 1) {
+    stopping = true;
+    start.wait();
+    group.join_all();
+  }
+  curriculumMultipliers = bestCurriculumMultipliers;
+  roomMultipliers = bestRoomMultipliers;
+  return (bestBound >= infinity) ? int(infinity) : int(std::ceil(bestBound - 1e-6));
+}
+
+
+void LagrangianBound::getFixings(int upperBound, Lectures &fixedToZero) {
+  int c, p, r;
+  fixedToZero.clear();
+  curriculumMultipliers = bestCurriculumMultipliers;
+  roomMultipliers = bestRoomMultipliers;
+  solveCourses(0, 1);
+  double value = evaluate();
+  for (c = 0; c < C; c++)
+    for (p = 0; p < P; p++) {
+      if (!available[c * P + p]) continue;
+      for (r = 0; r < R; r++) {
+        double forced = value - courseValues[c] + solveCourse(c, 0, p, r);
+        if (std::ceil(forced - 1e-6) > upperBound) {
+          Lecture l; l.course = c; l.period = p; l.room = r;
+          fixedToZero.push_back(l);
+        }
+      }
+    }
+}
@@ -0,0 +1,75 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_LAGRANGIAN
+#define UDINE_LAGRANGIAN
+
+#include <vector>
+
+#include "loader.h"
+#include "timetable.h"
+
+/* A lower bound obtained by dualising the rows "at most one lecture per room
+* and period" and "at most one lecture per curriculum and period" of the model,
+* including the teachers' curricula. What remains decomposes into a subproblem
+* per course: to pick the periods and rooms of its lectures, one per period,
+* so as to minimise the room capacity, min working days and room stability
+* penalties plus the multipliers. This is solved exactly by a small DP over
+* days, both for a single room and for any rooms with the room stability
+* penalty of one, which is a lower bound whenever two or more rooms are used.
+* Isolated lectures, which couple the courses of a curriculum, are left out,
+* so that the bound of this relaxation can be added to that of getLowerBounds().
+* The multipliers are updated by subgradient steps with Polyak's step length,
+* with the subproblems solved in parallel.
+*/
+class LagrangianBound {
+protected:
+  TimetablingInstance &instance;
+  int P, R, C, U, D, ppd;
+  int threads;
+
+  std::vector<int> capacityPenalties;               // course x room
+  std::vector<char> available;                      // course x period
+  std::vector< std::vector<int> > courseCurricula;  // the curricula of each course
+
+  // The multipliers of the curriculum (curriculum x period) and room (period x room) rows
+  std::vector<double> curriculumMultipliers, roomMultipliers;
+  std::vector<double> bestCurriculumMultipliers, bestRoomMultipliers;
+  double bestBound;
+
+  // The current solutions of the subproblems
+  std::vector<double> courseValues;
+  std::vector<Lectures> courseLectures;
+
+  // Solves the subproblem of a course, possibly with a lecture fixed at the given period and room
+  double solveCourse(int c, Lectures *lectures, int fixedPeriod = -1, int fixedRoom = -1) const;
+  // Chooses the periods of the lectures of a course, given the cost of each period
+  double choosePeriods(int c, const std::vector<double> &costs, std::vector<int> *periods, int fixedPeriod) const;
+  double getCost(int c, int p, int r) const;
+
+  void solveCourses(int first, int step);
+  double evaluate();
+
+public:
+  LagrangianBound(TimetablingInstance &i, int threads = 1);
+
+  // Runs subgradient optimisation and returns the bound, rounded up;
+  // the upper bound, if known, is used in the step length and to stop early
+  int solve(int upperBound = -1, int iterations = 2000, double timeLimit = 10);
+  double getBound() const { return bestBound; }
+
+  // Lists the x[p][r][c] that are 0 in any timetable of cost at most upperBound,
+  // as the bound of the relaxation with x[p][r][c] = 1 exceeds it, given the best multipliers;
+  // any bound on the isolated lectures should be subtracted from upperBound beforehand
+  void getFixings(int upperBound, Lectures &fixedToZero);
+};
+
+#endif // UDINE_LAGRANGIAN
@@ -14,13 +14,16 @@
 #include <cassert>
 #include <iostream>
 #include <iterator>
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <set>
 #include <map>
 // #include <boost/regex.hpp>
 
 #include "loader.h"
+#include "tokenizer.h"
 
 
 void loadFile(std::string& s, std::istream& is) {
@@ -57,137 +60,330 @@ bool TimetablingInstance::check(const char *filename) {
 }
 
 
-std::istream& operator>>(std::istream &is, Course &c) {
-  return is >> c.name >> c.teacher >> c.lectures >> c.minWorkingDays >> c.students;
+// Reads "<label> <value>", e.g. "Courses: 30", from the header
+bool readHeader(Tokenizer &tokens, int &value) {
+  Token t;
+  return tokens.next(t) && tokens.next(t) && t.toInt(value) && value >= 0;
 }
 
 
-void TimetablingInstance::load(const char *thisFilename) {
-  try {
-    std::ifstream file;
-    assert(check(thisFilename));
-    file.open(thisFilename, std::ifstream::in);    
-    filename = thisFilename;
-
-    std::string forget; int i;
-
-    std::string iname;
-    int courseCnt, roomCnt, dayCnt, curriculumCnt, constraintCnt;
-
-    // load the header
-    file >> forget >> iname; 
-    file >> forget >> courseCnt; eventCnt = 0;
-    file >> forget >> roomCnt;
-    file >> forget >> dayCnt;
-    file >> forget >> periodsPerDay;
-    file >> forget >> curriculumCnt;
-    file >> forget >> constraintCnt;
-
-    periods = dayCnt * periodsPerDay;
-    days = dayCnt;
-    checks = periodsPerDay;
-    origCurricula = curriculumCnt;
-
-    std::cout << "Loader: Instance " << iname << " (" << filename << ")"<< std::endl; 
-
-    // courses
-    file >> forget;
-    for (i = 0; i < courseCnt; i++) {
-      Course c;
-      assert(file.good());
-      file >> c;
-      eventCnt += c.lectures;
-      cnames[c.name] = courses.size();
-      courses.push_back(c);
+bool TimetablingInstance::parse(const char *thisFilename, std::string &error) {
+  Tokenizer tokens;
+  if (!tokens.open(thisFilename)) {
+    error = "cannot open the instance";
+    return false;
+  }
+  filename = thisFilename;
+  courses.clear(); cnames.clear();
+  rooms.clear(); rnames.clear();
+  curricula.clear(); singletons.clear(); conflicts.clear();
+  restrict.clear(); patterns.clear();
+
+  Token t;
+  int i, j;
+  int courseCnt, roomCnt, dayCnt, curriculumCnt, constraintCnt;
+
+  // load the header
+  if (!tokens.next(t) || !tokens.next(t)) { error = "no header"; return false; }
+  name = t.str();
+  if (!readHeader(tokens, courseCnt) || !readHeader(tokens, roomCnt)
+    || !readHeader(tokens, dayCnt) || !readHeader(tokens, periodsPerDay)
+    || !readHeader(tokens, curriculumCnt) || !readHeader(tokens, constraintCnt)) {
+      error = "malformed header";
+      return false;
+  }
+  if (dayCnt < 1 || periodsPerDay < 1) { error = "no periods"; return false; }
+
+  periods = dayCnt * periodsPerDay;
+  days = dayCnt;
+  checks = periodsPerDay;
+  eventCnt = 0;
+
+  // courses
+  tokens.next(t);
+  for (i = 0; i < courseCnt; i++) {
+    Course c;
+    Token n, teacher;
+    if (!tokens.next(n) || !tokens.next(teacher)
+      || !tokens.next(t) || !t.toInt(c.lectures)
+      || !tokens.next(t) || !t.toInt(c.minWorkingDays)
+      || !tokens.next(t) || !t.toInt(c.students)) {
+        error = "incomplete list of courses";
+        return false;
     }
+    c.name = n.str();
+    c.teacher = teacher.str();
+    eventCnt += c.lectures;
+    cnames[c.name] = courses.size();
+    courses.push_back(c);
+  }
 
-    // rooms and their capacities
-    file >> forget;
-    for (i = 0; i < roomCnt; i++) {
-      std::string name; int capacity;
-      assert(file.good());
-      file >> name >> capacity;
-      Room r;
-      r.capacity = capacity;
-      r.name = name;
-      rnames[name] = rooms.size();
-      // std::cout << "Room: " << name << rnames[name] << std::endl;
-      rooms.push_back(r);
+  // rooms and their capacities
+  tokens.next(t);
+  for (i = 0; i < roomCnt; i++) {
+    Room r;
+    Token n;
+    if (!tokens.next(n) || !tokens.next(t) || !t.toInt(r.capacity)) {
+      error = "incomplete list of rooms";
+      return false;
     }
+    r.name = n.str();
+    rnames[r.name] = rooms.size();
+    rooms.push_back(r);
+  }
 
-    // groups of conflicting courses
-    file >> forget;
-    for (i = 0; i < curriculumCnt; i++) {
-      Curriculum u; int ccount;
-      file >> u.name >> ccount;
-      for (int j = 0; j < ccount; j++) {
-        std::string s;
-        assert(file.good());
-        file >> s;
-        assert(cnames.find(s) != cnames.end());
-        u.courseIds.push_back(cnames.find(s)->second);
-      }
-      if (ccount >= 2) curricula.push_back(u);
+  // groups of conflicting courses
+  tokens.next(t);
+  for (i = 0; i < curriculumCnt; i++) {
+    Curriculum u; int ccount;
+    Token n;
+    if (!tokens.next(n) || !tokens.next(t) || !t.toInt(ccount)) {
+      error = "incomplete list of curricula";
+      return false;
     }
-    origCurricula = curricula.size();
-
-    // restrictions on times when teachers are available
-    file >> forget;
-    for (i = 0; i < constraintCnt; i++) {
-      std::string cname; int day; int period;
-      assert(file.good());
-      file >> cname >> day >> period;
-      Restriction r;
-      assert(cnames.find(cname) != cnames.end());
-      r.courseId = cnames.find(cname)->second;
-      r.period = day * periodsPerDay + period;
-      restrict.push_back(r);
+    u.name = n.str();
+    for (j = 0; j < ccount; j++) {
+      if (!tokens.next(t)) { error = "incomplete curriculum " + u.name; return false; }
+      std::map< std::string, int, std::less<std::string> >::iterator it = cnames.find(t.str());
+      if (it == cnames.end()) { error = "unknown course " + t.str() + " in curriculum " + u.name; return false; }
+      u.courseIds.push_back(it->second);
     }
+    if (ccount >= 2) curricula.push_back(u);
+    else singletons.push_back(u);
+  }
+  origCurricula = curricula.size();
 
-    // make an overview of who teaches what
-    typedef std::map< std::string, std::vector<int>, std::less<std::string> > s2veci;
-    s2veci tnames;
-    std::vector<Course>::iterator it = courses.begin();
-    for (i = 0; it != courses.end(); it++, i++) {
-      if (tnames.find(it->teacher) == tnames.end()) {
-        std::vector<int> teaches;
-        teaches.push_back(i);
-        tnames[it->teacher] = teaches;
-      } else {
-        tnames.find(it->teacher)->second.push_back(i);
-      }
-    }
-    // look for teachers teaching more than a single course 
-    s2veci::iterator mapit = tnames.begin();
-    for (; mapit != tnames.end(); mapit++) {
-      if (mapit->second.size() > 1) {
-        // create artificial curricula out of this
-        Curriculum c;
-        c.courseIds = mapit->second;
-        c.name = mapit->first;
-        curricula.push_back(c);
-      }
+  // restrictions on times when teachers are available
+  tokens.next(t);
+  for (i = 0; i < constraintCnt; i++) {
+    Token cname;
+    int day, period;
+    if (!tokens.next(cname) || !tokens.next(t) || !t.toInt(day) || !tokens.next(t) || !t.toInt(period)) {
+      error = "incomplete list of constraints";
+      return false;
     }
+    std::map< std::string, int, std::less<std::string> >::iterator it = cnames.find(cname.str());
+    if (it == cnames.end()) { error = "unknown course " + cname.str() + " in constraints"; return false; }
+    if (day < 0 || day >= days || period < 0 || period >= periodsPerDay) { error = "constraint out of range"; return false; }
+    Restriction r;
+    r.courseId = it->second;
+    r.period = day * periodsPerDay + period;
+    restrict.push_back(r);
+  }
 
-    if (file.bad()) {
-      std::cout << "Loader: Instance incomplete!" << std::endl; 
-      abort();
+  // make an overview of who teaches what
+  typedef std::map< std::string, std::vector<int>, std::less<std::string> > s2veci;
+  s2veci tnames;
+  std::vector<Course>::iterator it = courses.begin();
+  for (i = 0; it != courses.end(); it++, i++) {
+    if (tnames.find(it->teacher) == tnames.end()) {
+      std::vector<int> teaches;
+      teaches.push_back(i);
+      tnames[it->teacher] = teaches;
     } else {
-      std::cout << "Loader: " << courseCnt << " courses, ";
-      std::cout << eventCnt << " events, and ";
-      std::cout << curriculumCnt << " curricula" << std::endl; 
+      tnames.find(it->teacher)->second.push_back(i);
     }
+  }
+  // look for teachers teaching more than a single course 
+  s2veci::iterator mapit = tnames.begin();
+  for (; mapit != tnames.end(); mapit++) {
+    if (mapit->second.size() > 1) {
+      // create artificial curricula out of this
+      Curriculum c;
+      c.courseIds = mapit->second;
+      c.name = mapit->first;
+      curricula.push_back(c);
+    }
+  }
+  conflicts = curricula;
+
+  return true;
+}  // END of TimetablingInstance::parse
 
-    file.close();
 
-  } catch (std::exception &e) {
-    std::cerr << "Loader: There was an error reading the instance!" << std::endl;
-    std::cerr << "Exception says: " << e.what() << std::endl;
+void TimetablingInstance::load(const char *thisFilename) {
+  assert(check(thisFilename));
+  std::string error;
+  if (!parse(thisFilename, error)) {
+    std::cerr << "Loader: There was an error reading the instance " << thisFilename << "!" << std::endl;
+    std::cerr << "Loader: " << error << std::endl;
     abort();
   }
+  std::cout << "Loader: Instance " << name << " (" << filename << ")"<< std::endl; 
+  std::cout << "Loader: " << getCourseCount() << " courses, ";
+  std::cout << eventCnt << " events, and ";
+  std::cout << getProperCurriculumCount() + getSingletonCurriculumCount() << " curricula" << std::endl; 
 }  // END of TimetablingInstance::load
 
 
+bool TimetablingInstance::write(const char *thisFilename, int copies) {
+  std::ofstream file(thisFilename, std::ofstream::out);
+  if (!file) return false;
+
+  // The suffix tells the copies apart, unless there is just the one
+  std::vector<std::string> suffixes(copies, "");
+  int k, i, j;
+  for (k = 0; copies > 1 && k < copies; k++) {
+    std::ostringstream suffix;
+    suffix << "x" << k;
+    suffixes[k] = suffix.str();
+  }
+
+  file << "Name: " << name;
+  if (copies > 1) file << "x" << copies;
+  file << std::endl;
+  file << "Courses: " << copies * courses.size() << std::endl;
+  file << "Rooms: " << copies * rooms.size() << std::endl;
+  file << "Days: " << days << std::endl;
+  file << "Periods_per_day: " << periodsPerDay << std::endl;
+  file << "Curricula: " << copies * (origCurricula + singletons.size()) << std::endl;
+  file << "Constraints: " << copies * restrict.size() << std::endl;
+
+  file << std::endl << "COURSES:" << std::endl;
+  for (k = 0; k < copies; k++)
+    for (i = 0; i < courses.size(); i++)
+      file << courses[i].name << suffixes[k] << " " << courses[i].teacher << suffixes[k] << " " << courses[i].lectures
+        << " " << courses[i].minWorkingDays << " " << courses[i].students << std::endl;
+
+  file << std::endl << "ROOMS:" << std::endl;
+  for (k = 0; k < copies; k++)
+    for (i = 0; i < rooms.size(); i++)
+      file << rooms[i].name << suffixes[k] << " " << rooms[i].capacity << std::endl;
+
+  // The curricula as read, leaving out the auxiliary ones of the teachers
+  file << std::endl << "CURRICULA:" << std::endl;
+  for (k = 0; k < copies; k++)
+    for (i = 0; i < origCurricula + singletons.size(); i++) {
+      const Curriculum &u = (i < origCurricula) ? curricula[i] : singletons[i - origCurricula];
+      file << u.name << suffixes[k] << " " << u.courseIds.size();
+      for (j = 0; j < u.courseIds.size(); j++) file << " " << courses[u.courseIds[j]].name << suffixes[k];
+      file << std::endl;
+    }
+
+  file << std::endl << "UNAVAILABILITY_CONSTRAINTS:" << std::endl;
+  for (k = 0; k < copies; k++)
+    for (i = 0; i < restrict.size(); i++)
+      file << courses[restrict[i].courseId].name << suffixes[k] << " " << restrict[i].period / periodsPerDay
+        << " " << restrict[i].period % periodsPerDay << std::endl;
+
+  file << std::endl << "END." << std::endl;
+  return !file.fail();
+}  // END of TimetablingInstance::write
+
+
+static const char *conflictReductionNames[ConflictReductionCount] = { "curricula", "dominance", "cover" };
+
+
+const char *getConflictReductionName(int reduction) {
+  return (reduction >= 0 && reduction < ConflictReductionCount) ? conflictReductionNames[reduction] : "unknown";
+}
+
+
+bool getConflictReductionByName(const std::string &name, int &reduction) {
+  for (int k = 0; k < ConflictReductionCount; k++)
+    if (name == conflictReductionNames[k]) {
+      reduction = k;
+      return true;
+    }
+  return false;
+}
+
+
+// The number of the edges of the conflict graph within a clique
+static int getEdgeCount(const CourseIds &clique) {
+  return clique.size() * (clique.size() - 1) / 2;
+}
+
+
+int TimetablingInstance::reduceConflicts(int reduction) {
+  if (reduction != DominanceConflicts && reduction != CoverConflicts) {
+    conflicts = curricula;
+    return conflicts.size();
+  }
+  int C = courses.size();
+  int u, v, k, l, c;
+
+  // The curricula as sets, smallest first, as a course might be listed twice
+  std::vector< std::pair<int, CourseIds> > sets;
+  for (u = 0; u < curricula.size(); u++) {
+    CourseIds ids(curricula[u].courseIds);
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    if (ids.size() >= 2) sets.push_back(std::make_pair(ids.size(), ids));
+  }
+  std::sort(sets.begin(), sets.end());
+
+  std::vector<CourseIds> cliques;
+  if (reduction == DominanceConflicts) {
+    // Leave out the curricula within a larger one or equal to a later one
+    for (u = 0; u < sets.size(); u++) {
+      bool dominated = false;
+      for (v = u + 1; v < sets.size() && !dominated; v++)
+        dominated = std::includes(sets[v].second.begin(), sets[v].second.end(), sets[u].second.begin(), sets[u].second.end());
+      if (!dominated) cliques.push_back(sets[u].second);
+    }
+  } else {
+    std::vector< std::set<int> > adj(C);
+    for (u = 0; u < sets.size(); u++)
+      for (k = 0; k < sets[u].second.size(); k++)
+        for (l = 0; l < sets[u].second.size(); l++)
+          if (k != l) adj[sets[u].second[k]].insert(sets[u].second[l]);
+
+    // Extend each curriculum by the courses in conflict with all of it, which makes the
+    // cliques maximal and any curriculum within another one equal to it
+    std::set<CourseIds> maximal;
+    for (u = 0; u < sets.size(); u++) {
+      CourseIds clique(sets[u].second);
+      const std::set<int> &candidates = adj[clique.front()];
+      for (std::set<int>::const_iterator it = candidates.begin(); it != candidates.end(); it++) {
+        bool adjacent = true;
+        for (k = 0; k < clique.size() && adjacent; k++)
+          adjacent = clique[k] != *it && adj[clique[k]].count(*it) > 0;
+        if (adjacent) clique.push_back(*it);
+      }
+      std::sort(clique.begin(), clique.end());
+      maximal.insert(clique);
+    }
+
+    // Leave out the cliques the edges of which the rest cover, smallest first
+    std::vector< std::pair<int, CourseIds> > bySize;
+    for (std::set<CourseIds>::const_iterator it = maximal.begin(); it != maximal.end(); it++)
+      bySize.push_back(std::make_pair(getEdgeCount(*it), *it));
+    std::sort(bySize.begin(), bySize.end());
+    std::map< std::pair<int, int>, int > covered;
+    for (u = 0; u < bySize.size(); u++)
+      for (k = 0; k < bySize[u].second.size(); k++)
+        for (l = k + 1; l < bySize[u].second.size(); l++)
+          covered[std::make_pair(bySize[u].second[k], bySize[u].second[l])] += 1;
+    for (u = 0; u < bySize.size(); u++) {
+      const CourseIds &clique = bySize[u].second;
+      bool redundant = true;
+      for (k = 0; k < clique.size() && redundant; k++)
+        for (l = k + 1; l < clique.size() && redundant; l++)
+          redundant = covered[std::make_pair(clique[k], clique[l])] >= 2;
+      if (!redundant) {
+        cliques.push_back(clique);
+        continue;
+      }
+      for (k = 0; k < clique.size(); k++)
+        for (l = k + 1; l < clique.size(); l++)
+          covered[std::make_pair(clique[k], clique[l])] -= 1;
+    }
+  }
+
+  conflicts.clear();
+  for (c = 0; c < cliques.size(); c++) {
+    std::ostringstream name;
+    name << "clique" << c;
+    Curriculum conflict;
+    conflict.name = name.str();
+    conflict.courseIds = cliques[c];
+    conflicts.push_back(conflict);
+  }
+  return conflicts.size();
+}  // END of TimetablingInstance::reduceConflicts
+
+
 // NOTE: Does not support the trivial cases of days of less than three periods
 void TimetablingInstance::generatePatterns(int toAdd, int rhs, std::vector<int> pat) {
 
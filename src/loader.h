@@ -48,13 +48,24 @@ struct Restriction {
 };
 typedef std::vector<Restriction> Restrictions;
 
+// What the rows of the hard conflicts in each period are generated for
+enum ConflictReduction {
+  CurriculaConflicts,   // the curricula, including those of the teachers
+  DominanceConflicts,   // the curricula, leaving out duplicates and those within another
+  CoverConflicts,       // maximal cliques of the conflict graph, of which none can be left out
+  ConflictReductionCount
+};
+
+const char *getConflictReductionName(int reduction);
+bool getConflictReductionByName(const std::string &name, int &reduction);
+
 // For pattern cuts
 struct Pattern { std::vector<int> coefs; int penalty; int rhs; };
 typedef std::vector<Pattern> PatternDB;
 
 class TimetablingInstance {
 protected:
-  std::string filename;
+  std::string filename, name;
   int periods, periodsPerDay, days, checks, eventCnt;
 
   Courses courses;
@@ -65,6 +76,8 @@ protected:
 
   int origCurricula;  // the number of the original curricula, without auxiliaries
   Curricula curricula;
+  Curricula singletons;  // curricula of a single course, which are left out of the model
+  Curricula conflicts;   // cliques of courses, which cover the conflicts of the curricula
   Restrictions restrict;
   PatternDB patterns;
 
@@ -73,9 +86,22 @@ protected:
 
 public:
   bool check(const char *filename);
+  // Reads an instance without any output; returns false with a message on errors
+  bool parse(const char *filename, std::string &error);
+  // Reads an instance, reporting on it, and aborts on errors
   void load(const char *filename);
+  // Writes the instance in the format it is read in, as the given number of disjoint copies,
+  // each with courses, teachers, rooms and curricula of its own, e.g. to scale it up
+  bool write(const char *filename, int copies = 1);
+  /* Replaces the cliques the hard conflicts in each period are generated for, which are
+  * the curricula as read. Any clique of the conflict graph gives a valid row, and those
+  * covering each of its edges give the timetables of the curricula, while the penalties
+  * are still counted for the curricula. Returns the number of the cliques.
+  */
+  int reduceConflicts(int reduction);
 
   std::string getFilename() { return filename; } 
+  std::string getName() { return name; }
   int getPeriodCount() { return periods; }
   int getDayCount() { return days; }
   int getPeriodsPerDayCount() { return periodsPerDay; }
@@ -84,16 +110,30 @@ public:
   int getEventCount() { return eventCnt; } 
   int getProperCurriculumCount() { return origCurricula; }
   int getCurriculumCount() { return curricula.size(); }
+  int getSingletonCurriculumCount() { return singletons.size(); }
+  int getConflictCount() { return conflicts.size(); }
   int getRoomCount() { return rooms.size(); }
   int getRestrictionCount() { return restrict.size(); }
   const Course & getCourse(int i) { assert(i >= 0 && i < courses.size());  return courses.at(i); }
   const Curriculum & getCurriculum(int i) { assert(i >= 0 && i < curricula.size());  return curricula.at(i); }
+  const Curriculum & getSingletonCurriculum(int i) { assert(i >= 0 && i < singletons.size());  return singletons.at(i); }
+  const Curriculum & getConflict(int i) { assert(i >= 0 && i < conflicts.size());  return conflicts.at(i); }
   const Restriction & getRestriction(int i) { assert(i >= 0 && i < restrict.size());  return restrict.at(i); }
   const Room getRoom(int i) { assert(i >= 0 && i < rooms.size()); return rooms.at(i); }
-  int getCourseId(std::string s) { try {return cnames[s];} catch (...) {
-    std::cerr << "Error: Course " << s << " not found!"; return -1;} }
-  int getRoomId(std::string s) { try {return rnames[s];} catch (...) {
-    std::cerr << "Error: Room " << s << " not found!"; return -1;} }
+  int findCourseId(const std::string &s) { 
+    std::map< std::string, int, std::less<std::string> >::iterator it = cnames.find(s);
+    return (it != cnames.end()) ? it->second : -1; }
+  int findRoomId(const std::string &s) { 
+    std::map< std::string, int, std::less<std::string> >::iterator it = rnames.find(s);
+    return (it != rnames.end()) ? it->second : -1; }
+  int getCourseId(std::string s) { 
+    int id = findCourseId(s);
+    if (id < 0) std::cerr << "Error: Course " << s << " not found!" << std::endl;
+    return id; }
+  int getRoomId(std::string s) { 
+    int id = findRoomId(s);
+    if (id < 0) std::cerr << "Error: Room " << s << " not found!" << std::endl;
+    return id; }
   PatternDB getPatterns() { 
     if (patterns.size() == 0) {
       std::cout << "Solver: Enumerating patterns to penalise ..." << std::endl;
@@ -0,0 +1,358 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "pdhg.h"
+
+inline bool isFinite(double bound) { return std::fabs(bound) < lpInfinity; }
+
+
+int SparseLP::addColumn(double lower, double upper, double cost) {
+  columnLower.push_back(lower);
+  columnUpper.push_back(upper);
+  objective.push_back(cost);
+  return objective.size() - 1;
+}
+
+
+int SparseLP::addRow(double lower, double upper, const std::vector<int> &columns, const std::vector<double> &coefficients) {
+  std::vector< std::pair<int, double> > entries;
+  for (int k = 0; k < columns.size(); k++) entries.push_back(std::make_pair(columns[k], coefficients[k]));
+  std::sort(entries.begin(), entries.end());
+  for (int k = 0; k < entries.size(); k++) {
+    if (k > 0 && entries[k].first == entries[k - 1].first) { values.back() += entries[k].second; continue; }
+    columnIndices.push_back(entries[k].first);
+    values.push_back(entries[k].second);
+  }
+  rowStarts.push_back(values.size());
+  rowLower.push_back(lower);
+  rowUpper.push_back(upper);
+  return rowLower.size() - 1;
+}
+
+
+PdhgSolver::PdhgSolver(const SparseLP &problem, int t)
+: lp(problem), threads(std::max(1, t)), m(problem.getRowCount()), n(problem.getColumnCount()),
+tau(0), sigma(0), weight(1), iterations(0), bestBound(-lpInfinity), primalObjective(0), primalResidual(0),
+start(0), sync(0) {
+  scale();
+
+  // Blocks of rows and columns with roughly the same numbers of non-zeros
+  int t2, k;
+  rowBlocks.assign(threads + 1, m);
+  columnBlocks.assign(threads + 1, n);
+  rowBlocks[0] = columnBlocks[0] = 0;
+  for (t2 = 1, k = 0; t2 < threads; t2++) {
+    while (k < m && rowStarts[k] < (long long)t2 * rowStarts[m] / threads) k++;
+    rowBlocks[t2] = k;
+  }
+  for (t2 = 1, k = 0; t2 < threads; t2++) {
+    while (k < n && columnStarts[k] < (long long)t2 * columnStarts[n] / threads) k++;
+    columnBlocks[t2] = k;
+  }
+
+  x.assign(n, 0);
+  for (int j = 0; j < n; j++) x[j] = std::min(std::max(0.0, lb[j]), ub[j]);
+  y.assign(m, 0);
+  bestY = y;
+  xBar = x;
+  xSum.assign(n, 0);
+  ySum.assign(m, 0);
+}
+
+
+void PdhgSolver::scale() {
+  int i, j, k, pass;
+  rowStarts = lp.rowStarts;
+  rowIndices = lp.columnIndices;
+  rowValues = lp.values;
+  rowScale.assign(m, 1);
+  columnScale.assign(n, 1);
+
+  // Ruiz equilibration: divide by the square roots of the largest entries of rows and columns
+  std::vector<double> rowMax(m), columnMax(n);
+  for (pass = 0; pass < 10; pass++) {
+    std::fill(rowMax.begin(), rowMax.end(), 0);
+    std::fill(columnMax.begin(), columnMax.end(), 0);
+    for (i = 0; i < m; i++)
+      for (k = rowStarts[i]; k < rowStarts[i + 1]; k++) {
+        double a = std::fabs(rowValues[k]);
+        rowMax[i] = std::max(rowMax[i], a);
+        columnMax[rowIndices[k]] = std::max(columnMax[rowIndices[k]], a);
+      }
+    for (i = 0; i < m; i++) rowMax[i] = (rowMax[i] > 0) ? 1 / std::sqrt(rowMax[i]) : 1;
+    for (j = 0; j < n; j++) columnMax[j] = (columnMax[j] > 0) ? 1 / std::sqrt(columnMax[j]) : 1;
+    for (i = 0; i < m; i++) {
+      rowScale[i] *= rowMax[i];
+      for (k = rowStarts[i]; k < rowStarts[i + 1]; k++)
+        rowValues[k] *= rowMax[i] * columnMax[rowIndices[k]];
+    }
+    for (j = 0; j < n; j++) columnScale[j] *= columnMax[j];
+  }
+
+  // The column-wise copy
+  columnStarts.assign(n + 1, 0);
+  for (k = 0; k < rowIndices.size(); k++) columnStarts[rowIndices[k] + 1] += 1;
+  for (j = 0; j < n; j++) columnStarts[j + 1] += columnStarts[j];
+  columnIndices.resize(rowIndices.size());
+  columnValues.resize(rowIndices.size());
+  std::vector<int> next(columnStarts.begin(), columnStarts.end() - 1);
+  for (i = 0; i < m; i++)
+    for (k = rowStarts[i]; k < rowStarts[i + 1]; k++) {
+      int at = next[rowIndices[k]]++;
+      columnIndices[at] = i;
+      columnValues[at] = rowValues[k];
+    }
+
+  c.resize(n); lb.resize(n); ub.resize(n);
+  for (j = 0; j < n; j++) {
+    c[j] = lp.objective[j] * columnScale[j];
+    lb[j] = isFinite(lp.columnLower[j]) ? lp.columnLower[j] / columnScale[j] : -lpInfinity;
+    ub[j] = isFinite(lp.columnUpper[j]) ? lp.columnUpper[j] / columnScale[j] : lpInfinity;
+  }
+  lower.resize(m); upper.resize(m);
+  for (i = 0; i < m; i++) {
+    lower[i] = isFinite(lp.rowLower[i]) ? lp.rowLower[i] * rowScale[i] : -lpInfinity;
+    upper[i] = isFinite(lp.rowUpper[i]) ? lp.rowUpper[i] * rowScale[i] : lpInfinity;
+  }
+}
+
+
+// The largest singular value of the scaled matrix, by power iterations
+double PdhgSolver::estimateNorm() {
+  std::vector<double> v(n, 1), w(m);
+  double norm = 0;
+  int i, j, k;
+  for (int it = 0; it < 30; it++) {
+    double length = 0;
+    for (j = 0; j < n; j++) length += v[j] * v[j];
+    length = std::sqrt(length);
+    if (length == 0) return 1;
+    for (j = 0; j < n; j++) v[j] /= length;
+    for (i = 0; i < m; i++) {
+      w[i] = 0;
+      for (k = rowStarts[i]; k < rowStarts[i + 1]; k++) w[i] += rowValues[k] * v[rowIndices[k]];
+    }
+    norm = 0;
+    for (j = 0; j < n; j++) {
+      v[j] = 0;
+      for (k = columnStarts[j]; k < columnStarts[j + 1]; k++) v[j] += columnValues[k] * w[columnIndices[k]];
+      norm += v[j] * v[j];
+    }
+    norm = std::sqrt(std::sqrt(norm));
+  }
+  return std::max(norm, 1e-8);
+}
+
+
+void PdhgSolver::updatePrimal(int block) {
+  for (int j = columnBlocks[block]; j < columnBlocks[block + 1]; j++) {
+    double aty = 0;
+    for (int k = columnStarts[j]; k < columnStarts[j + 1]; k++) aty += columnValues[k] * y[columnIndices[k]];
+    double next = std::min(std::max(x[j] - tau * (c[j] - aty), lb[j]), ub[j]);
+    xBar[j] = 2 * next - x[j];
+    x[j] = next;
+    xSum[j] += next;
+  }
+}
+
+
+void PdhgSolver::updateDual(int block) {
+  for (int i = rowBlocks[block]; i < rowBlocks[block + 1]; i++) {
+    double ax = 0;
+    for (int k = rowStarts[i]; k < rowStarts[i + 1]; k++) ax += rowValues[k] * xBar[rowIndices[k]];
+    double v = y[i] - sigma * ax;
+    if (lower[i] > -lpInfinity && v + sigma * lower[i] > 0) y[i] = v + sigma * lower[i];
+    else if (upper[i] < lpInfinity && v + sigma * upper[i] < 0) y[i] = v + sigma * upper[i];
+    else y[i] = 0;
+    ySum[i] += y[i];
+  }
+}
+
+
+double PdhgSolver::getDualBound(const std::vector<double> &duals, std::vector<double> *reducedCosts) const {
+  double bound = lp.objectiveOffset;
+  int i, j, k;
+  for (i = 0; i < m; i++) {
+    if (duals[i] > 0) bound += duals[i] * lower[i];
+    if (duals[i] < 0) bound += duals[i] * upper[i];
+  }
+  for (j = 0; j < n; j++) {
+    double d = c[j];
+    for (k = columnStarts[j]; k < columnStarts[j + 1]; k++) d -= columnValues[k] * duals[columnIndices[k]];
+    if (reducedCosts) (*reducedCosts)[j] = d;
+    if (d > 0) bound += (lb[j] > -lpInfinity) ? d * lb[j] : -lpInfinity;
+    if (d < 0) bound += (ub[j] < lpInfinity) ? d * ub[j] : -lpInfinity;
+  }
+  return std::max(bound, -lpInfinity);
+}
+
+
+double PdhgSolver::getKktError(const std::vector<double> &primal, const std::vector<double> &duals,
+                               double *objective, double *residual, double *bound) const {
+  double value = lp.objectiveOffset, violation = 0;
+  int i, j, k;
+  for (j = 0; j < n; j++) value += c[j] * primal[j];
+  for (i = 0; i < m; i++) {
+    double ax = 0;
+    for (k = rowStarts[i]; k < rowStarts[i + 1]; k++) ax += rowValues[k] * primal[rowIndices[k]];
+    double r = std::max(0.0, lower[i] - ax) + std::max(0.0, ax - upper[i]);
+    violation += r * r;
+  }
+  *objective = value;
+  *residual = std::sqrt(violation);
+  *bound = getDualBound(duals);
+  double gap = (*bound > -lpInfinity) ? value - *bound : lpInfinity;
+  return std::sqrt(weight * weight * violation + gap * gap);
+}
+
+
+void PdhgSolver::runBlocks(int block, int rounds) {
+  for (int r = 0; r < rounds; r++) {
+    updatePrimal(block);
+    if (threads > 1) sync->wait();
+    updateDual(block);
+    if (threads > 1) sync->wait();
+  }
+}
+
+
+// Runs its blocks of rows and columns in each round, while the main thread waits
+struct PdhgWorker {
+  PdhgSolver *solver;
+  int block;
+  int *rounds;
+  void operator()() {
+    while (true) {
+      solver->start->wait();
+      if (*rounds <= 0) return;
+      solver->runBlocks(block, *rounds);
+    }
+  }
+};
+
+
+double PdhgSolver::solve(double tolerance, int iterationLimit, double timeLimit) {
+  boost::system_time deadline = boost::get_system_time()
+    + boost::posix_time::milliseconds(long(timeLimit * 1000));
+  int i, j;
+
+  // Step sizes and the initial primal weight, the ratio of the norms of the costs and the bounds
+  double eta = 0.9 / estimateNorm();
+  double costNorm = 0, boundNorm = 0;
+  for (j = 0; j < n; j++) costNorm += c[j] * c[j];
+  for (i = 0; i < m; i++) {
+    double b = std::max(isFinite(lower[i]) ? std::fabs(lower[i]) : 0.0, isFinite(upper[i]) ? std::fabs(upper[i]) : 0.0);
+    boundNorm += b * b;
+  }
+  weight = (costNorm > 0 && boundNorm > 0) ? std::sqrt(costNorm / boundNorm) : 1;
+  tau = eta / weight;
+  sigma = eta * weight;
+
+  boost::barrier startBarrier(threads), syncBarrier(threads);
+  start = &startBarrier;
+  sync = &syncBarrier;
+  int rounds = 0;
+  boost::thread_group group;
+  for (int t = 1; t < threads; t++) {
+    PdhgWorker worker = { this, t, &rounds };
+    group.create_thread(worker);
+  }
+
+  const int checkEvery = 64;
+  double objective, residual, bound;
+  double lastKkt = getKktError(x, y, &objective, &residual, &bound);
+  double previousKkt = lpInfinity;
+  std::vector<double> xLast(x), yLast(y), xAverage(n), yAverage(m);
+  int sinceRestart = 0;
+
+  while (iterations < iterationLimit) {
+    rounds = std::min(checkEvery, iterationLimit - iterations);
+    if (threads > 1) start->wait();
+    runBlocks(0, rounds);
+    iterations += rounds;
+    sinceRestart += rounds;
+
+    // The better of the current iterate and the average since the last restart
+    for (j = 0; j < n; j++) xAverage[j] = xSum[j] / sinceRestart;
+    for (i = 0; i < m; i++) yAverage[i] = ySum[i] / sinceRestart;
+    double averageObjective, averageResidual, averageBound;
+    double currentKkt = getKktError(x, y, &objective, &residual, &bound);
+    double averageKkt = getKktError(xAverage, yAverage, &averageObjective, &averageResidual, &averageBound);
+    if (bound > bestBound) { bestBound = bound; bestY = y; }
+    if (averageBound > bestBound) { bestBound = averageBound; bestY = yAverage; }
+    bool useAverage = averageKkt < currentKkt;
+    double candidateKkt = useAverage ? averageKkt : currentKkt;
+    primalObjective = useAverage ? averageObjective : objective;
+    primalResidual = useAverage ? averageResidual : residual;
+
+    // Restart, when the KKT error has dropped enough, or stopped dropping, or after long
+    if (candidateKkt <= 0.2 * lastKkt || (candidateKkt <= 0.8 * lastKkt && candidateKkt > previousKkt)
+      || sinceRestart >= 0.36 * iterations) {
+        if (useAverage) { x = xAverage; y = yAverage; }
+        double dx = 0, dy = 0;
+        for (j = 0; j < n; j++) dx += (x[j] - xLast[j]) * (x[j] - xLast[j]);
+        for (i = 0; i < m; i++) dy += (y[i] - yLast[i]) * (y[i] - yLast[i]);
+        if (dx > 1e-20 && dy > 1e-20) {
+          weight = std::exp(0.5 * std::log(std::sqrt(dy / dx)) + 0.5 * std::log(weight));
+          tau = eta / weight;
+          sigma = eta * weight;
+        }
+        xLast = x; yLast = y;
+        std::fill(xSum.begin(), xSum.end(), 0);
+        std::fill(ySum.begin(), ySum.end(), 0);
+        sinceRestart = 0;
+        lastKkt = candidateKkt;
+        previousKkt = lpInfinity;
+    } else {
+      previousKkt = candidateKkt;
+    }
+
+    double scaleOfValues = 1 + std::fabs(primalObjective) + std::fabs(bestBound);
+    if (bestBound > -lpInfinity && primalObjective - bestBound <= tolerance * scaleOfValues
+      && primalResidual <= tolerance * (1 + std::sqrt(boundNorm))) break;
+    if (boost::get_system_time() > deadline) break;
+  }
+
+  if (threads > 1) {
+    rounds = 0;
+    start->wait();
+    group.join_all();
+  }
+  start = sync = 0;
+  return bestBound;
+}
+
+
+void PdhgSolver::getPrimal(std::vector<double> &primal) const {
+  primal.resize(n);
+  for (int j = 0; j < n; j++) primal[j] = x[j] * columnScale[j];
+}
+
+
+void PdhgSolver::getDuals(std::vector<double> &duals) const {
+  duals.resize(m);
+  for (int i = 0; i < m; i++) duals[i] = bestY[i] * rowScale[i];
+}
+
+
+void PdhgSolver::getReducedCosts(std::vector<double> &reducedCosts) const {
+  reducedCosts.resize(n);
+  getDualBound(bestY, &reducedCosts);
+  for (int j = 0; j < n; j++) reducedCosts[j] /= columnScale[j];
+}
@@ -0,0 +1,102 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_PDHG
+#define UDINE_PDHG
+
+#include <vector>
+
+namespace boost { class barrier; }
+
+// Bounds of magnitude at least this are infinite, as with IloInfinity
+const double lpInfinity = 1e20;
+
+/* A linear program min c'x s.t. rowLower <= Ax <= rowUpper,
+* columnLower <= x <= columnUpper, with A stored row-wise.
+*/
+struct SparseLP {
+  std::vector<int> rowStarts, columnIndices;
+  std::vector<double> values;
+  std::vector<double> rowLower, rowUpper;
+  std::vector<double> columnLower, columnUpper, objective;
+  double objectiveOffset;
+
+  SparseLP() : rowStarts(1, 0), objectiveOffset(0) {}
+  int getRowCount() const { return rowLower.size(); }
+  int getColumnCount() const { return objective.size(); }
+  int getNonzeroCount() const { return values.size(); }
+  int addColumn(double lower, double upper, double cost);
+  // Coefficients of the same column are summed up
+  int addRow(double lower, double upper, const std::vector<int> &columns, const std::vector<double> &coefficients);
+};
+
+/* Solves the linear program approximately by the primal-dual hybrid gradient
+* method of Chambolle and Pock, as in PDLP: with Ruiz equilibration, restarts
+* from the average of the iterates since the last restart whenever it reduces
+* the KKT error enough, and primal weights updated at the restarts.
+* The products with A and its transpose are split among threads by rows and
+* columns of roughly equal numbers of non-zeros.
+* As all columns are bounded, any duals give a valid lower bound
+*   min { c'x - y'(Ax - s) : x within its bounds, s within the row bounds },
+* the best of which is kept.
+*/
+class PdhgSolver {
+protected:
+  const SparseLP &lp;
+  int threads;
+  int m, n;
+
+  // The scaled problem, with its matrix both row-wise and column-wise
+  std::vector<double> rowScale, columnScale;
+  std::vector<int> rowStarts, rowIndices, columnStarts, columnIndices;
+  std::vector<double> rowValues, columnValues;
+  std::vector<double> c, lower, upper, lb, ub;
+
+  // The iterates, their sums since the last restart, and workspace
+  std::vector<double> x, y, xBar, xSum, ySum;
+  std::vector<double> bestY;
+  std::vector<int> rowBlocks, columnBlocks;
+  double tau, sigma, weight;
+  int iterations;
+  double bestBound, primalObjective, primalResidual;
+  boost::barrier *start, *sync;
+
+  void scale();
+  double estimateNorm();
+  void updatePrimal(int block);
+  void updateDual(int block);
+  void runBlocks(int block, int rounds);
+  // The lower bound given the duals and the KKT error of a pair of iterates, in the scaled space
+  double getDualBound(const std::vector<double> &duals, std::vector<double> *reducedCosts = 0) const;
+  double getKktError(const std::vector<double> &primal, const std::vector<double> &duals,
+    double *objective, double *residual, double *bound) const;
+
+  friend struct PdhgWorker;
+
+public:
+  PdhgSolver(const SparseLP &lp, int threads = 1);
+
+  // Runs until the relative gap and primal residual fall under the tolerance, or a limit is hit;
+  // returns the best lower bound
+  double solve(double tolerance = 1e-4, int iterationLimit = 100000, double timeLimit = 60);
+
+  int getIterations() const { return iterations; }
+  double getBound() const { return bestBound; }
+  double getPrimalObjective() const { return primalObjective; }
+  double getPrimalResidual() const { return primalResidual; }
+  // The last primal iterate and the duals of the best bound, in the original space
+  void getPrimal(std::vector<double> &primal) const;
+  void getDuals(std::vector<double> &duals) const;
+  // The reduced costs c - A'y of the duals of the best bound, in the original space
+  void getReducedCosts(std::vector<double> &reducedCosts) const;
+};
+
+#endif // UDINE_PDHG
@@ -0,0 +1,205 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+#include "presolve.h"
+
+
+// The number of the periods of the course still available
+static int countAvailable(const PresolveResult &result, int P, int c) {
+  return std::count(result.available.begin() + c * P, result.available.begin() + (c + 1) * P, 1);
+}
+
+
+// Takes the period away from the course, unless it is gone already
+static bool removePeriod(PresolveResult &result, int P, int c, int p) {
+  if (!result.available[c * P + p]) return false;
+  result.available[c * P + p] = 0;
+  result.removed += 1;
+  return true;
+}
+
+
+static bool fail(PresolveResult &result, const std::string &reason) {
+  result.feasible = false;
+  result.reason = reason;
+  return false;
+}
+
+
+// The courses with as many periods as lectures take all of them
+static bool propagateCourses(TimetablingInstance &instance, PresolveResult &result) {
+  int P = instance.getPeriodCount();
+  for (int c = 0; c < instance.getCourseCount(); c++) {
+    int available = countAvailable(result, P, c);
+    if (available < instance.getCourse(c).lectures) {
+      std::ostringstream reason;
+      reason << "course " << instance.getCourse(c).name << " has " << instance.getCourse(c).lectures
+        << " lectures, but " << available << " periods available";
+      return fail(result, reason.str());
+    }
+    if (available == instance.getCourse(c).lectures) result.forced[c] = 1;
+  }
+  return true;
+}
+
+
+// Hall intervals of the courses of each clique, which are all different in their periods
+static bool propagateCliques(TimetablingInstance &instance, PresolveResult &result, bool &changed) {
+  int P = instance.getPeriodCount();
+  int u, k, l, p;
+  for (u = 0; u < instance.getConflictCount(); u++) {
+    const CourseIds &courses = instance.getConflict(u).courseIds;
+    std::vector<int> first(courses.size(), P), last(courses.size(), -1);
+    std::set<int> starts, ends;
+    for (k = 0; k < courses.size(); k++) {
+      for (p = 0; p < P; p++)
+        if (result.available[courses[k] * P + p]) {
+          first[k] = std::min(first[k], p);
+          last[k] = p;
+        }
+      starts.insert(first[k]);
+      ends.insert(last[k]);
+    }
+
+    for (std::set<int>::iterator a = starts.begin(); a != starts.end(); a++)
+      for (std::set<int>::iterator b = ends.lower_bound(*a); b != ends.end(); b++) {
+        // The courses within [a, b], their lectures and the periods they have between them
+        std::vector<char> within(courses.size(), 0), used(P, 0);
+        int demand = 0, supply = 0;
+        for (k = 0; k < courses.size(); k++) {
+          if (first[k] < *a || last[k] > *b) continue;
+          within[k] = 1;
+          demand += instance.getCourse(courses[k]).lectures;
+          for (p = *a; p <= *b; p++)
+            if (result.available[courses[k] * P + p] && !used[p]) {
+              used[p] = 1;
+              supply += 1;
+            }
+        }
+        if (demand > supply) {
+          std::ostringstream reason;
+          reason << "the courses of " << instance.getConflict(u).name << " within periods " << *a << "-" << *b
+            << " have " << demand << " lectures, but " << supply << " periods available";
+          return fail(result, reason.str());
+        }
+        if (demand == 0 || demand < supply) continue;
+        for (l = 0; l < courses.size(); l++)
+          if (!within[l])
+            for (p = *a; p <= *b; p++)
+              if (used[p] && removePeriod(result, P, courses[l], p)) changed = true;
+      }
+  }
+  return true;
+}
+
+
+// No more lectures in a period than rooms, and the other courses are out of a full period
+static bool propagateRooms(TimetablingInstance &instance, PresolveResult &result, bool &changed) {
+  int P = instance.getPeriodCount(), C = instance.getCourseCount(), R = instance.getRoomCount();
+  for (int p = 0; p < P; p++) {
+    int certain = 0;
+    for (int c = 0; c < C; c++)
+      if (result.forced[c] && result.available[c * P + p]) certain += 1;
+    if (certain > R) {
+      std::ostringstream reason;
+      reason << certain << " lectures are certain to be held in period " << p << ", but there are " << R << " rooms";
+      return fail(result, reason.str());
+    }
+    if (certain < R) continue;
+    for (int c = 0; c < C; c++)
+      if (!result.forced[c] && removePeriod(result, P, c, p)) changed = true;
+  }
+  return true;
+}
+
+
+// The bounds on the days of the courses and the isolated lectures of the curricula
+static void boundDays(TimetablingInstance &instance, PresolveResult &result) {
+  int P = instance.getPeriodCount(), D = instance.getDayCount(), ppd = instance.getPeriodsPerDayCount();
+  int C = instance.getCourseCount(), U = instance.getProperCurriculumCount();
+  int c, d, u, k, p, pd;
+
+  result.courseDaysLower.assign(C * D, 0);
+  result.courseDaysUpper.assign(C * D, 1);
+  result.minDayViolationsLower.assign(C, 0);
+  for (c = 0; c < C; c++) {
+    int days = 0;
+    for (d = 0; d < D; d++) {
+      int available = std::count(result.available.begin() + c * P + d * ppd, result.available.begin() + c * P + (d + 1) * ppd, 1);
+      if (available == 0) result.courseDaysUpper[c * D + d] = 0;
+      else days += 1;
+      if (available > 0 && result.forced[c]) result.courseDaysLower[c * D + d] = 1;
+    }
+    result.minDayViolationsLower[c] = std::max(0, instance.getCourse(c).minWorkingDays - days);
+  }
+
+  // A lecture is isolated for sure if held for sure, when nothing of the curriculum can be next to it
+  result.singletonLower.assign(U * D, 0);
+  result.singletonUpper.assign(U * D, 0);
+  for (u = 0; u < U; u++) {
+    const CourseIds &courses = instance.getCurriculum(u).courseIds;
+    int lectures = 0;
+    for (k = 0; k < courses.size(); k++) lectures += instance.getCourse(courses[k]).lectures;
+    for (d = 0; d < D; d++) {
+      std::vector<char> possible(ppd, 0), certain(ppd, 0);
+      int open = 0, isolated = 0;
+      for (pd = 0; pd < ppd; pd++) {
+        p = d * ppd + pd;
+        for (k = 0; k < courses.size(); k++)
+          if (result.available[courses[k] * P + p]) {
+            possible[pd] = 1;
+            if (result.forced[courses[k]]) certain[pd] = 1;
+          }
+        open += possible[pd];
+      }
+      for (pd = 0; pd < ppd; pd++)
+        if (certain[pd] && (pd == 0 || !possible[pd - 1]) && (pd == ppd - 1 || !possible[pd + 1])) isolated += 1;
+      result.singletonLower[u * D + d] = isolated;
+      result.singletonUpper[u * D + d] = std::min(std::min(open, lectures), (ppd + 1) / 2);
+    }
+  }
+}
+
+
+bool presolveInstance(TimetablingInstance &instance, PresolveResult &result) {
+  int P = instance.getPeriodCount(), C = instance.getCourseCount();
+  result.feasible = true;
+  result.reason.clear();
+  result.available.assign(C * P, 1);
+  result.forced.assign(C, 0);
+  result.removed = 0;
+  result.rounds = 0;
+  for (int f = 0; f < instance.getRestrictionCount(); f++)
+    result.available[instance.getRestriction(f).courseId * P + instance.getRestriction(f).period] = 0;
+
+  int lectures = 0;
+  for (int c = 0; c < C; c++) lectures += instance.getCourse(c).lectures;
+  if (lectures > P * instance.getRoomCount()) {
+    std::ostringstream reason;
+    reason << lectures << " lectures do not fit " << P * instance.getRoomCount() << " rooms and periods";
+    return fail(result, reason.str());
+  }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    result.rounds += 1;
+    if (!propagateCourses(instance, result)) return false;
+    if (!propagateCliques(instance, result, changed)) return false;
+    if (!propagateRooms(instance, result, changed)) return false;
+  }
+  boundDays(instance, result);
+  return true;
+}
@@ -0,0 +1,51 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_PRESOLVE
+#define UDINE_PRESOLVE
+
+#include <string>
+#include <vector>
+
+#include "loader.h"
+
+/* What propagation on the instance alone leaves of the periods of each course, and the
+* bounds that follow on the auxiliary variables of the model. Any feasible timetable
+* keeps within them. If the instance has no feasible timetable, feasible is false
+* and reason tells why.
+*/
+struct PresolveResult {
+  bool feasible;
+  std::string reason;
+  std::vector<char> available;        // indexed with c * periods + p
+  std::vector<char> forced;           // indexed with c, all its periods available taken
+  std::vector<int> courseDaysLower;   // indexed with c * days + d
+  std::vector<int> courseDaysUpper;
+  std::vector<int> minDayViolationsLower;   // indexed with c
+  std::vector<int> singletonLower;    // indexed with u * days + d, of the proper curricula
+  std::vector<int> singletonUpper;
+  int removed;                        // periods of courses left out, other than by the restrictions
+  int rounds;
+};
+
+/* Propagates to a fixpoint:
+* - a course with as many periods available as lectures takes all of them;
+* - within each clique of conflicts, see TimetablingInstance::reduceConflicts, the courses
+*   with all their periods available within an interval of periods need as many of them
+*   as they have lectures, and if they need all, no other course of the clique can have
+*   any of those, e.g. a day the workload of a curriculum fills (Hall intervals);
+* - in each period, there are no more lectures than rooms, and a period the lectures
+*   certain to be held in it fill is left to them.
+* The conflicts as reduced are used, so it should go after reduceConflicts.
+*/
+bool presolveInstance(TimetablingInstance &instance, PresolveResult &result);
+
+#endif // UDINE_PRESOLVE
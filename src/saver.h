@@ -13,16 +13,17 @@
 #define UDINE_SAVER
 
 #include <cmath>
-#include <ctime>
 #include <iostream>
-#include <fstream>
-#include <sstream>
-#include <string>
 
 
 #include <ilcplex/ilocplex.h>
 
 #include "solver.h"
+#include "timetable.h"
+#include "evaluator.h"
+#include "writer.h"
+#include "events.h"
+#include "exchange.h"
 
 ILOSTLBEGIN
 
@@ -31,13 +32,18 @@ class IncumbentSaverI : public IloCplex::IncumbentCallbackI {
 protected:
   IloEnv env;
   TimetablingSolver& solver;
-  char *saveToPath;
+  TimetableEvaluator evaluator;
+  SolutionWriter &writer;
+  EventLog &events;
+  SolutionExchange *exchange;   // shared with the other solves of a portfolio or the shards, if any
+  int member;
 
 public:
   ILOCOMMONCALLBACKSTUFF(IncumbentSaver)
 
-    IncumbentSaverI(IloEnv env, TimetablingSolver& s, char *path)
-    : IloCplex::IncumbentCallbackI(env), solver(s), saveToPath(path) {
+    IncumbentSaverI(IloEnv env, TimetablingSolver& s, SolutionWriter &w, EventLog &log, SolutionExchange *x = 0, int m = 0)
+    : IloCplex::IncumbentCallbackI(env), solver(s), evaluator(s.instance, false), writer(w), events(log),
+      exchange(x), member(m) {
   }
 
   inline int roundProperly(double x) { return int(std::floor(x + 0.5f)); }
@@ -45,124 +51,85 @@ public:
   void main() {
     try {
 
-      std::stringstream path;
-      path << saveToPath << "." << getObjValue() << ".sol";
-      std::ofstream solFile(path.str().c_str(), ios::app);
-
-      int c, p, r;  // course, period, room
-      for(c = 0; c < solver.instance.getCourseCount(); c++)
-        for(p = 0; p < solver.instance.getPeriodCount(); p++)
-          for(r = 0; r < solver.instance.getRoomCount(); r++)
-            if (getValue(solver.vars.x[p][r][c]) >= 0.999)
-              //solFile << "Course " << solver.instance.getCourse(c).name << " room " << solver.instance.getRoom(r).name << " period " << p << std::endl;
-              // InfArcBib r10 0 0
-              solFile << solver.instance.getCourse(c).name << " " 
-              << "r" << solver.instance.getRoom(r).name << " "
-              << int(std::floor(float(p / solver.instance.getPeriodsPerDayCount()))) << " "
-              << int(p % solver.instance.getPeriodsPerDayCount()) << std::endl;
+      // Read all of x at once and keep the lectures scheduled
+      int C = solver.instance.getCourseCount();
+      int R = solver.instance.getRoomCount();
+      IloNumArray values(getEnv());
+      getValues(values, solver.vars.xs);
+      Lectures lectures;
+      for (IloInt k = 0; k < values.getSize(); k++)
+        if (values[k] >= 0.999) {
+          Lecture l; 
+          l.course = k % C; l.room = (k / C) % R; l.period = k / (C * R);
+          lectures.push_back(l);
+        }
+      values.end();
 
       // check that all the type 1 cuts required were applied 
-      if (std::abs(getObjValue() - getValidObjValue(solFile)) > 0.01)
+      if (std::abs(getObjValue() - getValidObjValue(lectures)) > 0.01) {
         reject();
+        return;
+      }
 
-      solFile.close();
+      // The rooms are post-optimised and the file written in the background
+      writer.write(lectures, roundProperly(getObjValue()));
+      events.push(IncumbentEvent, getNnodes(), roundProperly(getObjValue()));
+      if (exchange) exchange->offerIncumbent(member, roundProperly(getObjValue()));
     }
     catch (IloException& e) { std::cerr << "Concert error: " << e << std::endl; }
     catch (...) { std::cerr << "Unknown error: " << std::endl; }
   }
 
-  // Adapted from the code of di Gaspero and Schaerf
-  int getValidObjValue(std::ofstream &os) {
-    int x = 0; // return value
-    try {
+  // The objective value of the timetable, as in the model, or more, if it violates hard constraints
+  int getValidObjValue(const Lectures &lectures) {
+    const Penalties &penalties = evaluator.evaluate(lectures);
+    std::cout << "Solver: Validated " << penalties << std::endl;
+    return penalties.getSoft() + 1000 * penalties.getHard();
+  }
 
-      TimetablingInstance &in = solver.instance;
-      std::cout << "Solver: Trying to validate the solution found ... " << std::endl;
-
-      // helper vars
-      unsigned c, p, r, d, u;
-      int ppd = in.getPeriodsPerDayCount();
-      std::vector<int> distinctDays(in.getCourseCount(), 0);
-      for (c = 0; c < in.getCourseCount(); c++)
-        for (d = 0; d < in.getPeriodCount() / ppd; d++) {
-          int i = 0;
-          for (p = 0; p < ppd; p++) 
-            for(r = 0; r < in.getRoomCount(); r++)
-              i = std::max(i, roundProperly(getValue(solver.vars.x[p][r][c])));
-          distinctDays[c] += i;
-        }
-        std::vector<int> distinctRooms(in.getCourseCount(), 0);   
-        for(c = 0; c < in.getCourseCount(); c++)
-          for(r = 0; r < in.getRoomCount(); r++) {
-            int i = 0;
-            for (p = 0; p < in.getPeriodCount(); p++)
-              i = std::max(i, roundProperly(getValue(solver.vars.x[p][r][c])));
-            distinctRooms[c] += i;
-          }
-          std::vector<int> fresh(solver.instance.getPeriodCount(), 0);
-          std::vector< std::vector<int> > timetable(solver.instance.getCurriculumCount(), fresh);
-          for (p = 0; p < in.getPeriodCount(); p++)
-            for (u = 0; u < in.getCurriculumCount(); u++) {
-              int i = 0;
-              for (int ui = 0; ui < in.getCurriculum(u).courseIds.size(); ui++)
-                for (r = 0; r < in.getRoomCount(); r++)
-                  i = std::max(i, roundProperly(getValue(solver.vars.x[p][r][in.getCurriculum(u).courseIds.at(ui)])));
-              timetable[u][p] = i;
-            }
-
-            // PrintViolationsOnRoomCapacity
-            for (c = 0; c < in.getCourseCount(); c++)
-              for (p = 0; p < in.getPeriodCount(); p++)
-                if (r != 0 && in.getRoom(r).capacity < in.getCourse(c).students) {
-                  os << "[S(" << in.getCourse(c).students - in.getRoom(r).capacity 
-                    << ")] Room " << in.getRoom(r).name << " too small for course " 
-                    << in.getCourse(c).name << " the period " 
-                    << p << " (day " << p/ppd << ", timeslot " 
-                    << p % ppd << ")" << std::endl;
-                  x += in.getCourse(c).students - in.getRoom(r).capacity;
-                }
-
-                // PrintViolationsOnMinWorkingDays(std::ostream& os) const
-                for (c = 0; c < in.getCourseCount(); c++)
-                  if (distinctDays[c] < in.getCourse(c).minWorkingDays) {
-                    os << "[S(" << 5 << ")] The course " 
-                      << in.getCourse(c).name << " has only " << distinctDays[c]
-                    << " days of lecture" << std::endl;
-                    x += 5;
-                  }
-
-                  // PrintViolationsOnIsolatedLectures(std::ostream& os) const
-                  for (u = 0; u < in.getCurriculumCount(); u++)
-                    for (p = 0; p < in.getPeriodCount(); p++)
-                      if (timetable[u][p] > 0)
-                        if ((p % ppd == 0 && timetable[u][p+1] == 0)
-                          || (p % ppd == ppd-1 && timetable[u][p-1] == 0)
-                          || (timetable[u][p+1] == 0 && timetable[u][p-1] == 0)) {
-                            os << "[S(" << 2 << ")] Curriculum " 
-                              << in.getCurriculum(u).name << " has an isolated lecture at period " 
-                              << p << " (day " << p/ppd << ", timeslot " << p % ppd << ")" << std::endl;
-                            x += 2;
-                        }
-
-                        // PrintViolationsOnRoomStability(std::ostream& os) const
-                        for (c = 0; c < in.getCourseCount(); c++)
-                          if (distinctRooms[c] > 1) {
-                            os << "[S(" << distinctRooms[c] - 1 << ")] Course " 
-                              << in.getCourse(c).name << " uses " << distinctRooms[c] << " different rooms" 
-                              << std::endl;
-                            x += (distinctRooms[c] - 1);
-                          }
+};
+
+IloCplex::Callback IncumbentSaver(IloEnv env, TimetablingSolver& s, SolutionWriter &writer, EventLog &events,
+                                  SolutionExchange *exchange = 0, int member = 0) {
+  return (IloCplex::Callback(new (env) IncumbentSaverI(env, s, writer, events, exchange, member)));
+}
+
+
+/* Shares the bound of this solve with the others and uses their incumbents as a cutoff:
+* CPLEX 12.1 cannot lower CutUp during a solve, so the nodes which cannot improve
+* on the best incumbent of any member by a whole unit are pruned here, before branching.
+* Once the gap is closed overall, the solve stops.
+*/
+class IncumbentExchangeI : public IloCplex::BranchCallbackI {
+
+protected:
+  SolutionExchange &exchange;
+  int member;
+
+public:
+  ILOCOMMONCALLBACKSTUFF(IncumbentExchange)
+
+    IncumbentExchangeI(IloEnv env, SolutionExchange &x, int m)
+    : IloCplex::BranchCallbackI(env), exchange(x), member(m) {
+  }
+
+  void main() {
+    try {
+      exchange.updateBound(member, getBestObjValue());
+      if (exchange.isClosed()) {
+        abort();
+        return;
+      }
+      if (getObjValue() > exchange.getIncumbent() - 1 + 1e-6) prune();
     }
     catch (IloException& e) { std::cerr << "Concert error: " << e << std::endl; }
     catch (...) { std::cerr << "Unknown error: " << std::endl; }
-
-    return x;
   }
 
 };
 
-IloCplex::Callback IncumbentSaver(IloEnv env, TimetablingSolver& s, char *saveToPath = "./") {
-  return (IloCplex::Callback(new (env) IncumbentSaverI(env, s, saveToPath)));
+IloCplex::Callback IncumbentExchange(IloEnv env, SolutionExchange &exchange, int member) {
+  return (IloCplex::Callback(new (env) IncumbentExchangeI(env, exchange, member)));
 }
 
 #endif // UDINE_SAVER
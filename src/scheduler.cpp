@@ -0,0 +1,137 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <algorithm>
+
+#include "scheduler.h"
+
+const char *getCutFamilyName(int family) {
+  switch (family) {
+    case PatternCuts: return "patterns";
+    case MindaysCuts: return "mindays";
+    case CurriculumCuts: return "curricula";
+    case CliquePoolCuts: return "cliques";
+    case TriangleCuts: return "triangles";
+    case ObjIntegralityCuts: return "objective";
+    case LinkingCuts: return "linking";
+  }
+  return "unknown";
+}
+
+
+SeparationPolicy::SeparationPolicy() {
+  set("all");
+}
+
+
+bool SeparationPolicy::set(const std::string &n) {
+  if (n != "all" && n != "depth" && n != "adaptive") return false;
+  name = n;
+  frequency = 1;
+  adaptive = (n == "adaptive");
+  skipFactor = 10;
+  maxBackoff = 16;
+  for (int f = 0; f < CutFamilyCount; f++) {
+    enabled[f] = true;
+    maxDepth[f] = -1;
+  }
+  if (n != "all") {
+    maxDepth[MindaysCuts] = 0;
+    maxDepth[CurriculumCuts] = 0;
+    maxDepth[CliquePoolCuts] = 0;
+    maxDepth[TriangleCuts] = 0;
+  }
+  return true;
+}
+
+
+SeparationScheduler::SeparationScheduler(const SeparationPolicy &p) : policy(p), bestYield(0) {
+  for (int f = 0; f < CutFamilyCount; f++) {
+    FamilyRecord &r = records[f];
+    r.calls = r.successes = r.cuts = 0;
+    r.time = r.violation = r.yield = 0;
+    r.backoff = r.wait = 0;
+    r.separated = r.skippedByDepth = r.skippedByFrequency = r.skippedByBackoff = 0;
+  }
+}
+
+
+bool SeparationScheduler::shouldSeparate(int family, int depth, int call) {
+  boost::mutex::scoped_lock l(lock);
+  FamilyRecord &r = records[family];
+  if (family != PatternCuts) {
+    if (!policy.enabled[family]) return false;
+    if (policy.maxDepth[family] >= 0 && depth > policy.maxDepth[family]) {
+      r.skippedByDepth += 1;
+      return false;
+    }
+    if (depth > 0 && policy.frequency > 1 && call % policy.frequency != 0) {
+      r.skippedByFrequency += 1;
+      return false;
+    }
+    if (policy.adaptive && r.wait > 0) {
+      r.wait -= 1;
+      r.skippedByBackoff += 1;
+      return false;
+    }
+  }
+  r.separated += 1;
+  return true;
+}
+
+
+void SeparationScheduler::record(int family, double milliseconds, int cuts, double violation) {
+  boost::mutex::scoped_lock l(lock);
+  FamilyRecord &r = records[family];
+  r.calls += 1;
+  r.time += milliseconds;
+  r.cuts += cuts;
+  r.violation += violation;
+  if (cuts > 0) r.successes += 1;
+
+  // Smooth the yield, so that a family is judged by its recent calls
+  double yield = violation / std::max(milliseconds, 0.01);
+  r.yield = (r.calls == 1) ? yield : (r.yield + yield) / 2;
+  bestYield = 0;
+  for (int f = 0; f < CutFamilyCount; f++)
+    if (records[f].calls > 0) bestYield = std::max(bestYield, records[f].yield);
+
+  if (!policy.adaptive || family == PatternCuts) return;
+  if (cuts == 0 || r.yield * policy.skipFactor < bestYield) {
+    r.backoff = std::min(std::max(1, 2 * r.backoff), policy.maxBackoff);
+    r.wait = r.backoff;
+  } else {
+    r.backoff = 0;
+  }
+}
+
+
+void SeparationScheduler::getTotals(int family, int &cuts, double &milliseconds) {
+  boost::mutex::scoped_lock l(lock);
+  cuts = records[family].cuts;
+  milliseconds = records[family].time;
+}
+
+
+void SeparationScheduler::report(std::ostream &out) {
+  boost::mutex::scoped_lock l(lock);
+  out << "Mycuts: Separation policy " << policy.name << std::endl;
+  for (int f = 0; f < CutFamilyCount; f++) {
+    const FamilyRecord &r = records[f];
+    out << "Mycuts: " << getCutFamilyName(f) << ": separated " << r.separated
+      << ", skipped by depth " << r.skippedByDepth
+      << ", by frequency " << r.skippedByFrequency
+      << ", by backoff " << r.skippedByBackoff
+      << "; found cuts " << r.successes << " time(s), " << r.cuts << " cut(s) in total"
+      << " with violation " << r.violation << " in " << r.time << " ms"
+      << ", recent yield " << r.yield << " per ms" << std::endl;
+  }
+}
@@ -0,0 +1,88 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_SCHEDULER
+#define UDINE_SCHEDULER
+
+#include <ostream>
+#include <string>
+
+#include <boost/thread/mutex.hpp>
+
+// The families of cuts the cut manager separates
+enum CutFamily {
+  PatternCuts,
+  MindaysCuts,
+  CurriculumCuts,
+  CliquePoolCuts,
+  TriangleCuts,
+  ObjIntegralityCuts,
+  LinkingCuts,          // of x to courseRooms and courseDays, one room or one period at a time
+  CutFamilyCount
+};
+
+const char *getCutFamilyName(int family);
+
+/* When to separate each family:
+*   all       every family at every call, as it always was
+*   depth     the checks, the clique pool and the triangles at the root only
+*   adaptive  as depth, but backing off exponentially from families that find nothing,
+*             or whose yield falls under the best yield over skipFactor
+* Beyond the root, only every frequency-th call separates anything optional.
+* Any family but the patterns can also be switched off altogether.
+*/
+struct SeparationPolicy {
+  std::string name;
+  bool enabled[CutFamilyCount];
+  int maxDepth[CutFamilyCount];   // -1 for any depth
+  int frequency;
+  bool adaptive;
+  double skipFactor;
+  int maxBackoff;
+
+  SeparationPolicy();
+  // False if there is no such policy
+  bool set(const std::string &name);
+};
+
+/* Decides which families to separate at each call of the cut manager, from their
+* depth limits and their record so far. The yield of a call is the total violation
+* of its cuts per millisecond spent separating; it is smoothed exponentially.
+* Shared by the threads of CPLEX, hence locked.
+*/
+class SeparationScheduler {
+protected:
+  struct FamilyRecord {
+    int calls, successes, cuts;
+    double time, violation, yield;
+    int backoff, wait;
+    // The decisions made
+    int separated, skippedByDepth, skippedByFrequency, skippedByBackoff;
+  };
+
+  SeparationPolicy policy;
+  FamilyRecord records[CutFamilyCount];
+  double bestYield;
+  boost::mutex lock;
+
+public:
+  SeparationScheduler(const SeparationPolicy &p);
+  const SeparationPolicy &getPolicy() const { return policy; }
+
+  // The patterns are always separated, as the penalties depend on them
+  bool shouldSeparate(int family, int depth, int call);
+  void record(int family, double milliseconds, int cuts, double violation);
+  // The cuts a family has found and the time spent on it so far
+  void getTotals(int family, int &cuts, double &milliseconds);
+  void report(std::ostream &out);
+};
+
+#endif // UDINE_SCHEDULER
@@ -0,0 +1,328 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cmath>
+#include <set>
+
+#include "separators.h"
+
+
+void Relaxation::setX(TimetablingInstance &instance, const std::vector<float> &xs) {
+  int C = instance.getCourseCount(), R = instance.getRoomCount(), P = instance.getPeriodCount();
+  x.assign(C, std::vector<float>(P, 0));
+  this->xs = &xs;
+  int c, p, r;  // course, period, room
+  for(p = 0; p < P; p++)
+    for(r = 0; r < R; r++) {
+      const float *row = &xs[(p * R + r) * C];
+      for(c = 0; c < C; c++) x[c][p] += row[c];
+    }
+}
+
+
+Cut::Cut(int f) : family(f), room(-1), slack(NoSlack), slackIndex(0), slackCoefficient(0),
+  sense('L'), rhs(0), violation(0), local(false) {
+  key[0] = key[1] = key[2] = key[3] = 0;
+}
+
+
+void Cut::addTerm(int course, int period, double coefficient) {
+  courses.push_back(course);
+  periods.push_back(period);
+  coefficients.push_back(coefficient);
+}
+
+
+Separators::Separators(TimetablingInstance &i, Graph &g) : instance(i), conflictGraph(g) {
+  patterns = instance.getPatterns();
+}
+
+
+void Separators::separate(int family, const Relaxation &relaxation, std::vector<Cut> &cuts) {
+  switch (family) {
+    case PatternCuts: genCutsFromPatterns(relaxation, cuts); break;
+    case MindaysCuts: genCutsFromMindaysChecks(relaxation, cuts); break;
+    case CurriculumCuts: genCutsFromCurriculumChecks(relaxation, cuts); break;
+    case CliquePoolCuts: genCutsFromCliquePool(relaxation, cuts); break;
+    case TriangleCuts: genCutsFromTriangles(relaxation, cuts); break;
+    case ObjIntegralityCuts: genCutsFromObjIntegrality(relaxation, cuts); break;
+    case LinkingCuts: genCutsFromLinking(relaxation, cuts); break;
+  }
+}
+
+
+void Separators::genCutsFromObjIntegrality(const Relaxation &relaxation, std::vector<Cut> &cuts) {
+
+  // GLOBAL CUTS FROM THE WORST OBJECTIVE FROM ACTIVE NODES FIRST
+  float diff = relaxation.bound - std::floor(relaxation.bound);
+  if (diff > 0.01 && diff < 0.99) {
+    Cut cut(ObjIntegralityCuts);
+    cut.slack = ObjectiveSlack;
+    cut.slackCoefficient = 1;
+    cut.sense = 'G';
+    cut.rhs = std::ceil(relaxation.bound);
+    cut.violation = 1 - diff;
+    cuts.push_back(cut);
+  }
+
+  // LOCAL CUTS FROM THE OBJECTIVE AT THE CURRENT NODE
+  diff = relaxation.objective - std::floor(relaxation.objective);
+  if (diff > 0.01 && diff < 0.99 && std::abs(relaxation.objective - relaxation.bound) > 0.01) {
+    Cut cut(ObjIntegralityCuts);
+    cut.key[0] = 1;
+    cut.slack = ObjectiveSlack;
+    cut.slackCoefficient = 1;
+    cut.sense = 'G';
+    cut.rhs = std::ceil(relaxation.objective);
+    cut.violation = 1 - diff;
+    cut.local = true;
+    cuts.push_back(cut);
+  }
+}
+
+
+void Separators::genCutsFromCliquePool(const Relaxation &relaxation, std::vector<Cut> &cuts) {
+
+  int p, clique, ci;  // period, clique and index within
+  std::vector< std::vector<int> > &cs = conflictGraph.cliques;
+
+  for(p = 0; p < instance.getPeriodCount(); p++)
+    for(clique = 0; clique < cs.size(); clique++) {
+      float value = 0;   // sum for the clique in the present LP relaxation
+      for(ci = 0; ci < cs.at(clique).size(); ci++)
+        value += relaxation.x[cs[clique][ci]][p];
+      // Do you want to add the cut?
+      if (value <= 1) continue;
+      CliqueCutIdentifier id(p, clique);
+      if (cliquePool.find(id) != cliquePool.end()) continue;
+      Cut cut(CliquePoolCuts);
+      cut.key[0] = p; cut.key[1] = clique;
+      for(ci = 0; ci < cs.at(clique).size(); ci++)
+        cut.addTerm(cs[clique][ci], p, 1);
+      cut.rhs = 1;
+      cut.violation = value - 1;
+      cuts.push_back(cut);
+      cliquePool[id] = true;
+    }
+}
+
+
+void Separators::genCutsFromTriangles(const Relaxation &relaxation, std::vector<Cut> &cuts) {
+
+  int p;  // period
+  std::vector<Vertex> &vs = conflictGraph.vs;
+
+  for (int u = 0; u < vs.size(); u++)
+    for (std::set<int>::iterator vi = vs[u].adj.begin(); vi != vs[u].adj.end(); vi++)
+      if (u < (*vi))
+        for (std::set<int>::iterator wi = vs[*vi].adj.begin(); wi != vs[*vi].adj.end(); wi++)
+          if ((*vi < (*wi)) && (vs[(*wi)].adj.find(u) != vs[(*wi)].adj.end()))
+            for(p = 0; p < instance.getPeriodCount(); p++) {
+              float value = relaxation.x[u][p] + relaxation.x[*vi][p] + relaxation.x[*wi][p];
+              if (value <= 1.01) continue;  // TODO: improve upon this
+              Cut cut(TriangleCuts);
+              cut.key[0] = p; cut.key[1] = u; cut.key[2] = *vi; cut.key[3] = *wi;
+              cut.addTerm(u, p, 1);
+              cut.addTerm(*vi, p, 1);
+              cut.addTerm(*wi, p, 1);
+              cut.rhs = 1;
+              cut.violation = value - 1;
+              cuts.push_back(cut);
+            }
+}
+
+
+/*  Adds (most of the time redundant) cuts of the form:
+forall (c in Courses, d in Days)
+sum (p in HasPeriods[d], r in Rooms)
+Taught[p][r][c] <= 1 + CourseInfo[c].events + CourseMinDayViolations[c] - CourseInfo[c].minDays;
+*/
+void Separators::genCutsFromMindaysChecks(const Relaxation &relaxation, std::vector<Cut> &cuts) {
+
+  int c, d, pd;  // course, day, period within a day
+  int periodsPerDay = instance.getPeriodsPerDayCount();
+
+  for(c = 0; c < instance.getCourseCount(); c++)
+    for(d = 0; d < instance.getDayCount(); d++) {
+      float lhsValue = 0;
+      for (pd = 0; pd < periodsPerDay; pd++)
+        lhsValue += relaxation.x[c][d * periodsPerDay + pd];
+      int constant = 1 + instance.getCourse(c).lectures - instance.getCourse(c).minWorkingDays;
+      float rhsValue = constant + relaxation.minDayViolations[c];
+      if (lhsValue > rhsValue + 0.001) {
+        Cut cut(MindaysCuts);
+        cut.key[0] = c; cut.key[1] = d;
+        for (pd = 0; pd < periodsPerDay; pd++)
+          cut.addTerm(c, d * periodsPerDay + pd, 1);
+        cut.slack = MinDaySlack;
+        cut.slackIndex = c;
+        cut.slackCoefficient = -1;
+        cut.rhs = constant;
+        cut.violation = lhsValue - rhsValue;
+        cuts.push_back(cut);
+      }
+    }
+}
+
+
+/*  Adds (most of the time unnecessary) cuts of the form:
+*    forall (cu in Curricula)
+*    sum (c in CurriculumHasCourses[cu], p in Periods, r in Rooms)
+*    Taught[p][r][c] == CurriculumHasEventsCount[cu];
+*/
+void Separators::genCutsFromCurriculumChecks(const Relaxation &relaxation, std::vector<Cut> &cuts) {
+
+  int u, ui, p;  // curriculum, index within, period
+
+  for(u = 0; u < instance.getCurriculumCount(); u++) {
+    const std::vector<int> &courseIds = instance.getCurriculum(u).courseIds;
+
+    float has = 0;
+    float shouldHave = 0;
+    for (ui = 0; ui < courseIds.size(); ui++) {
+      int c = courseIds.at(ui);
+      shouldHave += instance.getCourse(c).lectures;
+      for(p = 0; p < instance.getPeriodCount(); p++)
+        has += relaxation.x[c][p];
+    }
+
+    if (std::fabs(shouldHave - has) > 0.001) {
+      Cut cut(CurriculumCuts);
+      cut.key[0] = u;
+      for (ui = 0; ui < courseIds.size(); ui++)
+        for(p = 0; p < instance.getPeriodCount(); p++)
+          cut.addTerm(courseIds.at(ui), p, 1);
+      cut.sense = 'E';
+      cut.rhs = shouldHave;
+      cut.violation = std::fabs(shouldHave - has);
+      cuts.push_back(cut);
+    }
+  }
+}
+
+
+/*  Adds the cuts of the form:
+*    forall (cu in ProperCurricula, d in Days, pattern in Patterns)
+*    penalty * (sum (pd in PeriodsPerDay) coefs[pd] * sum (c in cu, r in Rooms) Taught[p][r][c] + 1 - rhs)
+*    <= singletonChecks[cu][d]
+*/
+void Separators::genCutsFromPatterns(const Relaxation &relaxation, std::vector<Cut> &cuts) {
+
+  int u, ui, d, pd;     // curriculum, index within, day, period within
+  int pati;             // pati for index within patterns
+  int periodsPerDay = instance.getPeriodsPerDayCount();
+  std::vector<float> factors(periodsPerDay);
+
+  for(u = 0; u < instance.getProperCurriculumCount(); u++) {
+    const std::vector<int> &courseIds = instance.getCurriculum(u).courseIds;
+    for(d = 0; d < instance.getDayCount(); d++) {
+      // Get the current penalties, which are fixed across all patterns
+      float rhs = relaxation.curriculumDays[u * instance.getDayCount() + d];
+
+      // The curriculum summed over its courses, in each period of the day
+      for (pd = 0; pd < periodsPerDay; pd++) {
+        int p = d * periodsPerDay + pd;
+        float factor = 0;
+        for (ui = 0; ui < courseIds.size(); ui++)
+          factor += relaxation.x[courseIds.at(ui)][p];
+        factors[pd] = factor;
+      }
+
+      // Compute the LHS for each pattern
+      for (pati = 0; pati < patterns.size(); pati++) {
+        float lhs = 0;
+        for (pd = 0; pd < periodsPerDay; pd++)
+          lhs += patterns[pati].coefs[pd] * factors[pd];
+        lhs += 1 - patterns[pati].rhs;
+        lhs *= patterns[pati].penalty;
+
+        // If the constraint is violated, add the cut
+        if (lhs - rhs > 0.001) {
+          Cut cut(PatternCuts);
+          cut.key[0] = u; cut.key[1] = d; cut.key[2] = pati;
+          for (ui = 0; ui < courseIds.size(); ui++)
+            for (pd = 0; pd < periodsPerDay; pd++)
+              if (patterns[pati].coefs[pd] != 0)
+                cut.addTerm(courseIds.at(ui), d * periodsPerDay + pd, patterns[pati].penalty * patterns[pati].coefs[pd]);
+          cut.slack = CurriculumDaySlack;
+          cut.slackIndex = u * instance.getDayCount() + d;
+          cut.slackCoefficient = -1;
+          cut.rhs = patterns[pati].penalty * (patterns[pati].rhs - 1);
+          cut.violation = lhs - rhs;
+          cuts.push_back(cut);
+        }
+      }
+    }
+  }
+}
+
+
+/*  Adds the links of x to the rooms and the days of the course, one at a time,
+*  which the formulation may only have summed over the periods, or the day:
+*    courseRooms[c][r] >= x[p][r][c]                          forall (c, r, p)
+*    courseDays[c][d] >= sum (r in Rooms) x[p][r][c]           forall (c, d, p in d)
+*  only the most violated period of each course and room, or course and day.
+*  The scan of x runs over the rooms and courses of a period, as they lie in vars.xs.
+*/
+void Separators::genCutsFromLinking(const Relaxation &relaxation, std::vector<Cut> &cuts) {
+
+  if (!relaxation.xs || relaxation.courseRooms.empty() || relaxation.courseDays.empty()) return;
+  int C = instance.getCourseCount(), R = instance.getRoomCount(), D = instance.getDayCount();
+  int periodsPerDay = instance.getPeriodsPerDayCount();
+  const std::vector<float> &xs = *relaxation.xs;
+  int c, r, d, p, pd, k;  // course, room, day, period, period within, index
+
+  // The largest x[p][r][c] over the periods, at r * courses + c
+  std::vector<float> largest(R * C, 0);
+  std::vector<int> at(R * C, 0);
+  for (p = 0; p < instance.getPeriodCount(); p++) {
+    const float *row = &xs[p * R * C];
+    for (k = 0; k < R * C; k++)
+      if (row[k] > largest[k]) {
+        largest[k] = row[k];
+        at[k] = p;
+      }
+  }
+  for (k = 0; k < R * C; k++) {
+    float violation = largest[k] - relaxation.courseRooms[k];
+    if (violation <= 0.001) continue;
+    c = k % C; r = k / C;
+    Cut cut(LinkingCuts);
+    cut.key[0] = 0; cut.key[1] = c; cut.key[2] = r; cut.key[3] = at[k];
+    cut.room = r;
+    cut.addTerm(c, at[k], 1);
+    cut.slack = CourseRoomSlack;
+    cut.slackIndex = k;
+    cut.slackCoefficient = -1;
+    cut.rhs = 0;
+    cut.violation = violation;
+    cuts.push_back(cut);
+  }
+
+  for (c = 0; c < C; c++)
+    for (d = 0; d < D; d++) {
+      const float *day = &relaxation.x[c][d * periodsPerDay];
+      int worst = 0;
+      for (pd = 1; pd < periodsPerDay; pd++)
+        if (day[pd] > day[worst]) worst = pd;
+      float violation = day[worst] - relaxation.courseDays[d * C + c];
+      if (violation <= 0.001) continue;
+      Cut cut(LinkingCuts);
+      cut.key[0] = 1; cut.key[1] = c; cut.key[2] = d; cut.key[3] = worst;
+      cut.addTerm(c, d * periodsPerDay + worst, 1);
+      cut.slack = CourseDaySlack;
+      cut.slackIndex = d * C + c;
+      cut.slackCoefficient = -1;
+      cut.rhs = 0;
+      cut.violation = violation;
+      cuts.push_back(cut);
+    }
+}
@@ -0,0 +1,100 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_SEPARATORS
+#define UDINE_SEPARATORS
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "loader.h"
+#include "conflicts.h"
+#include "scheduler.h"
+
+// For clique cuts
+typedef std::pair<int, int> CliqueCutIdentifier;  // period, clique
+typedef std::map<CliqueCutIdentifier, bool> CliquePool;
+
+// The LP relaxation as the separators see it
+struct Relaxation {
+  std::vector< std::vector<float> > x;  // x summed over rooms, access using x[c][p]
+  std::vector<float> curriculumDays;    // singletonChecks[u][d][0] at u * days + d, of the proper curricula
+  std::vector<float> minDayViolations;  // courseMinDayViolations[c]
+  const std::vector<float> *xs;         // x[p][r][c] as given to setX, for the linking rows
+  std::vector<float> courseRooms;       // courseRooms[c][r] at r * courses + c, if the links are separated
+  std::vector<float> courseDays;        // courseDays[c][d] at d * courses + c, likewise
+  double bound, objective;              // the best bound and that of the node
+
+  Relaxation() : xs(0), bound(0), objective(0) {}
+
+  // Sums x[p][r][c], given at (p * rooms + r) * courses + c, over the rooms
+  void setX(TimetablingInstance &instance, const std::vector<float> &xs);
+};
+
+enum CutSlack {
+  NoSlack,
+  CurriculumDaySlack,   // singletonChecks[u][d][0] with index u * days + d
+  MinDaySlack,          // courseMinDayViolations[c] with index c
+  ObjectiveSlack,       // the objective
+  CourseRoomSlack,      // courseRooms[c][r] with index r * courses + c
+  CourseDaySlack        // courseDays[c][d] with index d * courses + c
+};
+
+/* A violated inequality
+*   sum coefficients[t] * (sum over rooms of x[periods[t]][r][courses[t]]) + slackCoefficient * slack  sense  rhs
+* with the sense one of 'L', 'E' and 'G', or with x[periods[t]][room][courses[t]] alone, if room is not -1.
+* The key tells it from the other cuts of its family.
+*/
+struct Cut {
+  int family;
+  int key[4];
+  int room;
+  std::vector<int> courses, periods;
+  std::vector<double> coefficients;
+  int slack, slackIndex;
+  double slackCoefficient;
+  char sense;
+  double rhs;
+  double violation;
+  bool local;           // only valid at the node
+
+  Cut(int f);
+  void addTerm(int course, int period, double coefficient);
+};
+
+/* The separation of each family of cuts, without CPLEX, so that it can be replayed
+* on recorded relaxations. The clique pool keeps the cliques added so far.
+*/
+class Separators {
+protected:
+  TimetablingInstance &instance;
+  Graph &conflictGraph;
+  PatternDB patterns;
+  CliquePool cliquePool;
+
+public:
+  Separators(TimetablingInstance &i, Graph &g);
+
+  // Appends the cuts of the family violated by the relaxation
+  void separate(int family, const Relaxation &relaxation, std::vector<Cut> &cuts);
+
+  void genCutsFromObjIntegrality(const Relaxation &relaxation, std::vector<Cut> &cuts);
+  void genCutsFromCliquePool(const Relaxation &relaxation, std::vector<Cut> &cuts);
+  void genCutsFromTriangles(const Relaxation &relaxation, std::vector<Cut> &cuts);
+  void genCutsFromPatterns(const Relaxation &relaxation, std::vector<Cut> &cuts);
+  void genCutsFromMindaysChecks(const Relaxation &relaxation, std::vector<Cut> &cuts);
+  void genCutsFromCurriculumChecks(const Relaxation &relaxation, std::vector<Cut> &cuts);
+  void genCutsFromLinking(const Relaxation &relaxation, std::vector<Cut> &cuts);
+};
+
+#endif // UDINE_SEPARATORS
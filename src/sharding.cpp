@@ -0,0 +1,144 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <algorithm>
+#include <sstream>
+
+#include "sharding.h"
+
+static const char *splitNames[ShardSplitCount] = { "mindays", "rooms", "days" };
+
+
+const char *getSplitName(int split) {
+  return (split >= 0 && split < ShardSplitCount) ? splitNames[split] : "unknown";
+}
+
+
+bool getSplitByName(const std::string &name, int &split) {
+  for (int s = 0; s < ShardSplitCount; s++)
+    if (name == splitNames[s]) {
+      split = s;
+      return true;
+    }
+  return false;
+}
+
+
+static ShardFixing getFixing(int kind, int course, int index, double lower, double upper) {
+  ShardFixing fixing;
+  fixing.kind = kind;
+  fixing.course = course;
+  fixing.index = index;
+  fixing.lower = lower;
+  fixing.upper = upper;
+  return fixing;
+}
+
+
+// The violations of the course with the most minimum working days: 0, 1, ..., and the rest
+static void splitMinDays(TimetablingInstance &instance, int count, std::vector<Shard> &shards) {
+  int best = 0;
+  for (int c = 1; c < instance.getCourseCount(); c++) {
+    const Course &course = instance.getCourse(c), &other = instance.getCourse(best);
+    if (course.minWorkingDays > other.minWorkingDays
+      || (course.minWorkingDays == other.minWorkingDays && course.lectures > other.lectures)) best = c;
+  }
+  // At least one day is always worked
+  int values = std::max(1, instance.getCourse(best).minWorkingDays);
+  count = std::max(1, std::min(count, values));
+  for (int k = 0; k < count; k++) {
+    Shard shard;
+    shard.index = k;
+    std::ostringstream description;
+    description << "min working days of " << instance.getCourse(best).name << " violated ";
+    if (k + 1 < count) {
+      shard.fixings.push_back(getFixing(MinDayViolationsFixing, best, 0, k, k));
+      description << k << " times";
+    } else {
+      shard.fixings.push_back(getFixing(MinDayViolationsFixing, best, 0, k, instance.getDayCount()));
+      description << k << " or more times";
+    }
+    shard.description = description.str();
+    shards.push_back(shard);
+  }
+}
+
+
+// The first of the largest rooms the largest course uses: the largest, the next, ..., or none of those
+static void splitRooms(TimetablingInstance &instance, int count, std::vector<Shard> &shards) {
+  int largest = 0;
+  for (int c = 1; c < instance.getCourseCount(); c++)
+    if (instance.getCourse(c).students > instance.getCourse(largest).students) largest = c;
+  std::vector< std::pair<int, int> > rooms;
+  for (int r = 0; r < instance.getRoomCount(); r++)
+    rooms.push_back(std::make_pair(-instance.getRoom(r).capacity, r));
+  std::sort(rooms.begin(), rooms.end());
+  count = std::max(1, std::min<int>(count, rooms.size()));
+  for (int k = 0; k < count; k++) {
+    Shard shard;
+    shard.index = k;
+    std::ostringstream description;
+    description << instance.getCourse(largest).name;
+    for (int j = 0; j < k; j++) shard.fixings.push_back(getFixing(CourseRoomFixing, largest, rooms[j].second, 0, 0));
+    if (k + 1 < count) {
+      shard.fixings.push_back(getFixing(CourseRoomFixing, largest, rooms[k].second, 1, 1));
+      description << " in " << instance.getRoom(rooms[k].second).name;
+      if (k > 0) description << " and not in the " << k << " larger rooms";
+    } else if (k > 0) description << " not in the " << k << " largest rooms";
+    shard.description = description.str();
+    shards.push_back(shard);
+  }
+}
+
+
+// Whether the busiest course of the busiest curriculum is taught on each of the first few days
+static void splitDays(TimetablingInstance &instance, int count, std::vector<Shard> &shards) {
+  int busiest = 0, load = -1;
+  for (int u = 0; u < instance.getProperCurriculumCount(); u++) {
+    const CourseIds &courses = instance.getCurriculum(u).courseIds;
+    int lectures = 0;
+    for (size_t i = 0; i < courses.size(); i++) lectures += instance.getCourse(courses[i]).lectures;
+    if (lectures <= load) continue;
+    load = lectures;
+    busiest = courses.front();
+    for (size_t i = 1; i < courses.size(); i++)
+      if (instance.getCourse(courses[i]).lectures > instance.getCourse(busiest).lectures) busiest = courses[i];
+  }
+  if (load < 0)
+    for (int c = 1; c < instance.getCourseCount(); c++)
+      if (instance.getCourse(c).lectures > instance.getCourse(busiest).lectures) busiest = c;
+
+  int days = 0;
+  while (days < instance.getDayCount() && (2 << days) <= count) days += 1;
+  for (int k = 0; k < (1 << days); k++) {
+    Shard shard;
+    shard.index = k;
+    std::ostringstream description;
+    description << instance.getCourse(busiest).name << " on days";
+    for (int d = 0; d < days; d++) {
+      int on = (k >> d) & 1;
+      shard.fixings.push_back(getFixing(CourseDayFixing, busiest, d, on, on));
+      description << " " << d << (on ? "+" : "-");
+    }
+    if (days == 0) description << " any";
+    shard.description = description.str();
+    shards.push_back(shard);
+  }
+}
+
+
+void partitionSearch(TimetablingInstance &instance, int split, int count, std::vector<Shard> &shards) {
+  shards.clear();
+  if (instance.getCourseCount() == 0) return;
+  if (split == RoomSplit) splitRooms(instance, count, shards);
+  else if (split == DaysSplit) splitDays(instance, count, shards);
+  else splitMinDays(instance, count, shards);
+}
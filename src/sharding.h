@@ -0,0 +1,56 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_SHARDING
+#define UDINE_SHARDING
+
+#include <string>
+#include <vector>
+
+#include "loader.h"
+
+enum ShardSplit {
+  MinDaysSplit,     // on the violations of the minimum working days of the course with the most
+  RoomSplit,        // on the room the largest course uses first, of the largest rooms
+  DaysSplit,        // on the days of the busiest course of the busiest curriculum
+  ShardSplitCount
+};
+
+const char *getSplitName(int split);
+bool getSplitByName(const std::string &name, int &split);
+
+enum ShardFixingKind {
+  MinDayViolationsFixing,   // courseMinDayViolations[course]
+  CourseRoomFixing,         // courseRooms[course][index]
+  CourseDayFixing           // courseDays[course][index]
+};
+
+// The bounds a shard puts on one of the structural variables of the model
+struct ShardFixing {
+  int kind, course, index;
+  double lower, upper;
+};
+
+struct Shard {
+  int index;
+  std::string description;
+  std::vector<ShardFixing> fixings;
+};
+
+/* Splits the search space of an instance into disjoint parts, which together
+* cover all of it, so that the least of their bounds is a bound on the whole.
+* There are at most as many parts as asked for, and fewer if the structure
+* split on does not allow for as many, e.g. a course with fewer rooms, or
+* a power of two of the days.
+*/
+void partitionSearch(TimetablingInstance &instance, int split, int count, std::vector<Shard> &shards);
+
+#endif // UDINE_SHARDING
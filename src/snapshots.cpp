@@ -0,0 +1,172 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstring>
+
+#include "snapshots.h"
+
+static const char snapshotMagic[8] = { 'U', 'D', 'S', 'N', 'A', 'P', '3', 0 };
+
+
+bool CutKey::operator<(const CutKey &other) const {
+  if (family != other.family) return family < other.family;
+  for (int k = 0; k < 4; k++)
+    if (key[k] != other.key[k]) return key[k] < other.key[k];
+  return false;
+}
+
+
+bool CutKey::operator==(const CutKey &other) const {
+  return !(*this < other) && !(other < *this);
+}
+
+
+void Snapshot::getRelaxation(TimetablingInstance &instance, Relaxation &relaxation) const {
+  relaxation.setX(instance, xs);
+  relaxation.curriculumDays = curriculumDays;
+  relaxation.minDayViolations = minDayViolations;
+  relaxation.courseRooms = courseRooms;
+  relaxation.courseDays = courseDays;
+  relaxation.bound = bound;
+  relaxation.objective = objective;
+}
+
+
+SnapshotFile::SnapshotFile() : file(0), writing(false) {}
+
+
+SnapshotFile::~SnapshotFile() {
+  close();
+}
+
+
+void SnapshotFile::close() {
+  if (file) fclose(file);
+  file = 0;
+}
+
+
+bool SnapshotFile::create(const std::string &path, TimetablingInstance &instance) {
+  close();
+  file = fopen(path.c_str(), "wb");
+  if (!file) return false;
+  writing = true;
+  periods = instance.getPeriodCount();
+  rooms = instance.getRoomCount();
+  courses = instance.getCourseCount();
+  curricula = instance.getProperCurriculumCount();
+  days = instance.getDayCount();
+  int dimensions[5] = { periods, rooms, courses, curricula, days };
+  fwrite(snapshotMagic, sizeof(snapshotMagic), 1, file);
+  fwrite(dimensions, sizeof(int), 5, file);
+  return true;
+}
+
+
+bool SnapshotFile::open(const std::string &path, TimetablingInstance &instance) {
+  close();
+  file = fopen(path.c_str(), "rb");
+  if (!file) return false;
+  writing = false;
+  char magic[8];
+  int dimensions[5];
+  if (fread(magic, sizeof(magic), 1, file) != 1 || std::memcmp(magic, snapshotMagic, sizeof(magic)) != 0
+    || fread(dimensions, sizeof(int), 5, file) != 5) {
+      close();
+      return false;
+  }
+  periods = dimensions[0]; rooms = dimensions[1]; courses = dimensions[2];
+  curricula = dimensions[3]; days = dimensions[4];
+  if (periods != instance.getPeriodCount() || rooms != instance.getRoomCount() || courses != instance.getCourseCount()
+    || curricula != instance.getProperCurriculumCount() || days != instance.getDayCount()) {
+      close();
+      return false;
+  }
+  return true;
+}
+
+
+bool SnapshotFile::write(const Snapshot &s) {
+  boost::mutex::scoped_lock l(lock);
+  if (!file || !writing) return false;
+  int header[5] = { s.thread, s.call, s.nodes, s.depth, s.families };
+  double bounds[2] = { s.bound, s.objective };
+  fwrite(header, sizeof(int), 5, file);
+  fwrite(bounds, sizeof(double), 2, file);
+
+  std::vector<int> indices;
+  std::vector<float> values;
+  for (size_t k = 0; k < s.xs.size(); k++)
+    if (s.xs[k] != 0) {
+      indices.push_back(k);
+      values.push_back(s.xs[k]);
+    }
+  int nonzeros = indices.size();
+  fwrite(&nonzeros, sizeof(int), 1, file);
+  if (nonzeros > 0) {
+    fwrite(&indices[0], sizeof(int), nonzeros, file);
+    fwrite(&values[0], sizeof(float), nonzeros, file);
+  }
+  if (!s.curriculumDays.empty()) fwrite(&s.curriculumDays[0], sizeof(float), curricula * days, file);
+  if (!s.minDayViolations.empty()) fwrite(&s.minDayViolations[0], sizeof(float), courses, file);
+  int linking[2] = { int(s.courseRooms.size()), int(s.courseDays.size()) };
+  fwrite(linking, sizeof(int), 2, file);
+  if (linking[0] > 0) fwrite(&s.courseRooms[0], sizeof(float), linking[0], file);
+  if (linking[1] > 0) fwrite(&s.courseDays[0], sizeof(float), linking[1], file);
+
+  int cuts = s.cuts.size();
+  fwrite(&cuts, sizeof(int), 1, file);
+  for (int i = 0; i < cuts; i++) {
+    fwrite(&s.cuts[i].family, sizeof(int), 1, file);
+    fwrite(s.cuts[i].key, sizeof(int), 4, file);
+  }
+  return !ferror(file);
+}
+
+
+bool SnapshotFile::read(Snapshot &s) {
+  if (!file || writing) return false;
+  int header[5];
+  double bounds[2];
+  if (fread(header, sizeof(int), 5, file) != 5 || fread(bounds, sizeof(double), 2, file) != 2) return false;
+  s.thread = header[0]; s.call = header[1]; s.nodes = header[2]; s.depth = header[3]; s.families = header[4];
+  s.bound = bounds[0]; s.objective = bounds[1];
+
+  int nonzeros;
+  if (fread(&nonzeros, sizeof(int), 1, file) != 1 || nonzeros < 0) return false;
+  std::vector<int> indices(nonzeros);
+  std::vector<float> values(nonzeros);
+  if (nonzeros > 0 && (fread(&indices[0], sizeof(int), nonzeros, file) != size_t(nonzeros)
+    || fread(&values[0], sizeof(float), nonzeros, file) != size_t(nonzeros))) return false;
+  s.xs.assign(periods * rooms * courses, 0);
+  for (int i = 0; i < nonzeros; i++) {
+    if (indices[i] < 0 || indices[i] >= int(s.xs.size())) return false;
+    s.xs[indices[i]] = values[i];
+  }
+  s.curriculumDays.resize(curricula * days);
+  s.minDayViolations.resize(courses);
+  if (fread(&s.curriculumDays[0], sizeof(float), curricula * days, file) != size_t(curricula * days)
+    || fread(&s.minDayViolations[0], sizeof(float), courses, file) != size_t(courses)) return false;
+  int linking[2];
+  if (fread(linking, sizeof(int), 2, file) != 2 || (linking[0] != 0 && linking[0] != rooms * courses)
+    || (linking[1] != 0 && linking[1] != days * courses)) return false;
+  s.courseRooms.resize(linking[0]);
+  s.courseDays.resize(linking[1]);
+  if ((linking[0] > 0 && fread(&s.courseRooms[0], sizeof(float), linking[0], file) != size_t(linking[0]))
+    || (linking[1] > 0 && fread(&s.courseDays[0], sizeof(float), linking[1], file) != size_t(linking[1]))) return false;
+
+  int cuts;
+  if (fread(&cuts, sizeof(int), 1, file) != 1 || cuts < 0) return false;
+  s.cuts.resize(cuts);
+  for (int i = 0; i < cuts; i++)
+    if (fread(&s.cuts[i].family, sizeof(int), 1, file) != 1 || fread(s.cuts[i].key, sizeof(int), 4, file) != 4) return false;
+  return true;
+}
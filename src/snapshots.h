@@ -0,0 +1,73 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_SNAPSHOTS
+#define UDINE_SNAPSHOTS
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include "separators.h"
+
+// A cut as recorded: its family and its key within the family
+struct CutKey {
+  int family;
+  int key[4];
+  bool operator<(const CutKey &other) const;
+  bool operator==(const CutKey &other) const;
+};
+
+/* What the cut manager saw at one call: the relaxation, with x in the order of
+* vars.xs, the node, the families it separated (a bit each) and the cuts they found.
+* The thread is as the telemetry counts them; each thread of CPLEX has a clone
+* of the cut manager, with a clique pool of its own. The rooms and days of the
+* courses are there only if the linking rows were separated, as in Relaxation.
+*/
+struct Snapshot {
+  int thread, call, nodes, depth, families;
+  double bound, objective;
+  std::vector<float> xs, curriculumDays, minDayViolations;
+  std::vector<float> courseRooms, courseDays;
+  std::vector<CutKey> cuts;
+
+  void getRelaxation(TimetablingInstance &instance, Relaxation &relaxation) const;
+};
+
+/* A binary file of snapshots of one instance: a header with the dimensions,
+* then the snapshots, with only the non-zeros of x, as index and value pairs,
+* and the rooms and days of the courses, each preceded by their number, if any.
+* Written from any thread of CPLEX, hence locked.
+*/
+class SnapshotFile {
+protected:
+  FILE *file;
+  bool writing;
+  int periods, rooms, courses, curricula, days;
+  boost::mutex lock;
+
+public:
+  SnapshotFile();
+  ~SnapshotFile();
+
+  bool create(const std::string &path, TimetablingInstance &instance);
+  // False if it is not a snapshot file of an instance of the same dimensions
+  bool open(const std::string &path, TimetablingInstance &instance);
+  void close();
+
+  bool write(const Snapshot &snapshot);
+  // False at the end of the file
+  bool read(Snapshot &snapshot);
+};
+
+#endif // UDINE_SNAPSHOTS
@@ -10,7 +10,12 @@
 */
 
 #pragma warning(disable : 4018) 
+#include <algorithm>
+#include <cstdlib>
+
 #include "solver.h"
+#include "timetable.h"
+#include "evaluator.h"
 
 TimetablingVariables::TimetablingVariables(IloEnv env, TimetablingInstance &i, bool subMIP, bool useCoursePeriods)
 : x(IloArray< IloArray<IloNumVarArray> >(env, i.getPeriodCount())),
@@ -19,7 +24,8 @@ courseDays(IloArray<IloNumVarArray>(env, i.getCourseCount())),
 courseRooms(IloArray<IloNumVarArray>(env, i.getCourseCount())),
 coursePeriods(IloArray<IloNumVarArray>(env, i.getCourseCount())),
 singletonChecks(IloArray< IloArray<IloNumVarArray> >(env, i.getCurriculumCount())),
-all(env)
+all(env),
+xs(env)
 {
 
   int p, d, r, c, u;  // periods, days, rooms, courses, curricula
@@ -36,6 +42,7 @@ all(env)
         IloNumVar var(env, 0, 1, IloNumVar::Bool, name.str().c_str());
         forRoom.add(var);
         all.add(var);
+        xs.add(var);
       }
       forPeriod[r] = forRoom;
     }
@@ -93,6 +100,9 @@ all(env)
     }
     singletonChecks[u] = forCurriculum;
   }
+
+  // ... which are created first, but go last, so that x comes first in all
+  all.add(courseMinDayViolations);
 }
 
 
@@ -127,12 +137,13 @@ void TimetablingSolver::generateConstraints(TimetablingInstance &i) {
       sum.end();
     }
 
-    // Lectures in one curriculum must be scheduled at different times
+    // Lectures in one curriculum must be scheduled at different times,
+    // as generated for the cliques covering the conflicts of the curricula
     for (p = 0; p < i.getPeriodCount(); p++)
-      for (u = 0; u < i.getCurriculumCount(); u++) {
+      for (u = 0; u < i.getConflictCount(); u++) {
         IloExpr sum(env);
-        for (ui = 0; ui < i.getCurriculum(u).courseIds.size(); ui++) {
-          IloInt c = i.getCurriculum(u).courseIds.at(ui);
+        for (ui = 0; ui < i.getConflict(u).courseIds.size(); ui++) {
+          IloInt c = i.getConflict(u).courseIds.at(ui);
           for (r = 0; r < i.getRoomCount(); r++)
             sum += vars.x[p][r][c];
         }
@@ -154,11 +165,17 @@ void TimetablingSolver::generateConstraints(TimetablingInstance &i) {
       }
 
       // (SOFT) The lectures of each course should be held all in a single room
-      // Mark the rooms where the lectures of the course are held
+      // Mark the rooms where the lectures of the course are held, one period at a time,
+      // unless the registry keeps these links elsewhere, when Andrew's bound links them alone
+      IloNum start = env.getTime();
+      IloInt linking = constraints.getSize();
+      bool linkingStatic = registry.getMode(LinkingCuts) == StaticCuts;
+      if (linkingStatic)
       for (c = 0; c < i.getCourseCount(); c++)
         for (r = 0; r < i.getRoomCount(); r++)
           for (p = 0; p < i.getPeriodCount(); p++)
             constraints.add(vars.courseRooms[c][r] - vars.x[p][r][c] >= 0);
+      linking = constraints.getSize() - linking;
       // NEW: Andrew's bound
       for (c = 0; c < i.getCourseCount(); c++)
         for (r = 0; r < i.getRoomCount(); r++) {
@@ -187,10 +204,21 @@ void TimetablingSolver::generateConstraints(TimetablingInstance &i) {
 
           // Mark the periods where the lectures of the course are held
           if (useCoursePeriods) {
+            // ... in each room, or summed over the rooms, which is as strong, as a course takes one room at a time
+            if (linkingStatic)
             for (c = 0; c < i.getCourseCount(); c++)
               for (r = 0; r < i.getRoomCount(); r++)
                 for (p = 0; p < i.getPeriodCount(); p++)
                   constraints.add(vars.coursePeriods[c][p] - vars.x[p][r][c] >= 0);
+            else
+            for (c = 0; c < i.getCourseCount(); c++)
+              for (p = 0; p < i.getPeriodCount(); p++) {
+                IloExpr sum(env);
+                for (r = 0; r < i.getRoomCount(); r++) 
+                  sum += vars.x[p][r][c];
+                constraints.add(vars.coursePeriods[c][p] - sum >= 0);
+                sum.end();
+              }
             for (c = 0; c < i.getCourseCount(); c++)
               for (p = 0; p < i.getPeriodCount(); p++) {
                 IloExpr sum(env);
@@ -210,19 +238,29 @@ void TimetablingSolver::generateConstraints(TimetablingInstance &i) {
           }
 
             // (SOFT) The lectures of each course should be spread onto a given minimum number of days
-            // Mark the days when the course has lectures in the schedule
+            // Mark the days when the course has lectures in the schedule, one period at a time,
+            // unless the registry keeps these links elsewhere, when they are summed over the day
             for (c = 0; c < i.getCourseCount(); c++)
-              for (d = 0; d < i.getDayCount(); d++)
+              for (d = 0; d < i.getDayCount(); d++) {
+                IloExpr daySum(env);
                 for (p = d * i.getPeriodsPerDayCount();
                   p < (d + 1) * i.getPeriodsPerDayCount(); p++) {
                     IloExpr sum(env);
                     for (r = 0; r < i.getRoomCount(); r++) 
                       sum += vars.x[p][r][c];
-                    constraints.add(sum - vars.courseDays[c][d] <= 0);
+                    if (linkingStatic) {
+                      constraints.add(sum - vars.courseDays[c][d] <= 0);
+                      linking += 1;
+                    } else daySum += sum;
                     sum.end();
                     if (useCoursePeriods)
                       constraints.add(vars.coursePeriods[c][p] - vars.courseDays[c][d] <= 0);
                 }
+                if (!linkingStatic)
+                  constraints.add(daySum - std::min(i.getPeriodsPerDayCount(), i.getCourse(c).lectures) * vars.courseDays[c][d] <= 0);
+                daySum.end();
+              }
+            if (linkingStatic) registry.recordBuild(LinkingCuts, linking, 1000 * (env.getTime() - start));
                 for (c = 0; c < i.getCourseCount(); c++)
                   for (d = 0; d < i.getDayCount(); d++) {
                     IloExpr sum(env);
@@ -336,17 +374,54 @@ void TimetablingSolver::generateConstraints(TimetablingInstance &i) {
 }  // END TimetablingSolver::generateConstraints
 
 
-// A little debugging helper
+// Each family the registry does not leave to the cut manager goes into the model or a pool
 void TimetablingSolver::generateCutsStatically(TimetablingInstance &i) {
+  for (int family = 0; family < CutFamilyCount; family++) {
+    if (!registry.isEnumerated(family)) continue;
+    // The static links are part of the formulation, see generateConstraints
+    if (family == LinkingCuts && registry.getMode(family) == StaticCuts) continue;
+    IloNum start = env.getTime();
+    IloRangeArray cuts(env);
+    generateCuts(i, family, cuts);
+    if (registry.getMode(family) == StaticCuts) model.add(cuts);
+    else if (registry.getMode(family) == LazyCuts) lazyCuts.add(cuts);
+    else userCuts.add(cuts);
+    registry.recordBuild(family, cuts.getSize(), 1000 * (env.getTime() - start));
+    std::cout << "Mycuts: Enumerated " << cuts.getSize() << " " << getCutFamilyName(family)
+      << " cut(s) as " << getCutModeName(registry.getMode(family)) << std::endl;
+  }
+}
+
+
+void TimetablingSolver::addCutPools(IloCplex &cplex) {
+  if (lazyCuts.getSize() > 0) cplex.addLazyConstraints(lazyCuts);
+  if (userCuts.getSize() > 0) cplex.addUserCuts(userCuts);
+}
 
-  bool minDays = false; // false;
-  bool curriculumChecks = false; // false;
-  bool patternsEnumeration = true;
-  bool triangles = false;
-  bool cliquePool = false;
+
+// The same cuts the separators look for, all of them
+void TimetablingSolver::generateCuts(TimetablingInstance &i, int family, IloRangeArray &cuts) {
+
+  // The links generateConstraints leaves out, as Separators::genCutsFromLinking finds them
+  if (family == LinkingCuts) {
+    int c, r, d, p;
+    for (c = 0; c < i.getCourseCount(); c++)
+      for (r = 0; r < i.getRoomCount(); r++)
+        for (p = 0; p < i.getPeriodCount(); p++)
+          cuts.add(vars.courseRooms[c][r] - vars.x[p][r][c] >= 0);
+    for (c = 0; c < i.getCourseCount(); c++)
+      for (d = 0; d < i.getDayCount(); d++)
+        for (p = d * i.getPeriodsPerDayCount(); p < (d + 1) * i.getPeriodsPerDayCount(); p++) {
+          IloExpr sum(env);
+          for (r = 0; r < i.getRoomCount(); r++) 
+            sum += vars.x[p][r][c];
+          cuts.add(sum - vars.courseDays[c][d] <= 0);
+          sum.end();
+        }
+  }
 
   // bool CutManagerI::genCutsFromMindaysChecks(RelaxationSummary vals) {
-  if (minDays) {
+  if (family == MindaysCuts) {
     int c, d, pd, r;
     for(c = 0; c < i.getCourseCount(); c++)
       for(d = 0; d < i.getDayCount(); d++) {
@@ -358,7 +433,7 @@ void TimetablingSolver::generateCutsStatically(TimetablingInstance &i) {
           for (pd = 0; pd < i.getPeriodsPerDayCount(); pd++)
             for (r = 0; r < i.getRoomCount(); r++)
               lhsExpr += vars.x[d * i.getPeriodsPerDayCount() + pd][r][c];
-          model.add(lhsExpr <= rhsExpr);
+          cuts.add(lhsExpr <= rhsExpr);
           lhsExpr.end();
         } catch (...) { /* variable pre-processed away */ }
         rhsExpr.end();
@@ -366,7 +441,7 @@ void TimetablingSolver::generateCutsStatically(TimetablingInstance &i) {
   }
 
   // bool CutManagerI::genCutsFromCurriculumChecks(RelaxationSummary vals) {
-  if (curriculumChecks) {
+  if (family == CurriculumCuts) {
     int u, ui, p, r;
 
     for(u = 0; u < i.getCurriculumCount(); u++) {
@@ -383,12 +458,12 @@ void TimetablingSolver::generateCutsStatically(TimetablingInstance &i) {
           for(r = 0; r < i.getRoomCount(); r++)    
             expr += vars.x[p][r][c];
       }
-      model.add(expr == shouldHave);      
+      cuts.add(expr == shouldHave);      
       expr.end();
     }      
   }
 
-  if (patternsEnumeration) {
+  if (family == PatternCuts) {
     PatternDB patterns = i.getPatterns();
 
     int r, u, ui, d, pd;
@@ -412,17 +487,17 @@ void TimetablingSolver::generateCutsStatically(TimetablingInstance &i) {
             }
           }
 
-          model.add( patterns[pati].penalty * (1 - patterns[pati].rhs + sum) - vars.singletonChecks[u][d][0] <= 0);
+          cuts.add( patterns[pati].penalty * (1 - patterns[pati].rhs + sum) - vars.singletonChecks[u][d][0] <= 0);
           sum.end();
 
           if (useCoursePeriods) {
-            model.add( patterns[pati].penalty * (1 - patterns[pati].rhs + sumConcise) - vars.singletonChecks[u][d][0] <= 0);
+            cuts.add( patterns[pati].penalty * (1 - patterns[pati].rhs + sumConcise) - vars.singletonChecks[u][d][0] <= 0);
             sumConcise.end();
           }
         }
   }
 
-  if (cliquePool) {
+  if (family == CliquePoolCuts) {
     int p, clique, ci, r;
     std::vector< std::vector<int> > &cs = conflictGraph.cliques;
     std::vector<Vertex> &vs = conflictGraph.vs;
@@ -438,16 +513,16 @@ void TimetablingSolver::generateCutsStatically(TimetablingInstance &i) {
           if (useCoursePeriods)
             sumConcise += vars.coursePeriods[cs[clique][ci]][p];
         }
-        model.add(sum <= 1);
+        cuts.add(sum <= 1);
         sum.end();
         if (useCoursePeriods) {
-          model.add(sumConcise <= 1);
+          cuts.add(sumConcise <= 1);
           sumConcise.end();
         }
       }
   }
 
-  if (triangles) {
+  if (family == TriangleCuts) {
     int p, r;
     std::vector< std::vector<int> > &cs = conflictGraph.cliques;
     std::vector<Vertex> &vs = conflictGraph.vs;
@@ -462,12 +537,12 @@ void TimetablingSolver::generateCutsStatically(TimetablingInstance &i) {
                 IloExpr sum(env);
                 for(r = 0; r < i.getRoomCount(); r++)
                   sum += vars.x[p][r][u] + vars.x[p][r][*vi] + vars.x[p][r][*wi];
-                model.add(sum <= 1);
+                cuts.add(sum <= 1);
                 sum.end();
               }  
   }
 
-} // end of TimetablingSolver::generateCutsStatically
+} // end of TimetablingSolver::generateCuts
 
 
 void TimetablingSolver::generateObjective(TimetablingInstance &i) {
@@ -495,7 +570,8 @@ void TimetablingSolver::generateObjective(TimetablingInstance &i) {
   for (c = 0; c < i.getCourseCount(); c++)
     obj += 5 * vars.courseMinDayViolations[c];
   // ... and minimize the total
-  model.add(IloMinimize(env, obj));
+  objective = IloMinimize(env, obj);
+  model.add(objective);
 } // END TimetablingSolver::generateObjective
 
 
@@ -507,43 +583,17 @@ bool TimetablingSolver::importSolution(IloCplex &cplex, TimetablingInstance &i,
   IloNumArray setVals(env);
 
   try {
-    std::ifstream file;
-    file.open(filename, std::ifstream::in);
-
-    std::string cname;
-    std::string rname;    
-    int d, pwd, p, r, c, cnt;
-
-    if (file.bad() || file.eof()) {
-      return false;
-    }
-
-    cnt = 0;
+    Lectures lectures;
+    if (!loadSolution(i, filename, lectures)) return false;
 
-    while (file.good() && cnt++ < i.getEventCount()) {
+    TimetableEvaluator evaluator(i, false);
+    std::cout << "Loader: Imported " << evaluator.evaluate(lectures) << std::endl;
 
-      file >> cname;
-      // we use std::map< std::string, int, std::less<std::string> > cnames;
-      c = i.getCourseId(cname);
-      if (c < 0) break;
-
-      if (!file.good()) break;
-      file >> rname;
-      r = i.getRoomId(rname.substr(1));
-      if (r < 0) break;
-
-      if (!file.good()) break;
-      file >> d;
-      if (!file.good()) break;
-      file >> pwd;
-      p = d * i.getPeriodsPerDayCount() + pwd;
-
-      setVars.add(vars.x[p][r][c]);
+    for (Lectures::iterator it = lectures.begin(); it != lectures.end(); it++) {
+      setVars.add(vars.x[it->period][it->room][it->course]);
       setVals.add(1);
     }
 
-    file.close();
-
     if (setVars.getSize() > 0) {
 
       // NOTE: Cplex warmstarting sucks. In theory, the following should suffice:
@@ -558,3 +608,134 @@ bool TimetablingSolver::importSolution(IloCplex &cplex, TimetablingInstance &i,
   catch (...) { std::cerr << "Solver (Warmstart): Unknown exception caught." << std::endl; }
   return false;
 }
+
+
+void TimetablingSolver::excludeLectures(const Lectures &lectures) {
+  for (Lectures::const_iterator it = lectures.begin(); it != lectures.end(); it++)
+    vars.x[it->period][it->room][it->course].setUB(0);
+}
+
+
+void TimetablingSolver::boundObjective(int lowerBound) {
+  model.add(objective.getExpr() >= lowerBound);
+}
+
+
+void TimetablingSolver::restrictToShard(const Shard &shard) {
+  for (size_t i = 0; i < shard.fixings.size(); i++) {
+    const ShardFixing &f = shard.fixings[i];
+    IloNumVar var;
+    if (f.kind == MinDayViolationsFixing) var = vars.courseMinDayViolations[f.course];
+    else if (f.kind == CourseRoomFixing) var = vars.courseRooms[f.course][f.index];
+    else var = vars.courseDays[f.course][f.index];
+    var.setLB(f.lower);
+    var.setUB(f.upper);
+  }
+}
+
+
+int TimetablingSolver::applyPresolve(const PresolveResult &result) {
+  int P = instance.getPeriodCount(), D = instance.getDayCount();
+  int p, d, r, c, u;  // periods, days, rooms, courses, curricula
+  int fixed = 0;
+  for (c = 0; c < instance.getCourseCount(); c++) {
+    for (p = 0; p < P; p++) {
+      if (result.available[c * P + p]) {
+        if (useCoursePeriods && result.forced[c]) vars.coursePeriods[c][p].setLB(1);
+        continue;
+      }
+      for (r = 0; r < instance.getRoomCount(); r++) vars.x[p][r][c].setUB(0);
+      if (useCoursePeriods) vars.coursePeriods[c][p].setUB(0);
+      fixed += instance.getRoomCount();
+    }
+    for (d = 0; d < D; d++) {
+      vars.courseDays[c][d].setLB(result.courseDaysLower[c * D + d]);
+      vars.courseDays[c][d].setUB(result.courseDaysUpper[c * D + d]);
+    }
+    vars.courseMinDayViolations[c].setLB(result.minDayViolationsLower[c]);
+  }
+  for (u = 0; u < instance.getProperCurriculumCount(); u++)
+    for (d = 0; d < D; d++) {
+      vars.singletonChecks[u][d][0].setLB(result.singletonLower[u * D + d]);
+      vars.singletonChecks[u][d][0].setUB(result.singletonUpper[u * D + d]);
+    }
+  return fixed;
+}
+
+
+int TimetablingSolver::breakSymmetry(const SymmetryOrbits &orbits) {
+  int p, r, c;  // periods, rooms, courses
+  size_t o, k;  // class, member
+  IloRangeArray rows(env);
+
+  // The sums of the periods of the lectures of identical courses do not decrease
+  for (o = 0; o < orbits.courses.size(); o++)
+    for (k = 1; k < orbits.courses[o].size(); k++) {
+      IloExpr sum(env);
+      for (p = 0; p < instance.getPeriodCount(); p++)
+        for (r = 0; r < instance.getRoomCount(); r++)
+          sum += p * (vars.x[p][r][orbits.courses[o][k]] - vars.x[p][r][orbits.courses[o][k - 1]]);
+      rows.add(sum >= 0);
+      sum.end();
+    }
+
+  // The lectures held in rooms of the same capacity do not increase
+  for (o = 0; o < orbits.rooms.size(); o++)
+    for (k = 1; k < orbits.rooms[o].size(); k++) {
+      IloExpr sum(env);
+      for (p = 0; p < instance.getPeriodCount(); p++)
+        for (c = 0; c < instance.getCourseCount(); c++)
+          sum += vars.x[p][orbits.rooms[o][k - 1]][c] - vars.x[p][orbits.rooms[o][k]][c];
+      rows.add(sum >= 0);
+      sum.end();
+    }
+
+  model.add(rows);
+  return rows.getSize();
+}
+
+
+// The column of a variable, which any variable of the model has to have
+static int getColumn(const std::vector<int> &columnOf, const IloNumVar &var) {
+  IloInt id = var.getId();
+  if (id < 0 || id >= IloInt(columnOf.size()) || columnOf[id] < 0) {
+    std::cerr << "Solver: The variable of id " << id << " of the model is not in vars.all" << std::endl;
+    std::abort();
+  }
+  return columnOf[id];
+}
+
+
+void TimetablingSolver::getSparseLP(SparseLP &lp) {
+  // Columns in the order of vars.all, by the ids of the variables
+  std::vector<int> columnOf;
+  IloInt j;
+  for (j = 0; j < vars.all.getSize(); j++) {
+    IloInt id = vars.all[j].getId();
+    if (id >= columnOf.size()) columnOf.resize(id + 1, -1);
+    columnOf[id] = lp.addColumn(vars.all[j].getLB(), vars.all[j].getUB(), 0);
+  }
+
+  std::vector<int> columns;
+  std::vector<double> coefficients;
+  for (IloModel::Iterator it(model); it.ok(); ++it) {
+    IloExtractable e = *it;
+    if (e.isObjective()) {
+      IloObjective objective = e.asObjective();
+      for (IloExpr::LinearIterator l = objective.getLinearIterator(); l.ok(); ++l)
+        lp.objective[getColumn(columnOf, l.getVar())] += l.getCoef();
+      lp.objectiveOffset = objective.getConstant();
+    } else if (e.isConstraint() && e.getImpl()->isType(IloRangeI::GetTypeInfo())) {
+      IloRange range((IloRangeI *)e.getImpl());
+      columns.clear();
+      coefficients.clear();
+      for (IloExpr::LinearIterator l = range.getLinearIterator(); l.ok(); ++l) {
+        columns.push_back(getColumn(columnOf, l.getVar()));
+        coefficients.push_back(l.getCoef());
+      }
+      IloNum constant = range.getExpr().getConstant();
+      lp.addRow(range.getLB() > -IloInfinity ? range.getLB() - constant : -lpInfinity,
+        range.getUB() < IloInfinity ? range.getUB() - constant : lpInfinity, columns, coefficients);
+    }
+  }
+}
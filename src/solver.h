@@ -20,7 +20,13 @@
 #include <ilcplex/ilocplex.h>
 
 #include "loader.h"
+#include "timetable.h"
 #include "conflicts.h"
+#include "pdhg.h"
+#include "sharding.h"
+#include "cut_registry.h"
+#include "symmetry.h"
+#include "presolve.h"
 
 
 ILOSTLBEGIN
@@ -35,6 +41,7 @@ struct TimetablingVariables {
   IloArray<IloNumVarArray> courseRooms; // ... indexed with courses first, rooms second
   IloArray< IloArray<IloNumVarArray> > singletonChecks; // ... indexed with curricula first, days second, index last
   IloNumVarArray all; // a helper with all variables in a flat array
+  IloNumVarArray xs; // a helper with x in a flat array, indexed with (p * rooms + r) * courses + c
   TimetablingVariables(IloEnv env, TimetablingInstance &i, bool subMIP = false, bool useCoursePeriods = false);
 };
 
@@ -48,17 +55,24 @@ protected:
   TimetablingVariables vars;
   IloRangeArray constraints;
   Graph conflictGraph;
+  CutRegistry registry;
+  IloRangeArray lazyCuts, userCuts;  // ... for addCutPools
+  IloObjective objective;
 
   bool useCoursePeriods;
 
   virtual void generateConstraints(TimetablingInstance &i);
+  // enumerates the families the registry does not leave to the cut manager
   virtual void generateCutsStatically(TimetablingInstance &i);
+  virtual void generateCuts(TimetablingInstance &i, int family, IloRangeArray &cuts);
   virtual void generateObjective(TimetablingInstance &i);
 
 public:
-  TimetablingSolver(IloModel &modelToGenerate, TimetablingInstance &i, bool subMIP = false, bool coursePeriods = false) 
+  TimetablingSolver(IloModel &modelToGenerate, TimetablingInstance &i, bool subMIP = false, bool coursePeriods = false,
+    const CutRegistry &cutRegistry = CutRegistry()) 
     : vars(modelToGenerate.getEnv(), i, subMIP, coursePeriods), 
-    constraints(modelToGenerate.getEnv()), instance(i),
+    constraints(modelToGenerate.getEnv()), instance(i), registry(cutRegistry),
+    lazyCuts(modelToGenerate.getEnv()), userCuts(modelToGenerate.getEnv()),
     useCoursePeriods(coursePeriods) {
       model = modelToGenerate;
       env = model.getEnv();
@@ -75,6 +89,29 @@ public:
   // tries to import solution with the given filename, returns "success"
   virtual bool importSolution(IloCplex &cplex, TimetablingInstance &i, const char *filename);
 
+  // hands the lazy constraints and the user cuts enumerated to CPLEX
+  virtual void addCutPools(IloCplex &cplex);
+
+  virtual const CutRegistry &getCutRegistry() { return registry; }
+
+  // fixes x[p][r][c] at zero for each of the lectures given, e.g. by reduced-cost fixing
+  virtual void excludeLectures(const Lectures &lectures);
+
+  // bounds the structural variables as the shard of the search space requires
+  virtual void restrictToShard(const Shard &shard);
+
+  // bounds x and the auxiliary variables as propagation on the instance allows; returns the x fixed at zero
+  virtual int applyPresolve(const PresolveResult &result);
+
+  // adds the row objective >= lowerBound, as CPLEX applies CutLo only when maximising
+  virtual void boundObjective(int lowerBound);
+
+  // orders the members of each class of interchangeable courses and rooms, see canonicalise; returns the rows added
+  virtual int breakSymmetry(const SymmetryOrbits &orbits);
+
+  // the LP relaxation of the model, with the columns in the order of vars.all
+  virtual void getSparseLP(SparseLP &lp);
+
   virtual void exportConfictGraph(const char *filename, const char *comment = "", bool binary = false) {
     conflictGraph.exportDimacs(filename, comment, binary);
   }
@@ -0,0 +1,118 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "symmetry.h"
+
+
+void findOrbits(TimetablingInstance &instance, SymmetryOrbits &orbits) {
+  orbits.rooms.clear();
+  orbits.courses.clear();
+  int C = instance.getCourseCount();
+  int c, r, u, f, k;
+
+  std::map< int, std::vector<int> > byCapacity;
+  for (r = 0; r < instance.getRoomCount(); r++)
+    byCapacity[instance.getRoom(r).capacity].push_back(r);
+  for (std::map< int, std::vector<int> >::iterator it = byCapacity.begin(); it != byCapacity.end(); it++)
+    if (it->second.size() > 1) orbits.rooms.push_back(it->second);
+
+  // What tells a course apart: lectures, students, minimum working days, then the curricula
+  // and the singletons it belongs to, and the periods it is unavailable in, each list ended by -1
+  std::vector< std::vector<int> > curricula(C), restricted(C);
+  for (u = 0; u < instance.getCurriculumCount(); u++)
+    for (k = 0; k < instance.getCurriculum(u).courseIds.size(); k++)
+      curricula[instance.getCurriculum(u).courseIds[k]].push_back(u);
+  for (u = 0; u < instance.getSingletonCurriculumCount(); u++)
+    for (k = 0; k < instance.getSingletonCurriculum(u).courseIds.size(); k++)
+      curricula[instance.getSingletonCurriculum(u).courseIds[k]].push_back(instance.getCurriculumCount() + u);
+  for (f = 0; f < instance.getRestrictionCount(); f++)
+    restricted[instance.getRestriction(f).courseId].push_back(instance.getRestriction(f).period);
+
+  std::map< std::vector<int>, std::vector<int> > byKey;
+  for (c = 0; c < C; c++) {
+    const Course &course = instance.getCourse(c);
+    std::vector<int> key;
+    key.push_back(course.lectures);
+    key.push_back(course.students);
+    key.push_back(course.minWorkingDays);
+    std::sort(curricula[c].begin(), curricula[c].end());
+    key.insert(key.end(), curricula[c].begin(), curricula[c].end());
+    key.push_back(-1);
+    std::sort(restricted[c].begin(), restricted[c].end());
+    key.insert(key.end(), restricted[c].begin(), restricted[c].end());
+    key.push_back(-1);
+    byKey[key].push_back(c);
+  }
+  for (std::map< std::vector<int>, std::vector<int> >::iterator it = byKey.begin(); it != byKey.end(); it++)
+    if (it->second.size() > 1) orbits.courses.push_back(it->second);
+}
+
+
+// The sums of the periods of the lectures of each course, and the lectures in each room
+static void getCounts(TimetablingInstance &instance, const Lectures &lectures,
+                      std::vector<int> &periodSums, std::vector<int> &roomUses) {
+  periodSums.assign(instance.getCourseCount(), 0);
+  roomUses.assign(instance.getRoomCount(), 0);
+  for (size_t l = 0; l < lectures.size(); l++) {
+    periodSums[lectures[l].course] += lectures[l].period;
+    roomUses[lectures[l].room] += 1;
+  }
+}
+
+
+void canonicalise(TimetablingInstance &instance, const SymmetryOrbits &orbits, Lectures &lectures) {
+  std::vector<int> periodSums, roomUses;
+  getCounts(instance, lectures, periodSums, roomUses);
+  std::vector<int> courseTo(instance.getCourseCount()), roomTo(instance.getRoomCount());
+  size_t o, k;
+  for (k = 0; k < courseTo.size(); k++) courseTo[k] = k;
+  for (k = 0; k < roomTo.size(); k++) roomTo[k] = k;
+
+  // The course with the k-th least sum becomes the k-th of its class
+  for (o = 0; o < orbits.courses.size(); o++) {
+    const std::vector<int> &members = orbits.courses[o];
+    std::vector< std::pair<int, int> > order;
+    for (k = 0; k < members.size(); k++) order.push_back(std::make_pair(periodSums[members[k]], members[k]));
+    std::sort(order.begin(), order.end());
+    for (k = 0; k < members.size(); k++) courseTo[order[k].second] = members[k];
+  }
+  // The room with the k-th most lectures becomes the k-th of its class
+  for (o = 0; o < orbits.rooms.size(); o++) {
+    const std::vector<int> &members = orbits.rooms[o];
+    std::vector< std::pair<int, int> > order;
+    for (k = 0; k < members.size(); k++) order.push_back(std::make_pair(-roomUses[members[k]], members[k]));
+    std::sort(order.begin(), order.end());
+    for (k = 0; k < members.size(); k++) roomTo[order[k].second] = members[k];
+  }
+
+  for (k = 0; k < lectures.size(); k++) {
+    lectures[k].course = courseTo[lectures[k].course];
+    lectures[k].room = roomTo[lectures[k].room];
+  }
+}
+
+
+bool isCanonical(TimetablingInstance &instance, const SymmetryOrbits &orbits, const Lectures &lectures) {
+  std::vector<int> periodSums, roomUses;
+  getCounts(instance, lectures, periodSums, roomUses);
+  size_t o, k;
+  for (o = 0; o < orbits.courses.size(); o++)
+    for (k = 1; k < orbits.courses[o].size(); k++)
+      if (periodSums[orbits.courses[o][k - 1]] > periodSums[orbits.courses[o][k]]) return false;
+  for (o = 0; o < orbits.rooms.size(); o++)
+    for (k = 1; k < orbits.rooms[o].size(); k++)
+      if (roomUses[orbits.rooms[o][k - 1]] < roomUses[orbits.rooms[o][k]]) return false;
+  return true;
+}
@@ -0,0 +1,44 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_SYMMETRY
+#define UDINE_SYMMETRY
+
+#include <vector>
+
+#include "loader.h"
+#include "timetable.h"
+
+/* The interchangeable rooms and courses of an instance, in classes of two or more,
+* each sorted. Rooms of the same capacity are interchangeable, as nothing else tells
+* them apart. Courses are, if they have the same lectures, students and minimum working
+* days, belong to the same curricula, including those of the teachers and the singletons,
+* and are unavailable in the same periods. Any permutation within the classes maps
+* a timetable to one just as feasible and of the same cost.
+*/
+struct SymmetryOrbits {
+  std::vector< std::vector<int> > rooms;
+  std::vector< std::vector<int> > courses;
+
+  bool isEmpty() const { return rooms.empty() && courses.empty(); }
+};
+
+void findOrbits(TimetablingInstance &instance, SymmetryOrbits &orbits);
+
+/* The representative of a timetable the symmetry-breaking rows of the solver allow:
+* within each class of courses, the sums of the periods of their lectures do not
+* decrease with the index of the course, and within each class of rooms, the lectures
+* held in them do not increase with the index of the room.
+*/
+void canonicalise(TimetablingInstance &instance, const SymmetryOrbits &orbits, Lectures &lectures);
+bool isCanonical(TimetablingInstance &instance, const SymmetryOrbits &orbits, const Lectures &lectures);
+
+#endif // UDINE_SYMMETRY
@@ -0,0 +1,157 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <algorithm>
+#include <fstream>
+
+#include "telemetry.h"
+
+// The counters belong to the telemetry, not to the threads, which may be gone by the time they are written
+static void keepCounters(SeparationTelemetry::ThreadCounters *) {}
+
+struct CallbackStartLess {
+  bool operator()(const SeparationTelemetry::CallbackRecord &x, const SeparationTelemetry::CallbackRecord &y) const {
+    return x.start < y.start;
+  }
+};
+
+
+SeparationTelemetry::FamilyCounters::FamilyCounters()
+  : calls(0), found(0), added(0), time(0), violation(0), maxViolation(0) {}
+
+
+void SeparationTelemetry::FamilyCounters::merge(const FamilyCounters &other) {
+  calls += other.calls;
+  found += other.found;
+  added += other.added;
+  time += other.time;
+  violation += other.violation;
+  maxViolation = std::max(maxViolation, other.maxViolation);
+}
+
+
+SeparationTelemetry::SeparationTelemetry() : counters(&keepCounters) {
+  created = boost::get_system_time();
+}
+
+
+SeparationTelemetry::~SeparationTelemetry() {
+  for (size_t t = 0; t < threads.size(); t++) delete threads[t];
+}
+
+
+SeparationTelemetry::ThreadCounters &SeparationTelemetry::local() {
+  ThreadCounters *mine = counters.get();
+  if (mine) return *mine;
+  mine = new ThreadCounters();
+  {
+    boost::mutex::scoped_lock l(lock);
+    mine->thread = threads.size();
+    threads.push_back(mine);
+  }
+  counters.reset(mine);
+  return *mine;
+}
+
+
+double SeparationTelemetry::getElapsed() const {
+  return (boost::get_system_time() - created).total_microseconds() / 1000.0;
+}
+
+
+void SeparationTelemetry::getTotals(FamilyCounters totals[CutFamilyCount]) {
+  boost::mutex::scoped_lock l(lock);
+  for (int f = 0; f < CutFamilyCount; f++) {
+    totals[f] = FamilyCounters();
+    for (size_t t = 0; t < threads.size(); t++) totals[f].merge(threads[t]->families[f]);
+  }
+}
+
+
+void SeparationTelemetry::getCallbacks(std::vector<CallbackRecord> &records) {
+  boost::mutex::scoped_lock l(lock);
+  records.clear();
+  for (size_t t = 0; t < threads.size(); t++) {
+    std::vector<CallbackRecord> &cs = threads[t]->callbacks;
+    for (size_t i = 0; i < cs.size(); i++) {
+      CallbackRecord record = cs[i];
+      record.hasAfter = (i + 1 < cs.size() && cs[i + 1].nodes == record.nodes && cs[i + 1].depth == record.depth);
+      record.objectiveAfter = record.hasAfter ? cs[i + 1].objective : 0;
+      records.push_back(record);
+    }
+  }
+  std::stable_sort(records.begin(), records.end(), CallbackStartLess());
+}
+
+
+bool SeparationTelemetry::writeCsv(const std::string &path) {
+  FamilyCounters totals[CutFamilyCount];
+  getTotals(totals);
+  std::string filename = path + ".families.csv";
+  std::ofstream file(filename.c_str(), std::ofstream::out);
+  if (!file) return false;
+  file << "family,calls,timeMs,found,added,violation,maxViolation,avgViolation" << std::endl;
+  for (int f = 0; f < CutFamilyCount; f++) {
+    const FamilyCounters &c = totals[f];
+    file << getCutFamilyName(f) << "," << c.calls << "," << c.time << "," << c.found << "," << c.added << ","
+      << c.violation << "," << c.maxViolation << "," << (c.found > 0 ? c.violation / c.found : 0) << std::endl;
+  }
+  file.close();
+
+  std::vector<CallbackRecord> records;
+  getCallbacks(records);
+  filename = path + ".callbacks.csv";
+  file.open(filename.c_str(), std::ofstream::out);
+  if (!file) return false;
+  file << "thread,call,nodes,depth,startMs,timeMs,found,added,bound,objectiveBefore,objectiveAfter" << std::endl;
+  for (size_t i = 0; i < records.size(); i++) {
+    const CallbackRecord &r = records[i];
+    file << r.thread << "," << r.call << "," << r.nodes << "," << r.depth << "," << r.start << "," << r.time << ","
+      << r.found << "," << r.added << "," << r.bound << "," << r.objective << ",";
+    if (r.hasAfter) file << r.objectiveAfter;
+    file << std::endl;
+  }
+  return true;
+}
+
+
+bool SeparationTelemetry::writeJson(const std::string &path) {
+  FamilyCounters totals[CutFamilyCount];
+  getTotals(totals);
+  std::vector<CallbackRecord> records;
+  getCallbacks(records);
+  std::string filename = path + ".cuts.json";
+  std::ofstream file(filename.c_str(), std::ofstream::out);
+  if (!file) return false;
+
+  file << "{" << std::endl << "  \"families\": [" << std::endl;
+  for (int f = 0; f < CutFamilyCount; f++) {
+    const FamilyCounters &c = totals[f];
+    file << "    {\"family\": \"" << getCutFamilyName(f) << "\", \"calls\": " << c.calls
+      << ", \"timeMs\": " << c.time << ", \"found\": " << c.found << ", \"added\": " << c.added
+      << ", \"violation\": " << c.violation << ", \"maxViolation\": " << c.maxViolation
+      << ", \"avgViolation\": " << (c.found > 0 ? c.violation / c.found : 0) << "}"
+      << (f + 1 < CutFamilyCount ? "," : "") << std::endl;
+  }
+  file << "  ]," << std::endl << "  \"callbacks\": [" << std::endl;
+  for (size_t i = 0; i < records.size(); i++) {
+    const CallbackRecord &r = records[i];
+    file << "    {\"thread\": " << r.thread << ", \"call\": " << r.call << ", \"nodes\": " << r.nodes
+      << ", \"depth\": " << r.depth << ", \"startMs\": " << r.start << ", \"timeMs\": " << r.time
+      << ", \"found\": " << r.found << ", \"added\": " << r.added << ", \"bound\": " << r.bound
+      << ", \"objectiveBefore\": " << r.objective << ", \"objectiveAfter\": ";
+    if (r.hasAfter) file << r.objectiveAfter;
+    else file << "null";
+    file << "}" << (i + 1 < records.size() ? "," : "") << std::endl;
+  }
+  file << "  ]" << std::endl << "}" << std::endl;
+  return true;
+}
@@ -0,0 +1,77 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_TELEMETRY
+#define UDINE_TELEMETRY
+
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "scheduler.h"
+
+/* Counters and timers of the separation, per family and per call of the cut manager.
+* Each thread counts into its own counters, without any locking once they exist,
+* and the counters are only merged when written out:
+*   <data>.families.csv and <data>.callbacks.csv, or <data>.cuts.json
+*/
+class SeparationTelemetry {
+public:
+  struct FamilyCounters {
+    int calls, found, added;
+    double time;                             // in ms
+    double violation, maxViolation;
+    FamilyCounters();
+    void merge(const FamilyCounters &other);
+  };
+
+  // The bound is CPLEX's best bound and the objective that of the node LP, both on entry;
+  // the objective after is that on entry to the next call at the same node, if any
+  struct CallbackRecord {
+    int thread, call, nodes, depth;
+    double start, time;                      // in ms since the telemetry was created
+    int found, added;
+    double bound, objective, objectiveAfter;
+    bool hasAfter;
+  };
+
+  struct ThreadCounters {
+    int thread;
+    FamilyCounters families[CutFamilyCount];
+    std::vector<CallbackRecord> callbacks;
+  };
+
+protected:
+  boost::system_time created;
+  boost::thread_specific_ptr<ThreadCounters> counters;
+  std::vector<ThreadCounters*> threads;
+  boost::mutex lock;
+
+  // The records of all the threads, in the order of their start
+  void getCallbacks(std::vector<CallbackRecord> &records);
+
+public:
+  SeparationTelemetry();
+  ~SeparationTelemetry();
+
+  // The counters of the calling thread, created on its first call
+  ThreadCounters &local();
+  double getElapsed() const;
+  void getTotals(FamilyCounters totals[CutFamilyCount]);
+
+  bool writeCsv(const std::string &path);
+  bool writeJson(const std::string &path);
+};
+
+#endif // UDINE_TELEMETRY
@@ -11,115 +11,418 @@
 
 #pragma warning(disable : 4018) 
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <set>
+#include <sstream>
 #include <string>
+#include <vector>
 
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
 #include <ilcplex/ilocplex.h>
 
 #include "loader.h"
 #include "solver.h"
 #include "cut_manager.h"
 #include "saver.h"
+#include "bounds.h"
+#include "lagrangian.h"
+#include "pdhg.h"
+#include "batch.h"
+#include "exchange.h"
+#include "sharding.h"
+#include "configuration.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 
 ILOSTLBEGIN
 
-int main (int argc, char **argv) {
+// How a root probe of autoselect went
+struct ProbeResult {
+  double bound;         // the best bound, with the combinatorial ones
+  double seconds;       // from reading the instance on
+  int nodes;
+  bool solved;
+};
 
-  if (argc < 2) { 
-    std::cerr << "Usage: " << argv[0] << " <data> [cutUp]" << std::endl;
-    std::cerr << "where: <data> is a path to an instance of Udine Timetabling and [cutUp] is an optional value of a known solution" << std::endl;
-    exit(-1); 
+
+// How to run each instance, as given on the command line and in the configuration
+struct RunSettings {
+  int cutUp;
+  int cutLevel;
+  bool boundMode;       // Only the root, with all separators, and a certificate of the bound
+  double tailOff;       // The least improvement of the bound per round worth separating for
+  int tailOffRounds;
+  int threads;          // Per instance, with 0 leaving it to CPLEX
+  SeparationPolicy policy;
+  CutRegistry cuts;     // Where each family of cuts goes
+  std::string telemetry;  // csv, json or none
+  bool quiet;           // CPLEX writes its log to <data>.out instead
+  bool snapshots;       // Records the relaxations separated in <data>.snapshots
+  bool coursePeriods;   // The formulation with the course-period variables
+  bool lagrangian;      // The Lagrangian bound and its reduced-cost fixing
+  bool firstOrderLP;    // The bound of the root LP by PDHG and its reduced-cost fixing
+  bool symmetry;        // Orders the interchangeable rooms and identical courses
+  int conflicts;        // What the conflict rows are generated for, one of ConflictReduction
+  bool presolve;        // Propagates on the instance before CPLEX, see presolveInstance
+  SolverConfiguration configuration;  // The parameters of CPLEX, which go to <data>.prm
+  int seed;             // RandomSeed, where CPLEX has it, with 0 leaving it to CPLEX
+  int portfolio;        // Solves at a time of each instance, differently configured
+  std::string output;   // The path the output files start with, <data> if empty
+  SolutionExchange *exchange;   // Shared with the other solves of the instance, if any
+  int member;
+  int shards;           // Parts of the search space, each solved by a process of its own
+  int shard;            // The part this process solves, or -1 for all of them
+  int split;            // What the search space is split on, one of ShardSplit
+  bool aggregate;       // Only reports on the shards solved before, e.g. on a cluster
+  std::string exchangeName;   // The shared memory of the coordinator of the shards, if any
+  std::string program;  // argv[0], to run the shards with
+  double autoselect;    // The seconds of a root probe of each formulation, or 0 to solve as configured
+  ProbeResult *probe;   // Where a probe reports to, if this is one
+};
+
+
+// The configurations of a portfolio, of which the first is that of a single solve
+struct PortfolioMember {
+  const char *name;
+  int emphasis;         // MIPEmphasis
+  int cutLevel;         // relative to that given
+  bool coursePeriods;
+};
+
+static const PortfolioMember portfolioMembers[] = {
+  { "bestbound", 3, 0, false },
+  { "courseperiods", 3, 0, true },
+  { "optimality", 2, 1, false },
+  { "feasibility", 1, -1, false },
+  { "balanced", 0, 0, true }
+};
+static const int portfolioMemberCount = sizeof(portfolioMembers) / sizeof(portfolioMembers[0]);
+
+
+// The formulations autoselect probes, as changes to the configuration given
+struct FormulationCandidate {
+  const char *name;
+  const char *changes;  // name=value, separated by spaces
+};
+
+static const FormulationCandidate formulationCandidates[] = {
+  { "given", "" },
+  { "courseperiods", "coursePeriods=on" },
+  { "dynamicpatterns", "cuts.patterns=dynamic" },
+  { "cliques", "cutLevel=6" },
+  { "staticcliques", "cutLevel=6 cuts.cliques=static" },
+  { "linkingpool", "cuts.linking=user" },
+  { "symmetry", "symmetry=on" },
+  { "cover", "conflicts=cover" }
+};
+static const int formulationCandidateCount = sizeof(formulationCandidates) / sizeof(formulationCandidates[0]);
+
+
+// The knobs of the configuration as the settings of a run, false if any is not allowed
+bool applyConfiguration(RunSettings &settings, std::string &error) {
+  const SolverConfiguration &c = settings.configuration;
+  settings.cutLevel = settings.boundMode ? 6 : 5;
+  settings.tailOff = settings.boundMode ? 0.05 : 0;
+  settings.tailOffRounds = 3;
+  settings.threads = 0;
+  settings.coursePeriods = settings.lagrangian = settings.firstOrderLP = settings.symmetry = false;
+  settings.presolve = true;
+  settings.autoselect = 0;
+  settings.seed = 0;
+  if (!c.getInt("cutLevel", settings.cutLevel, error) || !c.getDouble("tailOff", settings.tailOff, error)
+    || !c.getInt("tailOffRounds", settings.tailOffRounds, error) || !c.getInt("threads", settings.threads, error)
+    || !c.getBool("coursePeriods", settings.coursePeriods, error) || !c.getBool("lagrangian", settings.lagrangian, error)
+    || !c.getBool("firstOrderLP", settings.firstOrderLP, error) || !c.getBool("symmetry", settings.symmetry, error)
+    || !c.getBool("presolve", settings.presolve, error) || !c.getDouble("autoselect", settings.autoselect, error)
+    || !c.getInt("seed", settings.seed, error))
+    return false;
+  if (settings.seed < 0) {
+    error = "negative seed " + c.get("seed");
+    return false;
   }
-  string filename(argv[1]);
+  if (!getConflictReductionByName(c.get("conflicts", "dominance"), settings.conflicts)) {
+    error = "unknown conflicts " + c.get("conflicts");
+    return false;
+  }
+  if (!c.configure(settings.policy, error)) return false;
+  return c.configure(settings.cuts, error);
+}
+
+
+// Records what the bound on an instance rests on in <data>.bound, so that it can be reproduced
+void writeBoundCertificate(IloCplex &cplex, TimetablingInstance &instance, const RunSettings &settings,
+                           const Penalties &bounds, int lowerBound, double time) {
+  std::string filename = instance.getFilename();
+  std::ofstream file(filename.append(".bound").c_str(), std::ofstream::out);
+  double bound = std::max<double>(lowerBound, cplex.getBestObjValue());
+  file << "Instance " << instance.getName() << std::endl;
+  file << "Data " << instance.getFilename() << std::endl;
+  file << "Bound " << bound << std::endl;
+  file << "Rounded " << std::ceil(bound - 1e-6) << std::endl;
+  file << "Root " << cplex.getBestObjValue() << std::endl;
+  file << "Combinatorial " << bounds.roomCapacity << " " << bounds.minWorkingDays
+    << " " << bounds.isolatedLectures << std::endl;
+  file << "Cutoff " << lowerBound << " " << settings.cutUp << std::endl;
+  file << "Status " << cplex.getStatus() << std::endl;
+  file << "Nodes " << cplex.getNnodes() << std::endl;
+  file << "Time " << time << std::endl;
+  file << "CutLevel " << settings.cutLevel << std::endl;
+  file << "TailOff " << settings.tailOff << " " << settings.tailOffRounds << std::endl;
+  file << "Policy " << settings.policy.name << std::endl;
+  file << "Threads " << cplex.getParam(IloCplex::Threads) << std::endl;
+  file << "Version " << cplex.getVersion() << std::endl;
+  file.close();
+}
+
+
+// Where the output of a shard goes: <data>.s<shard>.*
+std::string getShardBase(const std::string &data, int shard) {
+  std::ostringstream base;
+  base << data << ".s" << shard;
+  return base.str();
+}
+
+
+// Records how far the shard got in <data>.s<shard>.shard, for the coordinator
+void writeShardReport(IloCplex &cplex, const Shard &shard, const RunSettings &settings, const std::string &base, double bound) {
+  std::string filename(base);
+  std::ofstream file(filename.append(".shard").c_str(), std::ofstream::out);
+  bool completed = cplex.getStatus() == IloAlgorithm::Optimal || cplex.getStatus() == IloAlgorithm::Infeasible;
+  file << "Shard " << shard.index << " " << settings.shards << std::endl;
+  file << "Split " << getSplitName(settings.split) << std::endl;
+  file << "Restriction " << shard.description << std::endl;
+  file << "Status " << cplex.getStatus() << std::endl;
+  file << "Completed " << (completed ? 1 : 0) << std::endl;
+  file << "Bound " << bound << std::endl;
+  if (cplex.getSolnPoolNsolns() >= 1) file << "Incumbent " << cplex.getObjValue() << std::endl;
+  file << "Nodes " << cplex.getNnodes() << std::endl;
+  file.close();
+}
+
+
+int solveInstance(const std::string &data, const RunSettings &settings) {
+  const std::string base = !settings.output.empty() ? settings.output
+    : (settings.shard >= 0 ? getShardBase(data, settings.shard) : data);
+  string filename(base);
+  int failures = 0;
 
   IloEnv env;
+  ofstream out;
+  if (settings.quiet) {
+    filename.append(".out");
+    out.open(filename.c_str(), std::ofstream::out);
+    env.setOut(out);
+    env.setWarning(out);
+  }
 
   try {
 
     IloModel model(env);
     TimetablingInstance instance;
-    instance.load(filename.c_str());
+    std::string error;
+    if (!instance.parse(data.c_str(), error)) {
+      std::cerr << "Solver: There was an error reading the instance " << data << ": " << error << std::endl;
+      env.end();
+      return 1;
+    }
+    std::cout << "Solver: Instance " << instance.getName() << " (" << data << ")" << std::endl;
+    int conflicts = instance.reduceConflicts(settings.conflicts);
+    std::cout << "Solver: Conflicts of " << instance.getCurriculumCount() << " curricula as "
+      << conflicts << " " << getConflictReductionName(settings.conflicts) << " row(s) per period" << std::endl;
+    PresolveResult presolved;
+    if (settings.presolve) {
+      IloNum start = env.getTime();
+      if (!presolveInstance(instance, presolved)) {
+        std::cout << "Presolve: Instance " << instance.getName() << " is infeasible: " << presolved.reason << std::endl;
+        env.end();
+        return 1;
+      }
+      int forced = std::count(presolved.forced.begin(), presolved.forced.end(), 1);
+      std::cout << "Presolve: " << presolved.removed << " period(s) of courses removed and " << forced
+        << " course(s) fixed in " << presolved.rounds << " round(s), " << 1000 * (env.getTime() - start) << " ms" << std::endl;
+    }
 
     bool isSubMIP = false;
-    bool useCoursePeriods = false;
-    TimetablingSolver solver(model, instance, isSubMIP, useCoursePeriods);
-
-    solver.exportConfictGraph(filename.append(".dimacs").c_str());
+    bool useCoursePeriods = settings.coursePeriods;
+    bool useLagrangian = settings.lagrangian;
+    bool useFirstOrderLP = settings.firstOrderLP;
+    TimetablingSolver solver(model, instance, isSubMIP, useCoursePeriods, settings.cuts);
+    if (settings.presolve) {
+      int fixed = solver.applyPresolve(presolved);
+      std::cout << "Presolve: " << fixed << " of x fixed at zero" << std::endl;
+    }
+    if (settings.symmetry) {
+      SymmetryOrbits orbits;
+      findOrbits(instance, orbits);
+      int rows = solver.breakSymmetry(orbits);
+      std::cout << "Solver: Symmetry of " << orbits.rooms.size() << " class(es) of rooms and "
+        << orbits.courses.size() << " of courses broken by " << rows << " row(s)" << std::endl;
+    }
 
     IloCplex cplex(model);
-    filename = argv[1];
-    cplex.exportModel(filename.append(".lp").c_str());
+    solver.addCutPools(cplex);
 
-    // filename = argv[1];
+    // The exports are of no use in a batch of bounds, nor in a probe
+    if (!settings.boundMode && !settings.probe) {
+      filename = base;
+      solver.exportConfictGraph(filename.append(".dimacs").c_str());
+      filename = base;
+      cplex.exportModel(filename.append(".lp").c_str());
+    }
+
+    // filename = data;
     // solver.importSolution(cplex, instance, filename.append(".sol").c_str());
 
-    filename = argv[1];
-    ofstream file;
-    file.open(filename.append(".log").c_str(), std::ofstream::out);
-    file << ""; file.close();
-
-    int cutUp = -1;
-    int cutLevel = 5;
-    if (argc >= 3) {
-      istringstream convert(argv[2]);
-      if (!(convert >> cutUp)) cutUp = -1;
-      if (argc >= 4) {
-        istringstream convert2(argv[3]);
-        if (!(convert2 >> cutLevel)) cutLevel = 5;
-      }
-    }
+    // The progress goes to <data>.events as it happens, and to <data>.log once done
+    filename = base;
+    EventLog events(filename.append(".events"));
 
-    // 3 CPX_MIPEMPHASIS_BESTBOUND  Emphasize moving best bound  
-    cplex.setParam(IloCplex::MIPEmphasis, 3);
+    int cutUp = settings.cutUp;
+    int cutLevel = settings.cutLevel;
+    int threads = settings.threads > 0 ? settings.threads : boost::thread::hardware_concurrency();
 
-    // 6 CPX_ALG_CONCURRENT  Concurrent (Dual, Barrier, and Primal) 
-    // 4 CPX_ALG_BARRIER  Barrier 
-    cplex.setParam(IloCplex::RootAlg, 6);
-    // cplex.setParam(IloCplex::RootAlg, 4);
+    // The parameters of CPLEX are those of the configuration, kept in <data>.prm for the record;
+    // readParam resets any parameter not in the file to its default, so it goes first
+    filename = base;
+    filename.append(".prm");
+    if (settings.configuration.writeParamFile(filename, cplex.getVersion())) cplex.readParam(filename.c_str());
+    else std::cerr << "Solver: Cannot write the parameters to " << filename << std::endl;
+    if (settings.threads > 0) cplex.setParam(IloCplex::Threads, settings.threads);
 
-    // When NodeLim is set to 1, nodes are created but not solved.
-    cplex.setParam(IloCplex::NodeLim, 0);
-    cplex.setParam(IloCplex::TiLim, 7200);
     // CPLEX discards any solutions that are greater than the upper cutoff value.
     if (cutUp > 0) cplex.setParam(IloCplex::CutUp, cutUp);
+#ifdef CPX_PARAM_RANDOMSEED
+    if (settings.seed > 0) cplex.setParam(IloCplex::RandomSeed, settings.seed);
+#endif
 
-    // Minor params
-    cplex.setParam(IloCplex::RepeatPresolve, 3);
-    cplex.setParam(IloCplex::Symmetry, 3);
-    cplex.setParam(IloCplex::MIPInterval, 1);
-    cplex.setParam(IloCplex::WriteLevel, 1);
-    cplex.setParam(IloCplex::MIPDisplay, 4);
-    cplex.setParam(IloCplex::PreDual, 1);
-
-    // Other params worth experimenting with
-    // cplex.setParam(IloCplex::PreDual, -1);
-    // cplex.setParam(IloCplex::BrDir, 1);
-    // cplex.setParam(IloCplex::VarSel, 3);
-    // cplex.setParam(IloCplex::ZeroHalfCuts, 2);
-    // cplex.setParam(IloCplex::PreslvNd, 2);
-
-    // The in-built heuristics need to be disabled, as they are unaware of Type 1 cuts!
-    cplex.setParam(IloCplex::HeurFreq, -1);
-    cplex.setParam(IloCplex::RINSHeur, -1);
-    cplex.setParam(IloCplex::FPHeur, -1);
-
-    cplex.use(CutManager(env, cplex, solver, cutUp, cutLevel));
-    cplex.use(IncumbentSaver(env, solver, argv[1]));
+    // Combinatorial lower bounds, which the model does not know about, as a lower cutoff
+    Penalties bounds = getLowerBounds(instance, false);
+    env.out() << "Bounds: Room capacity " << bounds.roomCapacity
+      << ", min working days " << bounds.minWorkingDays
+      << ", isolated lectures " << bounds.isolatedLectures
+      << ", total " << bounds.getSoft() << std::endl;
+
+    // The Lagrangian bound leaves out isolated lectures, which can thus be added
+    int lowerBound = bounds.getSoft();
+    if (useLagrangian) {
+      LagrangianBound lagrangian(instance, threads);
+      int lagrangianBound = lagrangian.solve(cutUp) + bounds.isolatedLectures;
+      env.out() << "Bounds: Lagrangian " << lagrangianBound << std::endl;
+      lowerBound = std::max(lowerBound, lagrangianBound);
+      if (cutUp > 0) {
+        Lectures fixed;
+        lagrangian.getFixings(cutUp - bounds.isolatedLectures, fixed);
+        solver.excludeLectures(fixed);
+        env.out() << "Bounds: Reduced-cost fixing excludes " << fixed.size() << " lectures" << std::endl;
+      }
+    }
+
+    // The root LP by a first-order method, whose duals give a bound and reduced costs
+    if (useFirstOrderLP) {
+      SparseLP lp;
+      solver.getSparseLP(lp);
+      PdhgSolver pdhg(lp, threads);
+      double lpBound = pdhg.solve();
+      env.out() << "Bounds: First-order LP " << lpBound << " after " << pdhg.getIterations() << " iterations"
+        << " (primal " << pdhg.getPrimalObjective() << ", residual " << pdhg.getPrimalResidual() << ")" << std::endl;
+      lowerBound = std::max(lowerBound, int(std::ceil(lpBound - 1e-6)));
+      if (cutUp > 0) {
+        // x[p][r][c] come first in vars.all; raising any to one costs at least its reduced cost
+        std::vector<double> reducedCosts;
+        pdhg.getReducedCosts(reducedCosts);
+        int C = instance.getCourseCount(), R = instance.getRoomCount();
+        Lectures fixed;
+        for (int k = 0; k < instance.getPeriodCount() * R * C; k++)
+          if (lp.columnUpper[k] > 0 && lpBound + reducedCosts[k] > cutUp + 1e-6) {
+            Lecture l;
+            l.course = k % C; l.room = (k / C) % R; l.period = k / (C * R);
+            fixed.push_back(l);
+          }
+        solver.excludeLectures(fixed);
+        env.out() << "Bounds: Reduced-cost fixing by the LP excludes " << fixed.size() << " lectures" << std::endl;
+      }
+    }
+    if (lowerBound > 0) solver.boundObjective(lowerBound);
+
+    // Only a part of the search space, which any bound on all of it bounds, too
+    Shard shard;
+    if (settings.shard >= 0) {
+      std::vector<Shard> shards;
+      partitionSearch(instance, settings.split, settings.shards, shards);
+      if (settings.shard >= int(shards.size())) {
+        std::cerr << "Solver: There is no shard " << settings.shard << " of " << shards.size()
+          << " split on " << getSplitName(settings.split) << std::endl;
+        env.end();
+        return 1;
+      }
+      shard = shards[settings.shard];
+      solver.restrictToShard(shard);
+      std::cout << "Solver: Shard " << shard.index << " of " << shards.size() << ": " << shard.description << std::endl;
+    }
+
+    SeparationScheduler scheduler(settings.policy);
+    SeparationTelemetry telemetry;
+    SnapshotFile snapshots;
+    filename = base;
+    if (settings.snapshots && !snapshots.create(filename.append(".snapshots"), instance))
+      std::cerr << "Solver: Cannot record the snapshots in " << filename << std::endl;
+    cplex.use(CutManager(env, cplex, solver, cutUp, cutLevel, scheduler, telemetry, events,
+      settings.tailOff, settings.tailOffRounds, settings.snapshots ? &snapshots : 0));
+    SolutionWriter writer(instance, base.c_str());
+    cplex.use(IncumbentSaver(env, solver, writer, events, settings.exchange, settings.member));
+    if (settings.exchange) cplex.use(IncumbentExchange(env, *settings.exchange, settings.member));
 
     env.out() << std::endl << "Solver: Running ..." << std::endl;
+    double start = env.getTime();
     cplex.solve();
+    writer.flush();
+    scheduler.report(env.out());
+    solver.getCutRegistry().report(env.out(), scheduler);
+    if (settings.telemetry == "csv") telemetry.writeCsv(base);
+    if (settings.telemetry == "json") telemetry.writeJson(base);
 
     if (cplex.getSolnPoolNsolns() >= 1) {
-      filename = argv[1];
+      filename = base;
       cplex.writeMIPStart(filename.append(".opt").c_str());
     }
 
-    filename = argv[1];
-    file.open(filename.append(".log").c_str(), std::ofstream::app);
     IloNum LB = cplex.getBestObjValue();
     if (LB < 0.001) LB = 0;
-    file << env.getTime() << " " << cplex.getNnodes() << " " << LB << std::endl;
-    file.close();  
+    events.push(BoundEvent, cplex.getNnodes(), LB);
+    if (settings.exchange) {
+      settings.exchange->updateBound(settings.member, LB);
+      if (cplex.getStatus() == IloAlgorithm::Optimal || cplex.getStatus() == IloAlgorithm::Infeasible)
+        settings.exchange->complete(settings.member);
+    }
+    events.close();
+    if (events.getDropped() > 0)
+      env.out() << "Solver: " << events.getDropped() << " event(s) dropped from the log" << std::endl;
+    if (settings.shard >= 0) writeShardReport(cplex, shard, settings, base, LB);
+    if (settings.probe) {
+      settings.probe->bound = std::max<double>(lowerBound, LB);
+      settings.probe->seconds = env.getTime();
+      settings.probe->nodes = cplex.getNnodes();
+      settings.probe->solved = cplex.getStatus() == IloAlgorithm::Optimal || cplex.getStatus() == IloAlgorithm::Infeasible;
+    }
+    filename = base;
+    ofstream file(filename.append(".log").c_str(), std::ofstream::out);
+    convertEvents(base + ".events", file);
+    file.close();
+
+    if (settings.boundMode) {
+      writeBoundCertificate(cplex, instance, settings, bounds, lowerBound, env.getTime() - start);
+      std::cout << "Solver: Instance " << instance.getName() << " has a lower bound of "
+        << std::max<double>(lowerBound, LB) << std::endl;
+    }
 
     env.out() << std::endl << "Solver: ";
     if (cplex.getStatus() == IloAlgorithm::Feasible || 
@@ -133,12 +436,528 @@ int main (int argc, char **argv) {
   }
   catch (IloException& e) {
     std::cerr << "Solver: Concert exception caught: " << e << std::endl;
+    failures = 1;
   }
   catch (...) {
     std::cerr << "Solver: Unknown exception caught" << std::endl;
+    failures = 1;
   }
 
   env.end();
+  return failures;
+}
+
+
+// Runs one member of a portfolio
+struct PortfolioWorker {
+  std::string data;
+  RunSettings settings;
+  int *failures;
+  void operator()() {
+    *failures = solveInstance(data, settings);
+  }
+};
+
+
+/* Solves an instance several ways at a time, each writing to <data>.m<member>.*, sharing
+* the best incumbent as a cutoff and the best bound, until one proves optimality, the bound
+* meets the incumbent, or the time runs out. The members differ in emphasis, the level of cuts,
+* the formulation and the seed; beyond the configurations listed, they differ only in the seed.
+*/
+int solvePortfolio(const std::string &data, const RunSettings &settings) {
+  int members = std::max(1, std::min(settings.portfolio, MaxExchangeMembers));
+  SolutionExchange exchange(SameProblem, members);
+  std::vector<int> failures(members, 0);
+  std::vector<RunSettings> configured(members, settings);
+  int threads = settings.threads > 0 ? settings.threads : int(boost::thread::hardware_concurrency());
+
+  boost::thread_group group;
+  for (int m = 0; m < members; m++) {
+    const PortfolioMember &member = portfolioMembers[m % portfolioMemberCount];
+    RunSettings &s = configured[m];
+    std::ostringstream emphasis;
+    emphasis << member.emphasis;
+    s.configuration.set("CPX_PARAM_MIPEMPHASIS", emphasis.str());
+    s.cutLevel = std::max(1, std::min(6, settings.cutLevel + member.cutLevel));
+    s.coursePeriods = member.coursePeriods;
+    s.seed = settings.seed + m;
+    s.threads = std::max(1, threads / members);
+    s.quiet = true;
+    s.exchange = &exchange;
+    s.member = m;
+    std::ostringstream output;
+    output << data << ".m" << m;
+    s.output = output.str();
+    std::cout << "Portfolio: Member " << m << " (" << member.name << ", level " << s.cutLevel
+      << ", seed " << s.seed << ") writes to " << s.output << ".*" << std::endl;
+    PortfolioWorker worker = { data, s, &failures[m] };
+    group.create_thread(worker);
+  }
+  group.join_all();
+
+  int failed = 0;
+  for (int m = 0; m < members; m++) failed += failures[m];
+  std::cout << "Portfolio: Instance " << data << " has a bound of " << exchange.getBound();
+  if (exchange.getOwner() >= 0)
+    std::cout << " and a timetable of " << exchange.getIncumbent() << " in " << data << ".m" << exchange.getOwner() << ".*";
+  else std::cout << " and no timetable";
+  std::cout << (exchange.isClosed() ? ", closed" : ", open") << std::endl;
+  return failed > 0 ? 1 : 0;
+}
+
+
+// What a shard reported in <data>.s<shard>.shard
+struct ShardReport {
+  bool found, completed, hasIncumbent;
+  double bound, incumbent;
+  std::string restriction, status;
+};
+
+
+bool readShardReport(const std::string &data, int shard, ShardReport &report) {
+  report.found = report.completed = report.hasIncumbent = false;
+  report.bound = report.incumbent = 0;
+  std::ifstream file((getShardBase(data, shard) + ".shard").c_str());
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string key;
+    fields >> key;
+    if (key == "Restriction") std::getline(fields >> std::ws, report.restriction);
+    else if (key == "Status") fields >> report.status;
+    else if (key == "Completed") fields >> report.completed;
+    else if (key == "Bound") fields >> report.bound;
+    else if (key == "Incumbent") report.hasIncumbent = !(fields >> report.incumbent).fail();
+    report.found = true;
+  }
+  return report.found;
+}
+
+
+/* The bound on the whole of the search space is the least of the bounds of the parts,
+* where a part completed holds nothing better than the best incumbent of any part.
+* Works for the shards solved on a cluster, too, as long as their output is at hand.
+*/
+int aggregateShards(const std::string &data, const RunSettings &settings) {
+  int owner = -1, missing = 0;
+  double incumbent = 0, bound = 1e30;
+  std::vector<ShardReport> reports(settings.shards);
+  for (int i = 0; i < settings.shards; i++)
+    if (readShardReport(data, i, reports[i]) && reports[i].hasIncumbent && (owner < 0 || reports[i].incumbent < incumbent)) {
+      incumbent = reports[i].incumbent;
+      owner = i;
+    }
+  for (int i = 0; i < settings.shards; i++) {
+    const ShardReport &r = reports[i];
+    std::cout << "Shards: [" << i << "] ";
+    if (!r.found) {
+      std::cout << "no report in " << getShardBase(data, i) << ".shard" << std::endl;
+      missing += 1;
+      bound = 0;
+      continue;
+    }
+    // A part proven infeasible holds no timetable within the cutoff and its bound is of no meaning
+    if (r.completed && r.status == "Infeasible") {
+      std::cout << r.restriction << ": " << r.status << std::endl;
+      continue;
+    }
+    std::cout << r.restriction << ": " << r.status << ", bound " << r.bound;
+    if (r.hasIncumbent) std::cout << ", incumbent " << r.incumbent;
+    std::cout << std::endl;
+    bound = std::min(bound, (r.completed && owner >= 0) ? incumbent : r.bound);
+  }
+  if (owner >= 0) bound = std::min(bound, incumbent);
+
+  std::cout << "Shards: Instance " << data << " has a ";
+  if (bound < 1e30) std::cout << "bound of " << bound;
+  else std::cout << "bound of infinity, as no shard holds a timetable within the cutoff";
+  if (owner >= 0) std::cout << " and a timetable of " << incumbent << " in " << getShardBase(data, owner) << ".*";
+  std::cout << std::endl;
+  return missing > 0 ? 1 : 0;
+}
+
+
+#ifndef _WIN32
+// Runs this program on one shard, with the settings given and the shared memory of the coordinator
+static pid_t launchShard(const std::string &data, const RunSettings &settings, int shard, int threads) {
+  pid_t pid = fork();
+  if (pid != 0) return pid;
+
+  std::vector<std::string> args;
+  std::ostringstream convert;
+  args.push_back(settings.program);
+  convert << settings.shards;
+  args.push_back("-S"); args.push_back(convert.str());
+  args.push_back("-k"); args.push_back(getSplitName(settings.split));
+  convert.str(""); convert << shard;
+  args.push_back("-i"); args.push_back(convert.str());
+  args.push_back("-x"); args.push_back(settings.exchangeName);
+  args.push_back("-c"); args.push_back(data + ".shards.cfg");
+  convert.str(""); convert << threads;
+  args.push_back("-t"); args.push_back(convert.str());
+  args.push_back("-m"); args.push_back(settings.telemetry);
+  if (settings.boundMode) args.push_back("-b");
+  if (settings.snapshots) args.push_back("-s");
+  args.push_back(data);
+  convert.str(""); convert << settings.cutUp;
+  args.push_back(convert.str());
+
+  std::vector<char *> argv;
+  for (size_t i = 0; i < args.size(); i++) argv.push_back(const_cast<char *>(args[i].c_str()));
+  argv.push_back(0);
+  execvp(settings.program.c_str(), &argv[0]);
+  std::perror("Shards: Cannot run the shard");
+  _exit(127);
+}
+#endif
+
+
+/* Splits the search space of an instance into parts, solves each in a process of its own,
+* with the threads split among them, and reports the least of their bounds. The processes
+* share the best incumbent as a cutoff and stop, once the bounds meet it, through shared memory.
+* On a cluster, each shard can be run on its own with -i <shard>, and the bound found with -a.
+*/
+int solveShards(const std::string &data, const RunSettings &settings) {
+#ifdef _WIN32
+  std::cerr << "Shards: Running shards is not supported on Windows, but -i <shard> is" << std::endl;
+  return 1;
+#else
+  TimetablingInstance instance;
+  std::string error;
+  if (!instance.parse(data.c_str(), error)) {
+    std::cerr << "Shards: There was an error reading the instance " << data << ": " << error << std::endl;
+    return 1;
+  }
+  std::vector<Shard> shards;
+  partitionSearch(instance, settings.split, settings.shards, shards);
+  RunSettings s(settings);
+  s.shards = shards.size();
+  std::ostringstream name;
+  name << "udine-shards-" << getpid() << "-" << instance.getName();
+  s.exchangeName = name.str();
+  for (size_t i = 0; i < s.exchangeName.size(); i++)
+    if (!std::isalnum(s.exchangeName[i])) s.exchangeName[i] = '-';
+  SolutionExchange exchange(s.exchangeName, PartitionedProblem, s.shards, true);
+  if (!exchange.isValid()) {
+    std::cerr << "Shards: Cannot create the shared memory " << s.exchangeName << std::endl;
+    return 1;
+  }
+  if (!settings.configuration.write(data + ".shards.cfg")) {
+    std::cerr << "Shards: Cannot write the configuration to " << data << ".shards.cfg" << std::endl;
+    return 1;
+  }
+  int threads = settings.threads > 0 ? settings.threads : int(boost::thread::hardware_concurrency());
+  threads = std::max(1, threads / s.shards);
+  std::cout << "Shards: Instance " << data << " split on " << getSplitName(s.split) << " into "
+    << s.shards << " shard(s) of " << threads << " thread(s) each" << std::endl;
+
+  // Only the shards forked here are waited for, leaving any other children of the process to their owners
+  int failures = 0;
+  std::set<pid_t> running;
+  for (int i = 0; i < s.shards; i++) {
+    std::cout << "Shards: [" << i << "] " << shards[i].description << std::endl;
+    pid_t pid = launchShard(data, s, i, threads);
+    if (pid < 0) {
+      std::perror("Shards: Cannot fork");
+      failures += 1;
+    } else running.insert(pid);
+  }
+  int elapsed = 0;
+  while (!running.empty()) {
+    std::vector<pid_t> finished;
+    for (std::set<pid_t>::iterator it = running.begin(); it != running.end(); it++) {
+      int status;
+      pid_t pid = waitpid(*it, &status, WNOHANG);
+      if (pid == 0) continue;
+      finished.push_back(*it);
+      if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) failures += 1;
+    }
+    for (size_t k = 0; k < finished.size(); k++) running.erase(finished[k]);
+    if (!finished.empty()) continue;
+    boost::this_thread::sleep(boost::posix_time::seconds(1));
+    if (++elapsed % 60 == 0)
+      std::cout << "Shards: " << running.size() << " running after " << elapsed << " s, bound " << exchange.getBound()
+        << ", incumbent " << exchange.getIncumbent() << std::endl;
+  }
+
+  failures += aggregateShards(data, s);
+  return failures > 0 ? 1 : 0;
+#endif
+}
+
+
+int runInstance(const std::string &data, const RunSettings &settings);
+
+
+// Runs one root probe of autoselect
+struct ProbeWorker {
+  std::string data;
+  RunSettings settings;
+  int *failures;
+  void operator()() {
+    *failures = solveInstance(data, settings);
+  }
+};
+
+
+/* Builds each of the formulation candidates in a thread of its own, with the threads of CPLEX
+* split among them, and runs the root of each for up to the seconds of autoselect, writing to
+* <data>.f<candidate>.*. The candidate with the most bound per second, counting from reading
+* the instance, is then solved as configured; the probes are summarised in <data>.autoselect.
+* The Lagrangian and first-order bounds are the same for all of them, so the probes skip them.
+*/
+int solveSelected(const std::string &data, const RunSettings &settings) {
+  std::vector<RunSettings> candidates;
+  std::vector<int> names;
+  std::string error;
+  for (int k = 0; k < formulationCandidateCount; k++) {
+    RunSettings s = settings;
+    s.configuration.remove("autoselect");
+    std::istringstream changes(formulationCandidates[k].changes);
+    std::string change;
+    while (changes >> change)
+      if (!s.configuration.assign(change, error)) break;
+    if (!error.empty() || !applyConfiguration(s, error)) {
+      std::cerr << "Autoselect: Cannot configure " << formulationCandidates[k].name << ": " << error << std::endl;
+      error.clear();
+      continue;
+    }
+    // The same formulation under another name is probed once
+    std::ostringstream described;
+    s.configuration.describe(described);
+    bool seen = false;
+    for (size_t j = 0; j < candidates.size(); j++) {
+      std::ostringstream other;
+      candidates[j].configuration.describe(other);
+      seen = seen || other.str() == described.str();
+    }
+    if (seen) continue;
+    candidates.push_back(s);
+    names.push_back(k);
+  }
+
+  int count = candidates.size();
+  int threads = settings.threads > 0 ? settings.threads : int(boost::thread::hardware_concurrency());
+  std::vector<ProbeResult> results(count);
+  std::vector<int> failures(count, 0);
+  std::ostringstream limit;
+  limit << settings.autoselect;
+  boost::thread_group group;
+  for (int k = 0; k < count; k++) {
+    RunSettings s = candidates[k];
+    s.configuration.set("CPX_PARAM_TILIM", limit.str());
+    s.configuration.set("CPX_PARAM_NODELIM", "0");
+    s.threads = std::max(1, threads / count);
+    s.lagrangian = s.firstOrderLP = false;
+    s.quiet = true;
+    s.snapshots = false;
+    s.telemetry = "none";
+    s.exchange = 0;
+    s.probe = &results[k];
+    results[k].bound = results[k].seconds = 0;
+    results[k].nodes = 0;
+    results[k].solved = false;
+    std::ostringstream output;
+    output << data << ".f" << k;
+    s.output = output.str();
+    ProbeWorker worker = { data, s, &failures[k] };
+    group.create_thread(worker);
+  }
+  group.join_all();
+
+  int best = -1;
+  double bestScore = 0;
+  std::ofstream file((data + ".autoselect").c_str(), std::ofstream::out);
+  for (int k = 0; k < count; k++) {
+    const ProbeResult &r = results[k];
+    double score = r.bound / std::max(r.seconds, 0.01);
+    std::ostringstream line;
+    line << "Probe " << k << " " << formulationCandidates[names[k]].name;
+    if (failures[k] > 0) line << " failed";
+    else line << " bound " << r.bound << " in " << r.seconds << " s, " << r.nodes << " nodes"
+      << (r.solved ? ", solved" : "") << ", score " << score;
+    std::cout << "Autoselect: " << line.str() << std::endl;
+    file << line.str() << std::endl;
+    if (failures[k] > 0) continue;
+    // Ties go to the quicker, e.g. where every bound is zero
+    if (best < 0 || score > bestScore + 1e-9
+      || (score > bestScore - 1e-9 && r.seconds < results[best].seconds)) {
+      best = k;
+      bestScore = score;
+    }
+  }
+  if (best < 0) {
+    std::cerr << "Autoselect: No probe of " << data << " succeeded" << std::endl;
+    return 1;
+  }
+
+  RunSettings winner = candidates[best];
+  winner.autoselect = 0;
+  std::ostringstream described;
+  winner.configuration.describe(described);
+  std::cout << "Autoselect: Continuing with " << formulationCandidates[names[best]].name
+    << ": " << described.str() << std::endl;
+  file << "Selected " << best << " " << formulationCandidates[names[best]].name << std::endl;
+  file << "Configuration " << described.str() << std::endl;
+  file.close();
+  return runInstance(data, winner);
+}
+
+
+// Solves one instance as the settings say
+int runInstance(const std::string &data, const RunSettings &settings) {
+  if (settings.autoselect > 0 && settings.shard < 0 && !settings.aggregate) return solveSelected(data, settings);
+  if (settings.aggregate) return aggregateShards(data, settings);
+  if (settings.shards > 1 && settings.shard < 0) return solveShards(data, settings);
+  if (settings.portfolio > 1) return solvePortfolio(data, settings);
+  return solveInstance(data, settings);
+}
+
+
+// Solves the instances one after another, several at a time in bound mode
+struct InstanceWorker {
+  WorkQueue *queue;
+  const std::vector<std::string> *instances;
+  const RunSettings *settings;
+  int *failures;
+  boost::mutex *lock;
+  void operator()() {
+    int i;
+    while ((i = queue->pop()) >= 0) {
+      int failed = runInstance((*instances)[i], *settings);
+      boost::mutex::scoped_lock l(*lock);
+      *failures += failed;
+    }
+  }
+};
+
+
+int main (int argc, char **argv) {
+
+  RunSettings settings;
+  settings.cutUp = -1;
+  settings.boundMode = false;
+  settings.telemetry = "csv";
+  settings.snapshots = false;
+  settings.portfolio = 1;
+  settings.exchange = 0;
+  settings.member = 0;
+  settings.shards = 1;
+  settings.shard = -1;
+  settings.split = MinDaysSplit;
+  settings.aggregate = false;
+  settings.probe = 0;
+  settings.program = argv[0];
+  int jobs = 1;
+  std::vector<std::string> instances;
+  int numbers = 0;
+  std::string error;
+
+  // The options which are knobs of the configuration go into it, in the order given
+  for (int a = 1; a < argc; a++) {
+    std::string arg(argv[a]);
+    if (arg == "-c" && a + 1 < argc) {
+      if (!settings.configuration.read(argv[++a], error)) {
+        std::cerr << "Solver: There was an error reading the configuration " << error << std::endl;
+        exit(-1);
+      }
+      continue;
+    }
+    if (arg == "-C" && a + 1 < argc) {
+      if (!settings.configuration.assign(argv[++a], error)) {
+        std::cerr << "Solver: There was an error in the configuration: " << error << std::endl;
+        exit(-1);
+      }
+      continue;
+    }
+    if (arg == "-o" && a + 1 < argc) { settings.output = argv[++a]; continue; }
+    if (arg == "-b") { settings.boundMode = true; continue; }
+    if (arg == "-s") { settings.snapshots = true; continue; }
+    if (arg == "-a") { settings.aggregate = true; continue; }
+    if (arg == "-S" && a + 1 < argc) { settings.shards = std::atoi(argv[++a]); continue; }
+    if (arg == "-i" && a + 1 < argc) { settings.shard = std::atoi(argv[++a]); continue; }
+    if (arg == "-x" && a + 1 < argc) { settings.exchangeName = argv[++a]; continue; }
+    if (arg == "-k" && a + 1 < argc) {
+      if (!getSplitByName(argv[++a], settings.split)) {
+        std::cerr << "Solver: There was an error in the options: unknown split " << argv[a] << std::endl;
+        exit(-1);
+      }
+      continue;
+    }
+    if (arg == "-P" && a + 1 < argc) { settings.portfolio = std::atoi(argv[++a]); continue; }
+    if (arg == "-A" && a + 1 < argc) { settings.configuration.set("autoselect", argv[++a]); continue; }
+    if (arg == "-j" && a + 1 < argc) { jobs = std::atoi(argv[++a]); continue; }
+    if (arg == "-t" && a + 1 < argc) { settings.configuration.set("threads", argv[++a]); continue; }
+    if (arg == "-e" && a + 1 < argc) { settings.configuration.set("tailOff", argv[++a]); continue; }
+    if (arg == "-r" && a + 1 < argc) { settings.configuration.set("tailOffRounds", argv[++a]); continue; }
+    if (arg == "-m" && a + 1 < argc) { settings.telemetry = argv[++a]; continue; }
+    if (arg == "-p" && a + 1 < argc) { settings.configuration.set("policy", argv[++a]); continue; }
+
+    // [cutUp] and [cutLevel] follow the instances
+    istringstream convert(arg);
+    int value;
+    if (!instances.empty() && (convert >> value) && convert.eof()) {
+      if (numbers++ == 0) settings.cutUp = value;
+      else settings.configuration.set("cutLevel", arg);
+      continue;
+    }
+    if (endsWith(arg, ".ctt") || !listInstances(arg, instances)) instances.push_back(arg);
+  }
+
+  if (instances.empty()) { 
+    std::cerr << "Usage: " << argv[0] << " [-c <file>] [-C <name>=<value>] [-b] [-j <jobs>] [-t <threads>] [-e <tailOff>] [-r <rounds>]" << std::endl;
+    std::cerr << "       [-p <policy>] [-m <format>] [-s] [-o <output>] [-P <members>] [-A <seconds>]" << std::endl;
+    std::cerr << "       [-S <shards> [-k <split>] [-i <shard>] [-a]]" << std::endl;
+    std::cerr << "       <data> [cutUp] [cutLevel]" << std::endl;
+    std::cerr << "where: <data> is a path to an instance of Udine Timetabling, or a directory of them," << std::endl;
+    std::cerr << "       [cutUp] is an optional value of a known solution, and [cutLevel] is 5 by default" << std::endl;
+    std::cerr << "       -c reads the parameters of CPLEX, as CPX_PARAM_<name> = <value>, and the knobs of the solver" << std::endl;
+    std::cerr << "          from a file, such as ./examples/udine.cfg, and -C sets one; the options below are knobs, too" << std::endl;
+    std::cerr << "       -b only bounds each instance at the root, with all separators until the bound" << std::endl;
+    std::cerr << "          improves by less than <tailOff> (0.05) in <rounds> (3) rounds in a row," << std::endl;
+    std::cerr << "          and writes the bound to <data>.bound, for <jobs> instances at a time" << std::endl;
+    std::cerr << "       -t limits the threads per instance, which is all of them over <jobs> in bound mode" << std::endl;
+    std::cerr << "       -p chooses when to separate which cuts: all (default), depth, or adaptive" << std::endl;
+    std::cerr << "       -m writes the counters of the separation as csv (default) or json next to <data>, or none" << std::endl;
+    std::cerr << "       -s records the relaxations and the cuts found in <data>.snapshots, for bench-separation" << std::endl;
+    std::cerr << "       -o writes the output files to <output>.* rather than <data>.*" << std::endl;
+    std::cerr << "       -A probes the root of each of a few formulations at a time for up to <seconds>," << std::endl;
+    std::cerr << "          with the output in <data>.f<candidate>.*, and solves the best bound per second" << std::endl;
+    std::cerr << "       -P solves each instance <members> ways at a time, sharing the incumbent and the bound," << std::endl;
+    std::cerr << "          with the threads split among them and the output in <data>.m<member>.*" << std::endl;
+    std::cerr << "       -S splits the search space on <split>: mindays (default), rooms or days, into up to <shards>" << std::endl;
+    std::cerr << "          solved by processes of their own, with the output in <data>.s<shard>.*;" << std::endl;
+    std::cerr << "          -i solves only the shard given, e.g. on a cluster, and -a reports on those solved" << std::endl;
+    exit(-1); 
+  }
+
+  if (!applyConfiguration(settings, error)) {
+    std::cerr << "Solver: There was an error in the configuration: " << error << std::endl;
+    exit(-1);
+  }
+  jobs = settings.boundMode ? std::max(1, std::min<int>(jobs, instances.size())) : 1;
+  if (settings.boundMode && settings.threads <= 0)
+    settings.threads = std::max(1, int(boost::thread::hardware_concurrency()) / jobs);
+  settings.quiet = (jobs > 1) || settings.shard >= 0;
+
+  // A shard of the coordinator shares the incumbent and the bounds through its memory
+  SolutionExchange *exchange = 0;
+  if (settings.shard >= 0 && !settings.exchangeName.empty()) {
+    exchange = new SolutionExchange(settings.exchangeName, PartitionedProblem, settings.shards, false);
+    if (exchange->isValid()) {
+      settings.exchange = exchange;
+      settings.member = settings.shard;
+    } else std::cerr << "Solver: Cannot open the shared memory " << settings.exchangeName << std::endl;
+  }
+
+  int failures = 0;
+  boost::mutex lock;
+  WorkQueue queue(instances.size());
+  InstanceWorker worker = { &queue, &instances, &settings, &failures, &lock };
+  boost::thread_group group;
+  for (int t = 0; t < jobs; t++) group.create_thread(worker);
+  group.join_all();
 
-  return 0;
+  delete exchange;
+  return failures > 0 ? 1 : 0;
 }
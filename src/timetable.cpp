@@ -0,0 +1,56 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <string>
+
+#include "timetable.h"
+#include "tokenizer.h"
+
+
+bool loadSolution(TimetablingInstance &instance, const char *filename, Lectures &lectures, int *unparsed) {
+  Tokenizer tokens;
+  if (!tokens.open(filename)) return false;
+
+  lectures.clear();
+  if (unparsed) *unparsed = 0;
+  int ppd = instance.getPeriodsPerDayCount();
+  std::string rname;
+  while (!tokens.isEnd()) {
+    Token t[5];
+    int n = 0, d, pwd;
+    while (n < 5 && tokens.nextInLine(t[n])) n++;
+    tokens.nextLine();
+    if (n != 4 || !t[2].toInt(d) || !t[3].toInt(pwd)) continue;
+
+    Lecture l;
+    l.course = instance.findCourseId(t[0].str());
+    rname = t[1].str();
+    if (rname.size() > 1 && rname[0] == 'r') rname = rname.substr(1);
+    l.room = instance.findRoomId(rname);
+    if (l.course < 0 || l.room < 0 || d < 0 || d >= instance.getDayCount() || pwd < 0 || pwd >= ppd) {
+      if (unparsed) *unparsed += 1;
+      continue;
+    }
+    l.period = d * ppd + pwd;
+    lectures.push_back(l);
+  }
+  return true;
+}
+
+
+void saveSolution(TimetablingInstance &instance, std::ostream &os, const Lectures &lectures) {
+  int ppd = instance.getPeriodsPerDayCount();
+  for (Lectures::const_iterator it = lectures.begin(); it != lectures.end(); it++)
+    // InfArcBib r10 0 0
+    os << instance.getCourse(it->course).name << " "
+      << "r" << instance.getRoom(it->room).name << " "
+      << it->period / ppd << " " << it->period % ppd << std::endl;
+}
@@ -0,0 +1,37 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_TIMETABLE
+#define UDINE_TIMETABLE
+
+#include <iostream>
+#include <vector>
+
+#include "loader.h"
+
+// A compact representation of a (possibly partial) timetable:
+// a single entry per lecture scheduled, rather than P x R x C values
+struct Lecture {
+  int course, period, room;
+};
+typedef std::vector<Lecture> Lectures;
+
+// Reads a timetable in the format of the ITC 2007 validator, i.e. lines
+// "course room day period" with room names prefixed by "r".
+// Lines that do not describe a lecture, such as the trailing "Cost 5", are skipped;
+// lines that look like lectures, but name unknown courses or rooms or periods
+// out of range, are skipped and counted in unparsed, if given.
+bool loadSolution(TimetablingInstance &instance, const char *filename, Lectures &lectures, int *unparsed = 0);
+
+// Writes a timetable in the same format
+void saveSolution(TimetablingInstance &instance, std::ostream &os, const Lectures &lectures);
+
+#endif // UDINE_TIMETABLE
@@ -0,0 +1,87 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdio>
+#include <cstring>
+
+#include "tokenizer.h"
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v'; }
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; }
+
+
+bool Token::equals(const char *s) const {
+  return std::strlen(s) == length && std::strncmp(begin, s, length) == 0;
+}
+
+
+bool Token::toInt(int &value) const {
+  int i = 0, sign = 1;
+  if (length == 0) return false;
+  if (begin[0] == '-' || begin[0] == '+') {
+    if (length == 1) return false;
+    sign = (begin[0] == '-') ? -1 : 1;
+    i = 1;
+  }
+  int v = 0;
+  for (; i < length; i++) {
+    if (begin[i] < '0' || begin[i] > '9') return false;
+    v = 10 * v + (begin[i] - '0');
+  }
+  value = sign * v;
+  return true;
+}
+
+
+bool Tokenizer::open(const char *filename) {
+  pos = end = 0;
+  buffer.clear();
+  std::FILE *f = std::fopen(filename, "rb");
+  if (!f) return false;
+  std::fseek(f, 0, SEEK_END);
+  long size = std::ftell(f);
+  std::fseek(f, 0, SEEK_SET);
+  if (size < 0) { std::fclose(f); return false; }
+  buffer.resize(size + 1);
+  size_t read = std::fread(&buffer[0], 1, size, f);
+  std::fclose(f);
+  buffer[read] = '\0';
+  pos = &buffer[0];
+  end = pos + read;
+  return true;
+}
+
+
+bool Tokenizer::next(Token &t) {
+  while (pos < end && isSpace(*pos)) pos++;
+  if (pos >= end) return false;
+  t.begin = pos;
+  while (pos < end && !isSpace(*pos)) pos++;
+  t.length = pos - t.begin;
+  return true;
+}
+
+
+bool Tokenizer::nextInLine(Token &t) {
+  while (pos < end && isBlank(*pos)) pos++;
+  if (pos >= end || *pos == '\n') return false;
+  t.begin = pos;
+  while (pos < end && !isSpace(*pos)) pos++;
+  t.length = pos - t.begin;
+  return true;
+}
+
+
+bool Tokenizer::nextLine() {
+  while (pos < end && *pos != '\n') pos++;
+  if (pos < end) pos++;
+  return pos < end;
+}
@@ -0,0 +1,46 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_TOKENIZER
+#define UDINE_TOKENIZER
+
+#include <string>
+#include <vector>
+
+// A token points into the buffer of the tokenizer it comes from
+struct Token {
+  const char *begin;
+  int length;
+  std::string str() const { return std::string(begin, length); }
+  bool equals(const char *s) const;
+  bool toInt(int &value) const;
+};
+
+/* Reads a whole file with a single read and splits it into whitespace-separated
+* tokens, without the overhead of formatted stream input.
+*/
+class Tokenizer {
+protected:
+  std::vector<char> buffer;
+  const char *pos, *end;
+public:
+  Tokenizer() : pos(0), end(0) {}
+  bool open(const char *filename);
+  // The next token, skipping any whitespace including line breaks
+  bool next(Token &t);
+  // The next token on the current line, if any
+  bool nextInLine(Token &t);
+  // Skips the rest of the current line; returns false at the end of the file
+  bool nextLine();
+  bool isEnd() const { return pos >= end; }
+};
+
+#endif // UDINE_TOKENIZER
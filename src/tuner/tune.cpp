@@ -0,0 +1,400 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#endif
+
+#include "batch.h"
+#include "configuration.h"
+#include "events.h"
+#include "loader.h"
+
+// Tunes the configuration of udine over a set of instances by racing, as in F-Race:
+// configurations drawn from a space of values run on one instance after another,
+// and once they have run on a few, those ranked significantly worse than the best
+// by the test of Friedman are dropped, e.g.:
+//   udine-tune -c ./examples/udine.cfg -n 16 -T 300 -j 4 -t 2 ./examples/tuning.space ./data
+// The instances are raced separately in classes, by their size by default, and the best
+// configuration of each class goes to <work>/<class>.cfg, with all the runs in <work>/runs.csv.
+
+// A value for each of the names of the space, which can take several
+struct SpaceEntry {
+  std::string name;
+  std::vector<std::string> values;
+};
+
+struct Candidate {
+  SolverConfiguration configuration;
+  std::string path;     // of its configuration file
+  bool alive;
+  std::map<int, double> scores;   // by the instance
+};
+
+struct TuningRun {
+  int candidate, instance;
+  std::string output;
+  boost::system_time started;
+};
+
+
+static bool readSpace(const std::string &path, std::vector<SpaceEntry> &space, std::string &error) {
+  std::ifstream file(path.c_str());
+  if (!file) {
+    error = "cannot read " + path;
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    line = line.substr(0, line.find('#'));
+    size_t at = line.find('=');
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+    if (at == std::string::npos) {
+      error = "no values in " + line;
+      return false;
+    }
+    SpaceEntry entry;
+    std::istringstream name(line.substr(0, at));
+    name >> entry.name;
+    std::istringstream values(line.substr(at + 1));
+    std::string value;
+    while (std::getline(values, value, '|')) {
+      std::istringstream trimmed(value);
+      if (trimmed >> value) entry.values.push_back(value);
+    }
+    SolverConfiguration check;
+    if (entry.values.empty() || !check.assign(entry.name + "=" + entry.values.front(), error)) {
+      if (entry.values.empty()) error = "no values for " + entry.name;
+      return false;
+    }
+    space.push_back(entry);
+  }
+  return true;
+}
+
+
+// The class of an instance: small, medium or large by its events, its directory, or its name without digits
+static std::string getClass(const std::string &instance, const std::string &grouping) {
+  size_t slash = instance.find_last_of("/\\");
+  std::string directory = (slash == std::string::npos) ? "." : instance.substr(0, slash);
+  std::string name = (slash == std::string::npos) ? instance : instance.substr(slash + 1);
+  if (grouping == "dir") {
+    std::string label(directory);
+    for (size_t i = 0; i < label.size(); i++)
+      if (label[i] == '/' || label[i] == '\\' || label[i] == '.') label[i] = '_';
+    return label;
+  }
+  if (grouping == "name") {
+    std::string label;
+    for (size_t i = 0; i < name.size() && name[i] != '.'; i++)
+      if (!std::isdigit(name[i])) label += name[i];
+    return label.empty() ? "instances" : label;
+  }
+  TimetablingInstance parsed;
+  std::string error;
+  if (!parsed.parse(instance.c_str(), error)) return "unreadable";
+  if (parsed.getEventCount() < 200) return "small";
+  if (parsed.getEventCount() < 400) return "medium";
+  return "large";
+}
+
+
+static std::string getBasename(const std::string &path) {
+  size_t slash = path.find_last_of("/\\");
+  return (slash == std::string::npos) ? path : path.substr(slash + 1);
+}
+
+
+// The lower, the better: the gap, with any incumbent better than none, or the bound alone
+static double getScore(const EventSummary &summary, int status, const std::string &objective) {
+  if (status != 0) return 1e9;
+  if (objective == "bound") return -summary.bound;
+  if (summary.incumbents == 0) return 1e6 - summary.bound;
+  return summary.incumbent - summary.bound;
+}
+
+
+// The ranks of the candidates alive on each of the instances, with ties sharing the average rank
+static void getRankSums(const std::vector<Candidate> &candidates, const std::vector<int> &instances,
+                        std::vector<double> &sums) {
+  sums.assign(candidates.size(), 0);
+  for (size_t i = 0; i < instances.size(); i++) {
+    std::vector< std::pair<double, int> > scores;
+    for (size_t c = 0; c < candidates.size(); c++) {
+      if (!candidates[c].alive) continue;
+      // Without a score, e.g. if the run was lost, a candidate ranks as if it failed
+      std::map<int, double>::const_iterator it = candidates[c].scores.find(instances[i]);
+      scores.push_back(std::make_pair(it != candidates[c].scores.end() ? it->second : 1e9, int(c)));
+    }
+    std::sort(scores.begin(), scores.end());
+    for (size_t first = 0; first < scores.size(); ) {
+      size_t last = first;
+      while (last + 1 < scores.size() && scores[last + 1].first == scores[first].first) last += 1;
+      double rank = (first + last) / 2.0 + 1;
+      for (size_t k = first; k <= last; k++) sums[scores[k].second] += rank;
+      first = last + 1;
+    }
+  }
+}
+
+
+#ifndef _WIN32
+static pid_t launch(const std::string &udine, const std::string &configuration, int threads,
+                    const std::string &output, const std::string &instance) {
+  pid_t pid = fork();
+  if (pid != 0) return pid;
+
+  int fd = open((output + ".txt").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd >= 0) {
+    dup2(fd, 1);
+    dup2(fd, 2);
+    close(fd);
+  }
+  std::ostringstream convert;
+  convert << threads;
+  std::vector<std::string> args;
+  args.push_back(udine);
+  args.push_back("-c"); args.push_back(configuration);
+  if (threads > 0) {
+    args.push_back("-t"); args.push_back(convert.str());
+  }
+  args.push_back("-m"); args.push_back("none");
+  args.push_back("-o"); args.push_back(output);
+  args.push_back(instance);
+  std::vector<char *> argv;
+  for (size_t i = 0; i < args.size(); i++) argv.push_back(const_cast<char *>(args[i].c_str()));
+  argv.push_back(0);
+  execv(udine.c_str(), &argv[0]);
+  std::perror("Tuner: Cannot run udine");
+  _exit(127);
+}
+#endif
+
+
+int main(int argc, char **argv) {
+  std::string udine("./bin/udine"), base, work("./tuning"), grouping("size"), objective("gap");
+  std::vector<std::string> arguments;
+  int count = 16, jobs = 1, threads = 0, minInstances = 3;
+  unsigned seed = 1;
+  double timeLimit = 0, critical = 1.96;
+
+  for (int a = 1; a < argc; a++) {
+    std::string arg(argv[a]);
+    if (arg == "-c" && a + 1 < argc) { base = argv[++a]; continue; }
+    if (arg == "-n" && a + 1 < argc) { count = std::atoi(argv[++a]); continue; }
+    if (arg == "-s" && a + 1 < argc) { seed = std::atoi(argv[++a]); continue; }
+    if (arg == "-T" && a + 1 < argc) { timeLimit = std::atof(argv[++a]); continue; }
+    if (arg == "-j" && a + 1 < argc) { jobs = std::atoi(argv[++a]); continue; }
+    if (arg == "-t" && a + 1 < argc) { threads = std::atoi(argv[++a]); continue; }
+    if (arg == "-m" && a + 1 < argc) { minInstances = std::atoi(argv[++a]); continue; }
+    if (arg == "-z" && a + 1 < argc) { critical = std::atof(argv[++a]); continue; }
+    if (arg == "-g" && a + 1 < argc) { grouping = argv[++a]; continue; }
+    if (arg == "-o" && a + 1 < argc) { objective = argv[++a]; continue; }
+    if (arg == "-w" && a + 1 < argc) { work = argv[++a]; continue; }
+    if (arg == "-u" && a + 1 < argc) { udine = argv[++a]; continue; }
+    arguments.push_back(arg);
+  }
+
+  if (arguments.size() < 2) {
+    std::cerr << "Usage: " << argv[0] << " [-c <config>] [-n <candidates>] [-s <seed>] [-T <seconds>] [-j <jobs>] [-t <threads>]" << std::endl;
+    std::cerr << "       [-m <instances>] [-z <critical>] [-g size|dir|name] [-o gap|bound] [-w <work>] [-u <udine>]" << std::endl;
+    std::cerr << "       <space> <data> [<data> ...]" << std::endl;
+    std::cerr << "where: <space> lists the values to try of the settings, as <name> = <value> | <value> ...," << std::endl;
+    std::cerr << "       on top of <config>, of which <candidates> (16) are drawn, the first being <config> itself," << std::endl;
+    std::cerr << "       <data> is an instance, a directory of them or a pattern such as ./data/comp*.ctt," << std::endl;
+    std::cerr << "       each run within <seconds> by udine -t <threads>, <jobs> runs at a time," << std::endl;
+    std::cerr << "       and once on <instances> (3), those worse than the best by more than <critical> (1.96)" << std::endl;
+    std::cerr << "       deviations of the sums of their ranks are dropped, by the gap (default) or the bound," << std::endl;
+    std::cerr << "       for each class of instances: by their size (default), directory, or name without digits," << std::endl;
+    std::cerr << "       with the best configurations in <work>/<class>.cfg and the runs in <work>/runs.csv" << std::endl;
+    exit(-1);
+  }
+
+#ifdef _WIN32
+  std::cerr << "Tuner: Running udine is not supported on Windows" << std::endl;
+  return 1;
+#else
+  std::string error;
+  SolverConfiguration defaults;
+  if (!base.empty() && !defaults.read(base, error)) {
+    std::cerr << "Tuner: There was an error reading the configuration " << error << std::endl;
+    return 1;
+  }
+  if (timeLimit > 0) {
+    std::ostringstream limit;
+    limit << timeLimit;
+    defaults.set("CPX_PARAM_TILIM", limit.str());
+  }
+  std::vector<SpaceEntry> space;
+  if (!readSpace(arguments[0], space, error)) {
+    std::cerr << "Tuner: There was an error reading the space " << arguments[0] << ": " << error << std::endl;
+    return 1;
+  }
+  std::vector<std::string> instances;
+  for (size_t p = 1; p < arguments.size(); p++)
+    if ((endsWith(arguments[p], ".ctt") || !listInstances(arguments[p], instances)) && !listMatches(arguments[p], instances))
+      instances.push_back(arguments[p]);
+  mkdir(work.c_str(), 0755);
+
+  // The candidates, the first being the configuration given, and the rest distinct
+  boost::mt19937 engine(seed);
+  std::vector<Candidate> candidates;
+  std::set<std::string> seen;
+  for (int attempt = 0; int(candidates.size()) < count && attempt < 100 * count; attempt++) {
+    Candidate candidate;
+    candidate.configuration = defaults;
+    if (attempt > 0)
+      for (size_t e = 0; e < space.size(); e++)
+        candidate.configuration.set(space[e].name, space[e].values[engine() % space[e].values.size()]);
+    std::ostringstream description;
+    candidate.configuration.describe(description);
+    if (!seen.insert(description.str()).second) continue;
+    std::ostringstream path;
+    path << work << "/c" << candidates.size() << ".cfg";
+    candidate.path = path.str();
+    candidate.configuration.write(candidate.path);
+    candidates.push_back(candidate);
+  }
+
+  std::map<std::string, std::vector<int> > classes;
+  for (size_t i = 0; i < instances.size(); i++) classes[getClass(instances[i], grouping)].push_back(i);
+  std::cout << "Tuner: " << candidates.size() << " candidate(s), " << instances.size() << " instance(s) in "
+    << classes.size() << " class(es), " << jobs << " run(s) at a time" << std::endl;
+
+  std::ofstream runs((work + "/runs.csv").c_str(), std::ofstream::out);
+  runs << "class,instance,candidate,status,wall,bound,incumbent,score" << std::endl;
+  int failures = 0;
+
+  for (std::map<std::string, std::vector<int> >::iterator it = classes.begin(); it != classes.end(); it++) {
+    const std::string &label = it->first;
+    std::vector<int> order(it->second);
+    for (int k = int(order.size()) - 1; k > 0; k--) std::swap(order[k], order[engine() % (k + 1)]);
+    for (size_t c = 0; c < candidates.size(); c++) {
+      candidates[c].alive = true;
+      candidates[c].scores.clear();
+    }
+
+    std::vector<int> raced;
+    for (size_t k = 0; k < order.size(); k++) {
+      int instance = order[k];
+      std::vector<TuningRun> pending;
+      for (size_t c = 0; c < candidates.size(); c++) {
+        if (!candidates[c].alive) continue;
+        TuningRun run;
+        run.candidate = c;
+        run.instance = instance;
+        std::ostringstream output;
+        output << work << "/" << getBasename(instances[instance]) << ".c" << c;
+        run.output = output.str();
+        pending.push_back(run);
+      }
+
+      // The candidates alive on the instance, as many at a time as there are slots
+      std::map<pid_t, TuningRun> running;
+      size_t next = 0;
+      while (next < pending.size() || !running.empty()) {
+        while (int(running.size()) < std::max(1, jobs) && next < pending.size()) {
+          TuningRun &run = pending[next++];
+          run.started = boost::get_system_time();
+          pid_t pid = launch(udine, candidates[run.candidate].path, threads, run.output, instances[instance]);
+          if (pid < 0) {
+            std::perror("Tuner: Cannot fork");
+            candidates[run.candidate].scores[instance] = 1e9;
+            failures += 1;
+            continue;
+          }
+          running[pid] = run;
+        }
+        if (running.empty()) break;
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) break;
+        if (running.find(pid) == running.end()) continue;
+        TuningRun run = running[pid];
+        running.erase(pid);
+        int code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+        double wall = (boost::get_system_time() - run.started).total_milliseconds() / 1000.0;
+        EventSummary summary;
+        summariseEvents(run.output + ".events", summary);
+        double score = getScore(summary, code, objective);
+        candidates[run.candidate].scores[instance] = score;
+        if (code != 0) failures += 1;
+        runs << label << "," << instances[instance] << "," << run.candidate << "," << code << "," << wall << ","
+          << summary.bound << ",";
+        if (summary.incumbents > 0) runs << summary.incumbent;
+        runs << "," << score << std::endl;
+      }
+      raced.push_back(instance);
+
+      // Once on enough instances, drop those ranked worse than the best by more than the critical difference
+      std::vector<double> sums;
+      getRankSums(candidates, raced, sums);
+      int alive = 0;
+      double best = 1e30;
+      for (size_t c = 0; c < candidates.size(); c++)
+        if (candidates[c].alive) {
+          alive += 1;
+          best = std::min(best, sums[c]);
+        }
+      int dropped = 0;
+      if (int(raced.size()) >= minInstances && alive > 1) {
+        double difference = critical * std::sqrt(raced.size() * alive * (alive + 1) / 6.0);
+        for (size_t c = 0; c < candidates.size(); c++)
+          if (candidates[c].alive && sums[c] - best > difference) {
+            candidates[c].alive = false;
+            dropped += 1;
+          }
+      }
+      std::cout << "Tuner: " << label << " [" << raced.size() << "/" << order.size() << "] " << instances[instance]
+        << ": " << alive - dropped << " of " << candidates.size() << " left" << std::endl;
+      if (alive - dropped <= 1) break;
+    }
+
+    // The best of those left, by the mean of their ranks
+    std::vector<double> sums;
+    getRankSums(candidates, raced, sums);
+    int winner = -1;
+    for (size_t c = 0; c < candidates.size(); c++)
+      if (candidates[c].alive && (winner < 0 || sums[c] < sums[winner])) winner = c;
+    if (winner < 0 || raced.empty()) continue;
+    std::string path = work + "/" + label + ".cfg";
+    candidates[winner].configuration.write(path);
+    std::cout << "Tuner: " << label << ": c" << winner << " with a mean rank of " << sums[winner] / raced.size()
+      << " over " << raced.size() << " instance(s), in " << path << ":" << std::endl << "Tuner:   ";
+    for (size_t e = 0; e < space.size(); e++)
+      std::cout << (e ? " " : "") << space[e].name << "=" << candidates[winner].configuration.get(space[e].name, "(default)");
+    std::cout << std::endl;
+  }
+
+  runs.close();
+  return failures > 0 ? 1 : 0;
+#endif
+}
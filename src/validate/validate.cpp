@@ -0,0 +1,217 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+
+#include "loader.h"
+#include "timetable.h"
+#include "evaluator.h"
+#include "batch.h"
+
+// Validates many timetables at once, without CPLEX, e.g. after a batch of runs:
+//   udine-validate [-j <threads>] [-o <csv>] <path> [<path> ...]
+// where each path is either a directory, in which each <data>.ctt is paired
+// with each <data>.ctt.sol and <data>.ctt.*.sol, or an instance <data>.ctt
+// followed by any number of timetables for it (<data>.ctt.sol by default).
+// The penalties of each timetable are written as CSV, and an instance in a directory
+// without any timetable as "no solution". The exit code is 1 if any timetable
+// could not be read or is infeasible, and 0 otherwise.
+
+struct Job {
+  int instance;
+  std::string solution;   // empty, if there is none
+  // Results
+  bool read;
+  int unparsed;
+  Penalties penalties;
+};
+
+struct Instance {
+  std::string filename, error;
+  TimetablingInstance data;
+  bool ok;
+};
+
+struct InstanceWorker {
+  WorkQueue *queue;
+  std::vector<Instance> *instances;
+  void operator()() {
+    int i;
+    while ((i = queue->pop()) >= 0) {
+      Instance &in = (*instances)[i];
+      in.ok = in.data.parse(in.filename.c_str(), in.error);
+    }
+  }
+};
+
+struct JobWorker {
+  WorkQueue *queue;
+  std::vector<Instance> *instances;
+  std::vector<Job> *jobs;
+  void operator()() {
+    int j;
+    Lectures lectures;
+    while ((j = queue->pop()) >= 0) {
+      Job &job = (*jobs)[j];
+      Instance &in = (*instances)[job.instance];
+      job.read = false;
+      if (!in.ok || job.solution.empty()) continue;
+      job.read = loadSolution(in.data, job.solution.c_str(), lectures, &job.unparsed);
+      if (!job.read) continue;
+      TimetableEvaluator evaluator(in.data);
+      job.penalties = evaluator.evaluate(lectures);
+    }
+  }
+};
+
+
+int main(int argc, char **argv) {
+  int threads = boost::thread::hardware_concurrency();
+  const char *csvFilename = 0;
+  std::vector<Instance> instances;
+  std::vector<Job> jobs;
+  std::vector<bool> hasSolution;  // or need not be paired with <data>.sol
+
+  for (int a = 1; a < argc; a++) {
+    std::string arg(argv[a]);
+    if (arg == "-j" && a + 1 < argc) { threads = std::atoi(argv[++a]); continue; }
+    if (arg == "-o" && a + 1 < argc) { csvFilename = argv[++a]; continue; }
+
+    std::vector<std::string> names;
+    if (!endsWith(arg, ".ctt") && !endsWith(arg, ".sol") && listDirectory(arg, names)) {
+      // Pair up the instances and the timetables in a directory
+      std::string dir = arg;
+      if (!endsWith(dir, "/") && !endsWith(dir, "\\")) dir.append("/");
+      for (size_t n = 0; n < names.size(); n++) {
+        if (!endsWith(names[n], ".ctt")) continue;
+        Instance in;
+        in.filename = dir + names[n];
+        instances.push_back(in);
+        hasSolution.push_back(true);
+        size_t found = jobs.size();
+        for (size_t m = 0; m < names.size(); m++)
+          if (names[m].compare(0, names[n].size() + 1, names[n] + ".") == 0 && endsWith(names[m], ".sol")) {
+            Job job;
+            job.instance = instances.size() - 1;
+            job.solution = dir + names[m];
+            jobs.push_back(job);
+          }
+        if (jobs.size() == found) {
+          Job job;
+          job.instance = instances.size() - 1;
+          jobs.push_back(job);
+        }
+      }
+    } else if (endsWith(arg, ".sol") && !instances.empty()) {
+      Job job;
+      job.instance = instances.size() - 1;
+      job.solution = arg;
+      jobs.push_back(job);
+      hasSolution.back() = true;
+    } else {
+      Instance in;
+      in.filename = arg;
+      instances.push_back(in);
+      hasSolution.push_back(false);
+    }
+
+    // An instance given without any timetable is paired with <data>.sol
+    if (instances.size() > 1 && !hasSolution[instances.size() - 2]) {
+      Job job;
+      job.instance = instances.size() - 2;
+      job.solution = instances[job.instance].filename + ".sol";
+      jobs.push_back(job);
+      hasSolution[job.instance] = true;
+    }
+  }
+  if (!instances.empty() && !hasSolution.back()) {
+    Job job;
+    job.instance = instances.size() - 1;
+    job.solution = instances.back().filename + ".sol";
+    jobs.push_back(job);
+  }
+
+  if (instances.empty()) {
+    std::cerr << "Usage: " << argv[0] << " [-j <threads>] [-o <csv>] <path> [<path> ...]" << std::endl;
+    std::cerr << "where: <path> is a directory with instances <data>.ctt and timetables <data>.ctt[.*].sol," << std::endl;
+    std::cerr << "       or an instance <data>.ctt followed by its timetables (<data>.ctt.sol by default)" << std::endl;
+    exit(-1);
+  }
+  threads = std::max(1, threads);
+
+  // Load the instances and then validate the timetables, in parallel
+  int t;
+  {
+    WorkQueue queue(instances.size());
+    InstanceWorker worker = { &queue, &instances };
+    boost::thread_group group;
+    for (t = 0; t < std::min<int>(threads, instances.size()); t++) group.create_thread(worker);
+    group.join_all();
+  }
+  {
+    WorkQueue queue(jobs.size());
+    JobWorker worker = { &queue, &instances, &jobs };
+    boost::thread_group group;
+    for (t = 0; t < std::min<int>(threads, jobs.size()); t++) group.create_thread(worker);
+    group.join_all();
+  }
+
+  std::ofstream file;
+  if (csvFilename) file.open(csvFilename, std::ofstream::out);
+  std::ostream &csv = csvFilename ? file : std::cout;
+  csv << "instance,solution,status,unparsed,lectures,conflicts,roomOccupancy,availability,hard,"
+    << "roomCapacity,minWorkingDays,isolatedLectures,roomStability,soft" << std::endl;
+
+  // The 11 cells after the status, left empty for a timetable not evaluated
+  const std::string noCounts(11, ',');
+  int failures = 0, missing = 0;
+  for (size_t j = 0; j < jobs.size(); j++) {
+    const Job &job = jobs[j];
+    const Instance &in = instances[job.instance];
+    csv << quoteField(in.filename) << "," << quoteField(job.solution) << ",";
+    if (!in.ok) {
+      csv << quoteField("bad instance: " + in.error) << noCounts << std::endl;
+      failures += 1;
+      continue;
+    }
+    if (job.solution.empty()) {
+      csv << "no solution" << noCounts << std::endl;
+      missing += 1;
+      continue;
+    }
+    if (!job.read) {
+      csv << "unreadable" << noCounts << std::endl;
+      failures += 1;
+      continue;
+    }
+    Penalties p = job.penalties;
+    bool feasible = (p.getHard() == 0 && job.unparsed == 0);
+    if (!feasible) failures += 1;
+    csv << (feasible ? "feasible" : "infeasible") << "," << job.unparsed << ","
+      << p.lectures << "," << p.conflicts << "," << p.roomOccupancy << "," << p.availability << "," << p.getHard() << ","
+      << p.roomCapacity << "," << p.minWorkingDays << "," << p.isolatedLectures << "," << p.roomStability << "," << p.getSoft()
+      << std::endl;
+  }
+
+  if (csvFilename) file.close();
+  std::cerr << "Validator: " << jobs.size() - missing << " timetables of " << instances.size() << " instances, "
+    << failures << " unreadable or infeasible";
+  if (missing > 0) std::cerr << ", " << missing << " instance(s) without any";
+  std::cerr << std::endl;
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <boost/bind.hpp>
+
+#include "writer.h"
+#include "assignment.h"
+
+
+SolutionWriter::SolutionWriter(TimetablingInstance &i, const char *p, bool rooms)
+: instance(i), path(p), reassignRooms(rooms), busy(false), stopping(false) {
+  thread = boost::thread(boost::bind(&SolutionWriter::run, this));
+}
+
+
+SolutionWriter::~SolutionWriter() {
+  {
+    boost::mutex::scoped_lock l(lock);
+    stopping = true;
+  }
+  pending.notify_one();
+  thread.join();
+}
+
+
+void SolutionWriter::write(const Lectures &lectures, int cost) {
+  {
+    boost::mutex::scoped_lock l(lock);
+    queue.push_back(Job());
+    queue.back().lectures = lectures;
+    queue.back().cost = cost;
+  }
+  pending.notify_one();
+}
+
+
+void SolutionWriter::flush() {
+  boost::mutex::scoped_lock l(lock);
+  while (busy || !queue.empty()) done.wait(l);
+}
+
+
+void SolutionWriter::run() {
+  Job job;
+  while (true) {
+    {
+      boost::mutex::scoped_lock l(lock);
+      while (queue.empty() && !stopping) pending.wait(l);
+      if (queue.empty()) return;
+      job.lectures.swap(queue.front().lectures);
+      job.cost = queue.front().cost;
+      queue.pop_front();
+      busy = true;
+    }
+    save(job);
+    {
+      boost::mutex::scoped_lock l(lock);
+      busy = false;
+    }
+    done.notify_all();
+  }
+}
+
+
+void SolutionWriter::save(Job &job) {
+  // Post-optimise the rooms of the incumbent, with the periods fixed
+  if (reassignRooms) {
+    int improvement = optimiseRooms(instance, job.lectures);
+    if (improvement > 0) {
+      std::cout << "Solver: Reassigning rooms improves the incumbent by " << improvement << std::endl;
+      job.cost -= improvement;
+    }
+  }
+
+  std::stringstream name;
+  name << path << "." << job.cost << ".sol";
+  std::string filename = name.str();
+  std::string temporary = filename + ".tmp";
+
+  std::ofstream file(temporary.c_str(), std::ofstream::out | std::ofstream::trunc);
+  saveSolution(instance, file, job.lectures);
+  file.close();
+  if (file.fail()) {
+    std::cerr << "Solver: Cannot write " << temporary << std::endl;
+    return;
+  }
+#ifdef _WIN32
+  // rename() does not replace existing files on Windows
+  std::remove(filename.c_str());
+#endif
+  if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+    std::cerr << "Solver: Cannot rename " << temporary << " to " << filename << std::endl;
+}
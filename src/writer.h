@@ -0,0 +1,61 @@
+/* A Branch-and-cut Procedure for the Udine Course Timetabling Problem.
+*
+* Copyright (C) 2007-2010 Jakub Marecek and The University of Nottingham.
+* Licensed under the GNU GPL. Please read LICENSE file for details.
+*
+* Please cite:
+* A Branch-and-cut Procedure for the Udine Course Timetabling Problem
+* by Edmund K. Burke, Jakub Marecek, Andrew J. Parkes, and Hana Rudova
+* available from http://cs.nott.ac.uk/~jxm/timetabling/
+*/
+
+#ifndef UDINE_WRITER
+#define UDINE_WRITER
+
+#include <deque>
+#include <string>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "loader.h"
+#include "timetable.h"
+
+/* Writes incumbents to <path>.<cost>.sol in a background thread, so that
+* the incumbent callback only needs to hand over the lectures.
+* The rooms are post-optimised before writing, and each file is first written
+* to <path>.<cost>.sol.tmp and then renamed, so that it is never seen incomplete.
+*/
+class SolutionWriter {
+protected:
+  struct Job {
+    Lectures lectures;
+    int cost;
+  };
+
+  TimetablingInstance &instance;
+  std::string path;
+  bool reassignRooms;
+
+  boost::mutex lock;
+  boost::condition_variable pending, done;
+  std::deque<Job> queue;
+  bool busy, stopping;
+  boost::thread thread;
+
+  void run();
+  void save(Job &job);
+
+public:
+  SolutionWriter(TimetablingInstance &i, const char *path, bool reassignRooms = true);
+  // Writes all the incumbents still queued
+  ~SolutionWriter();
+
+  // Queues a timetable of the given cost for writing
+  void write(const Lectures &lectures, int cost);
+  // Waits until all the incumbents queued have been written
+  void flush();
+};
+
+#endif // UDINE_WRITER